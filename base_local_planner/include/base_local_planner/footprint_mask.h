@@ -0,0 +1,125 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#ifndef FOOTPRINT_MASK_H_
+#define FOOTPRINT_MASK_H_
+
+#include <vector>
+
+#include <costmap_2d/costmap_2d.h>
+#include <geometry_msgs/Point.h>
+#include <base_local_planner/Position2DInt.h>
+
+namespace base_local_planner {
+
+/**
+ * @class FootprintMask
+ * @brief Caches the grid cells covered by a footprint for a fixed set of
+ * discretized headings, so that checking a footprint against the costmap
+ * becomes a lookup over precomputed cell offsets instead of transforming
+ * and rasterizing the polygon for every pose.
+ *
+ * Each heading bin holds the union of the footprint rasterized at the start,
+ * middle and end of the bin with the robot centered in its cell, grown by one
+ * cell so that it covers the outline wherever the robot is inside its cell.
+ * The result is never below CostmapModel::footprintCost, at the price of
+ * rejecting poses that pass within a cell of an obstacle.
+ */
+class FootprintMask {
+public:
+  FootprintMask();
+  virtual ~FootprintMask();
+
+  /**
+   * @brief  Precompute the cell offsets for a footprint
+   * @param footprint_spec The footprint of the robot in the robot frame
+   * @param resolution The resolution of the costmap the mask will be used with
+   * @param num_headings The number of heading bins, 0 disables the mask
+   */
+  void setFootprint(const std::vector<geometry_msgs::Point>& footprint_spec,
+      double resolution, unsigned int num_headings);
+
+  /**
+   * @brief  Whether the mask has been computed for a polygonal footprint
+   */
+  bool isValid() const { return !headings_.empty(); }
+
+  /**
+   * @brief  Whether the mask was computed for this footprint, resolution and number of headings
+   */
+  bool matches(const std::vector<geometry_msgs::Point>& footprint_spec,
+      double resolution, unsigned int num_headings) const;
+
+  /**
+   * @brief  Checks the footprint against the costmap, with the same return convention as CostmapModel::footprintCost
+   * @param costmap The costmap to check against, must have the resolution the mask was computed for
+   * @param x The x position of the robot in world coordinates
+   * @param y The y position of the robot in world coordinates
+   * @param theta The orientation of the robot
+   * @return The maximum cost along the outline of the footprint, or -1.0 if it hits an obstacle, unknown space or leaves the map
+   */
+  double footprintCost(const costmap_2d::Costmap2D& costmap, double x, double y, double theta) const;
+
+  /**
+   * @brief  Used to get the cells that make up the footprint of the robot, like FootprintHelper::getFootprintCells
+   * @param costmap The costmap the cells are computed for
+   * @param x The x position of the robot in world coordinates
+   * @param y The y position of the robot in world coordinates
+   * @param theta The orientation of the robot
+   * @param fill If true: returns all cells in the footprint of the robot. If false: returns only the cells that make up the outline of the footprint.
+   * @param cells Will be filled with the cells of the footprint that lie on the map
+   */
+  void getFootprintCells(const costmap_2d::Costmap2D& costmap, double x, double y, double theta,
+      bool fill, std::vector<base_local_planner::Position2DInt>& cells) const;
+
+private:
+  struct HeadingMask {
+    // outline offsets first, interior offsets from fill_begin on
+    std::vector<int> dx, dy;
+    unsigned int fill_begin;
+    int min_dx, max_dx, min_dy, max_dy;
+  };
+
+  unsigned int headingIndex(double theta) const;
+
+  void computeHeading(double theta_begin, double theta_end, HeadingMask& mask) const;
+
+  std::vector<geometry_msgs::Point> footprint_spec_;
+  double resolution_;
+  std::vector<HeadingMask> headings_;
+};
+
+} /* namespace base_local_planner */
+#endif /* FOOTPRINT_MASK_H_ */
@@ -41,6 +41,7 @@
 #include <base_local_planner/trajectory_cost_function.h>
 
 #include <base_local_planner/costmap_model.h>
+#include <base_local_planner/footprint_mask.h>
 #include <costmap_2d/costmap_2d.h>
 
 namespace base_local_planner {
@@ -64,6 +65,11 @@ public:
   void setParams(double max_trans_vel, double max_scaling_factor, double scaling_speed);
   void setFootprint(std::vector<geometry_msgs::Point> footprint_spec);
 
+  /**
+   * @brief Check footprints through a FootprintMask with this many heading bins, 0 rasterizes every footprint
+   */
+  void setFootprintMaskHeadings(unsigned int num_headings) { footprint_mask_headings_ = num_headings; }
+
   // helper functions, made static for easy unit testing
   static double getScalingFactor(Trajectory &traj, double scaling_speed, double max_trans_vel, double max_scaling_factor);
   static double footprintCost(
@@ -74,11 +80,19 @@ public:
       std::vector<geometry_msgs::Point> footprint_spec,
       costmap_2d::Costmap2D* costmap,
       base_local_planner::WorldModel* world_model);
+  static double footprintCost(
+      const double& x,
+      const double& y,
+      const double& th,
+      const base_local_planner::FootprintMask& footprint_mask,
+      costmap_2d::Costmap2D* costmap);
 
 private:
   costmap_2d::Costmap2D* costmap_;
   std::vector<geometry_msgs::Point> footprint_spec_;
   base_local_planner::WorldModel* world_model_;
+  base_local_planner::FootprintMask footprint_mask_;
+  unsigned int footprint_mask_headings_;
   double max_trans_vel_;
   bool sum_scores_;
   //footprint scaling with velocity;
@@ -44,6 +44,7 @@
 #include <costmap_2d/costmap_2d.h>
 #include <costmap_2d/cost_values.h>
 #include <base_local_planner/footprint_helper.h>
+#include <base_local_planner/footprint_mask.h>
 
 #include <base_local_planner/world_model.h>
 #include <base_local_planner/trajectory.h>
@@ -204,7 +205,14 @@ namespace base_local_planner {
       bool getCellCosts(int cx, int cy, float &path_cost, float &goal_cost, float &occ_cost, float &total_cost);
 
       /** @brief Set the footprint specification of the robot. */
-      void setFootprint( std::vector<geometry_msgs::Point> footprint ) { footprint_spec_ = footprint; }
+      void setFootprint( std::vector<geometry_msgs::Point> footprint );
+
+      /**
+       * @brief Check footprints through a FootprintMask instead of the world model
+       * @param num_headings The number of heading bins of the mask, 0 uses the world model
+       * Only valid if the world model is a CostmapModel on the costmap given to the planner
+       */
+      void setFootprintMaskHeadings(unsigned int num_headings);
 
       /** @brief Return the footprint specification of the robot. */
       geometry_msgs::Polygon getFootprintPolygon() const { return costmap_2d::toPolygon(footprint_spec_); }
@@ -258,6 +266,8 @@ namespace base_local_planner {
       double footprintCost(double x_i, double y_i, double theta_i);
 
       base_local_planner::FootprintHelper footprint_helper_;
+      base_local_planner::FootprintMask footprint_mask_; ///< @brief Precomputed footprint cells, used instead of the world model if valid
+      unsigned int footprint_mask_headings_;
     
       MapGrid path_map_; ///< @brief The local map grid where we propagate path distance
       MapGrid goal_map_; ///< @brief The local map grid where we propagate goal distance
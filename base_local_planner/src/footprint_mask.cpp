@@ -0,0 +1,227 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+
+#include <base_local_planner/footprint_mask.h>
+#include <base_local_planner/footprint_helper.h>
+#include <costmap_2d/cost_values.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+#include <utility>
+
+namespace base_local_planner {
+
+FootprintMask::FootprintMask() : resolution_(0.0) {}
+
+FootprintMask::~FootprintMask() {}
+
+void FootprintMask::setFootprint(const std::vector<geometry_msgs::Point>& footprint_spec,
+    double resolution, unsigned int num_headings) {
+  footprint_spec_ = footprint_spec;
+  resolution_ = resolution;
+  headings_.clear();
+
+  //circular robots are checked on their center cell only, there is nothing to precompute
+  if (num_headings == 0 || footprint_spec.size() < 3 || resolution <= 0.0) {
+    return;
+  }
+
+  headings_.resize(num_headings);
+  double bin_width = 2 * M_PI / num_headings;
+  for (unsigned int i = 0; i < num_headings; ++i) {
+    double center = i * bin_width;
+    computeHeading(center - bin_width / 2, center + bin_width / 2, headings_[i]);
+  }
+}
+
+bool FootprintMask::matches(const std::vector<geometry_msgs::Point>& footprint_spec,
+    double resolution, unsigned int num_headings) const {
+  if (resolution != resolution_ || num_headings != headings_.size()
+      || footprint_spec.size() != footprint_spec_.size()) {
+    return false;
+  }
+  for (unsigned int i = 0; i < footprint_spec.size(); ++i) {
+    if (footprint_spec[i].x != footprint_spec_[i].x || footprint_spec[i].y != footprint_spec_[i].y) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void FootprintMask::computeHeading(double theta_begin, double theta_end, HeadingMask& mask) const {
+  FootprintHelper helper;
+  std::vector<base_local_planner::Position2DInt> line;
+  std::set<std::pair<int, int> > outline;
+
+  //rasterize the outline at both ends and the middle of the heading bin, with the robot in the center of cell (0, 0)
+  double thetas[3] = {theta_begin, (theta_begin + theta_end) / 2, theta_end};
+  for (unsigned int t = 0; t < 3; ++t) {
+    double cos_th = cos(thetas[t]);
+    double sin_th = sin(thetas[t]);
+
+    std::vector<std::pair<int, int> > vertices(footprint_spec_.size());
+    for (unsigned int i = 0; i < footprint_spec_.size(); ++i) {
+      double new_x = 0.5 * resolution_ + (footprint_spec_[i].x * cos_th - footprint_spec_[i].y * sin_th);
+      double new_y = 0.5 * resolution_ + (footprint_spec_[i].x * sin_th + footprint_spec_[i].y * cos_th);
+      vertices[i].first = (int) floor(new_x / resolution_);
+      vertices[i].second = (int) floor(new_y / resolution_);
+    }
+
+    for (unsigned int i = 0; i < vertices.size(); ++i) {
+      const std::pair<int, int>& p0 = vertices[i];
+      const std::pair<int, int>& p1 = vertices[(i + 1) % vertices.size()];
+      line.clear();
+      helper.getLineCells(p0.first, p1.first, p0.second, p1.second, line);
+      for (unsigned int j = 0; j < line.size(); ++j) {
+        outline.insert(std::make_pair((int) line[j].x, (int) line[j].y));
+      }
+    }
+  }
+
+  //the robot can be anywhere inside its cell, which moves the outline by up to one cell in each direction
+  std::set<std::pair<int, int> > dilated;
+  for (std::set<std::pair<int, int> >::const_iterator it = outline.begin(); it != outline.end(); ++it) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        dilated.insert(std::make_pair(it->first + dx, it->second + dy));
+      }
+    }
+  }
+  outline.swap(dilated);
+
+  //walk through each column of the outline and collect the cells strictly between its lowest and highest cell
+  std::map<int, std::pair<int, int> > columns;
+  for (std::set<std::pair<int, int> >::const_iterator it = outline.begin(); it != outline.end(); ++it) {
+    std::map<int, std::pair<int, int> >::iterator column = columns.find(it->first);
+    if (column == columns.end()) {
+      columns[it->first] = std::make_pair(it->second, it->second);
+    } else {
+      column->second.first = std::min(column->second.first, it->second);
+      column->second.second = std::max(column->second.second, it->second);
+    }
+  }
+
+  mask.dx.clear();
+  mask.dy.clear();
+  for (std::set<std::pair<int, int> >::const_iterator it = outline.begin(); it != outline.end(); ++it) {
+    mask.dx.push_back(it->first);
+    mask.dy.push_back(it->second);
+  }
+  mask.fill_begin = mask.dx.size();
+
+  for (std::map<int, std::pair<int, int> >::const_iterator it = columns.begin(); it != columns.end(); ++it) {
+    for (int y = it->second.first + 1; y < it->second.second; ++y) {
+      if (outline.find(std::make_pair(it->first, y)) == outline.end()) {
+        mask.dx.push_back(it->first);
+        mask.dy.push_back(y);
+      }
+    }
+  }
+
+  mask.min_dx = *std::min_element(mask.dx.begin(), mask.dx.end());
+  mask.max_dx = *std::max_element(mask.dx.begin(), mask.dx.end());
+  mask.min_dy = *std::min_element(mask.dy.begin(), mask.dy.end());
+  mask.max_dy = *std::max_element(mask.dy.begin(), mask.dy.end());
+}
+
+unsigned int FootprintMask::headingIndex(double theta) const {
+  int num_headings = headings_.size();
+  int index = (int) floor(theta * num_headings / (2 * M_PI) + 0.5) % num_headings;
+  if (index < 0) {
+    index += num_headings;
+  }
+  return index;
+}
+
+double FootprintMask::footprintCost(const costmap_2d::Costmap2D& costmap, double x, double y, double theta) const {
+  unsigned int cell_x, cell_y;
+  if (!isValid() || !costmap.worldToMap(x, y, cell_x, cell_y)) {
+    return -1.0;
+  }
+
+  const HeadingMask& mask = headings_[headingIndex(theta)];
+  int size_x = costmap.getSizeInCellsX();
+  int size_y = costmap.getSizeInCellsY();
+  int cx = cell_x, cy = cell_y;
+
+  //the footprint has to lie completely on the map, which lets the loop below skip all bounds checks
+  if (cx + mask.min_dx < 0 || cx + mask.max_dx >= size_x || cy + mask.min_dy < 0 || cy + mask.max_dy >= size_y) {
+    return -1.0;
+  }
+
+  const unsigned char* center = costmap.getCharMap() + cy * size_x + cx;
+  const int* dx = &mask.dx[0];
+  const int* dy = &mask.dy[0];
+  unsigned char footprint_cost = 0;
+  for (unsigned int i = 0; i < mask.fill_begin; ++i) {
+    unsigned char cost = center[dy[i] * size_x + dx[i]];
+    if (cost == costmap_2d::LETHAL_OBSTACLE || cost == costmap_2d::NO_INFORMATION) {
+      return -1.0;
+    }
+    footprint_cost = std::max(footprint_cost, cost);
+  }
+
+  return footprint_cost;
+}
+
+void FootprintMask::getFootprintCells(const costmap_2d::Costmap2D& costmap, double x, double y, double theta,
+    bool fill, std::vector<base_local_planner::Position2DInt>& cells) const {
+  cells.clear();
+  unsigned int cell_x, cell_y;
+  if (!isValid() || !costmap.worldToMap(x, y, cell_x, cell_y)) {
+    return;
+  }
+
+  const HeadingMask& mask = headings_[headingIndex(theta)];
+  int size_x = costmap.getSizeInCellsX();
+  int size_y = costmap.getSizeInCellsY();
+  unsigned int end = fill ? mask.dx.size() : mask.fill_begin;
+  cells.reserve(end);
+
+  base_local_planner::Position2DInt pt;
+  for (unsigned int i = 0; i < end; ++i) {
+    int mx = cell_x + mask.dx[i];
+    int my = cell_y + mask.dy[i];
+    if (mx >= 0 && mx < size_x && my >= 0 && my < size_y) {
+      pt.x = mx;
+      pt.y = my;
+      cells.push_back(pt);
+    }
+  }
+}
+
+} /* namespace base_local_planner */
@@ -43,7 +43,7 @@
 namespace base_local_planner {
 
 ObstacleCostFunction::ObstacleCostFunction(costmap_2d::Costmap2D* costmap) 
-    : costmap_(costmap), sum_scores_(false) {
+    : costmap_(costmap), footprint_mask_headings_(0), sum_scores_(false) {
   if (costmap != NULL) {
     world_model_ = new base_local_planner::CostmapModel(*costmap_);
   }
@@ -68,6 +68,13 @@ void ObstacleCostFunction::setFootprint(std::vector<geometry_msgs::Point> footpr
 }
 
 bool ObstacleCostFunction::prepare() {
+  if (footprint_mask_headings_ == 0 || costmap_ == NULL) {
+    if (footprint_mask_.isValid()) {
+      footprint_mask_.setFootprint(footprint_spec_, 0.0, 0);
+    }
+  } else if (!footprint_mask_.matches(footprint_spec_, costmap_->getResolution(), footprint_mask_headings_)) {
+    footprint_mask_.setFootprint(footprint_spec_, costmap_->getResolution(), footprint_mask_headings_);
+  }
   return true;
 }
 
@@ -83,9 +90,14 @@ double ObstacleCostFunction::scoreTrajectory(Trajectory &traj) {
 
   for (unsigned int i = 0; i < traj.getPointsSize(); ++i) {
     traj.getPoint(i, px, py, pth);
-    double f_cost = footprintCost(px, py, pth,
-        scale, footprint_spec_,
-        costmap_, world_model_);
+    double f_cost;
+    if (footprint_mask_.isValid()) {
+      f_cost = footprintCost(px, py, pth, footprint_mask_, costmap_);
+    } else {
+      f_cost = footprintCost(px, py, pth,
+          scale, footprint_spec_,
+          costmap_, world_model_);
+    }
 
     if(f_cost < 0){
         return f_cost;
@@ -141,4 +153,26 @@ double ObstacleCostFunction::footprintCost (
   return occ_cost;
 }
 
+double ObstacleCostFunction::footprintCost (
+    const double& x,
+    const double& y,
+    const double& th,
+    const base_local_planner::FootprintMask& footprint_mask,
+    costmap_2d::Costmap2D* costmap) {
+
+  double footprint_cost = footprint_mask.footprintCost(*costmap, x, y, th);
+
+  if (footprint_cost < 0) {
+    return -6.0;
+  }
+  unsigned int cell_x, cell_y;
+
+  //we won't allow trajectories that go off the map... shouldn't happen that often anyways
+  if ( ! costmap->worldToMap(x, y, cell_x, cell_y)) {
+    return -7.0;
+  }
+
+  return std::max(footprint_cost, double(costmap->getCost(cell_x, cell_y)));
+}
+
 } /* namespace base_local_planner */
@@ -153,7 +153,8 @@ namespace base_local_planner{
       double backup_vel,
       bool dwa, bool heading_scoring, double heading_scoring_timestep, bool meter_scoring, bool simple_attractor,
       vector<double> y_vels, double stop_time_buffer, double sim_period, double angular_sim_granularity)
-    : path_map_(costmap.getSizeInCellsX(), costmap.getSizeInCellsY()),
+    : footprint_mask_headings_(0),
+      path_map_(costmap.getSizeInCellsX(), costmap.getSizeInCellsY()),
       goal_map_(costmap.getSizeInCellsX(), costmap.getSizeInCellsY()),
       costmap_(costmap),
     world_model_(world_model), footprint_spec_(footprint_spec),
@@ -189,6 +190,16 @@ namespace base_local_planner{
 
   TrajectoryPlanner::~TrajectoryPlanner(){}
 
+  void TrajectoryPlanner::setFootprint( std::vector<geometry_msgs::Point> footprint ) {
+    footprint_spec_ = footprint;
+    footprint_mask_.setFootprint(footprint_spec_, costmap_.getResolution(), footprint_mask_headings_);
+  }
+
+  void TrajectoryPlanner::setFootprintMaskHeadings(unsigned int num_headings) {
+    footprint_mask_headings_ = num_headings;
+    footprint_mask_.setFootprint(footprint_spec_, costmap_.getResolution(), footprint_mask_headings_);
+  }
+
   bool TrajectoryPlanner::getCellCosts(int cx, int cy, float &path_cost, float &goal_cost, float &occ_cost, float &total_cost) {
     MapCell cell = path_map_(cx, cy);
     MapCell goal_cell = goal_map_(cx, cy);
@@ -913,13 +924,23 @@ namespace base_local_planner{
     path_map_.resetPathDist();
     goal_map_.resetPathDist();
 
+    //the costmap may have changed resolution since the mask was computed
+    if (footprint_mask_.isValid() &&
+        !footprint_mask_.matches(footprint_spec_, costmap_.getResolution(), footprint_mask_headings_)) {
+      footprint_mask_.setFootprint(footprint_spec_, costmap_.getResolution(), footprint_mask_headings_);
+    }
+
     //temporarily remove obstacles that are within the footprint of the robot
-    std::vector<base_local_planner::Position2DInt> footprint_list =
-        footprint_helper_.getFootprintCells(
-            pos,
-            footprint_spec_,
-            costmap_,
-            true);
+    std::vector<base_local_planner::Position2DInt> footprint_list;
+    if (footprint_mask_.isValid()) {
+      footprint_mask_.getFootprintCells(costmap_, pos[0], pos[1], pos[2], true, footprint_list);
+    } else {
+      footprint_list = footprint_helper_.getFootprintCells(
+          pos,
+          footprint_spec_,
+          costmap_,
+          true);
+    }
 
     //mark cells within the initial footprint of the robot
     for (unsigned int i = 0; i < footprint_list.size(); ++i) {
@@ -979,6 +1000,9 @@ namespace base_local_planner{
   //we need to take the footprint of the robot into account when we calculate cost to obstacles
   double TrajectoryPlanner::footprintCost(double x_i, double y_i, double theta_i){
     //check if the footprint is legal
+    if (footprint_mask_.isValid()) {
+      return footprint_mask_.footprintCost(costmap_, x_i, y_i, theta_i);
+    }
     return world_model_.footprintCost(x_i, y_i, theta_i, footprint_spec_, inscribed_radius_, circumscribed_radius_);
   }
 
@@ -233,6 +233,11 @@ namespace base_local_planner {
           max_vel_x, min_vel_x, max_vel_th_, min_vel_th_, min_in_place_vel_th_, backup_vel,
           dwa, heading_scoring, heading_scoring_timestep, meter_scoring, simple_attractor, y_vels, stop_time_buffer, sim_period_, angular_sim_granularity);
 
+      //precompute the footprint cells for this many headings instead of rasterizing the footprint for every check
+      int footprint_mask_headings;
+      private_nh.param("footprint_mask_headings", footprint_mask_headings, 0);
+      tc_->setFootprintMaskHeadings(std::max(footprint_mask_headings, 0));
+
       map_viz_.initialize(name, global_frame_, boost::bind(&TrajectoryPlanner::getCellCosts, tc_, _1, _2, _3, _4, _5, _6));
       initialized_ = true;
 
@@ -0,0 +1,134 @@
+/*
+ * footprint_mask_test.cpp
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <base_local_planner/footprint_helper.h>
+#include <base_local_planner/footprint_mask.h>
+#include <base_local_planner/costmap_model.h>
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/cost_values.h>
+
+namespace base_local_planner {
+
+std::vector<geometry_msgs::Point> squareFootprint() {
+  std::vector<geometry_msgs::Point> footprint_spec;
+  geometry_msgs::Point pt;
+  pt.x = 2;
+  pt.y = 2;
+  footprint_spec.push_back(pt);
+  pt.x = 2;
+  pt.y = -2;
+  footprint_spec.push_back(pt);
+  pt.x = -2;
+  pt.y = -2;
+  footprint_spec.push_back(pt);
+  pt.x = -2;
+  pt.y = 2;
+  footprint_spec.push_back(pt);
+  return footprint_spec;
+}
+
+std::set<std::pair<int, int> > toSet(const std::vector<base_local_planner::Position2DInt>& cells) {
+  std::set<std::pair<int, int> > result;
+  for (unsigned int i = 0; i < cells.size(); ++i) {
+    result.insert(std::make_pair((int) cells[i].x, (int) cells[i].y));
+  }
+  return result;
+}
+
+bool contains(const std::set<std::pair<int, int> >& outer, const std::set<std::pair<int, int> >& inner) {
+  return std::includes(outer.begin(), outer.end(), inner.begin(), inner.end());
+}
+
+TEST(FootprintMaskTest, coversFootprintHelper){
+  costmap_2d::Costmap2D map(10, 10, 1.0, 0.0, 0.0);
+  std::vector<geometry_msgs::Point> footprint_spec = squareFootprint();
+  FootprintMask mask;
+  mask.setFootprint(footprint_spec, map.getResolution(), 360);
+  ASSERT_TRUE(mask.isValid());
+  EXPECT_TRUE(mask.matches(footprint_spec, 1.0, 360));
+  EXPECT_FALSE(mask.matches(footprint_spec, 0.5, 360));
+
+  FootprintHelper fh;
+  double thetas[4] = {0, M_PI_2, M_PI, -M_PI_2};
+  for (unsigned int i = 0; i < 4; ++i) {
+    Eigen::Vector3f pos(4.5, 4.5, thetas[i]);
+    std::vector<base_local_planner::Position2DInt> cells;
+
+    //the 5x5 outline grown by one cell on both sides leaves only the center cell out
+    mask.getFootprintCells(map, pos[0], pos[1], pos[2], false, cells);
+    EXPECT_EQ(48, cells.size());
+    EXPECT_TRUE(contains(toSet(cells), toSet(fh.getFootprintCells(pos, footprint_spec, map, false))));
+
+    mask.getFootprintCells(map, pos[0], pos[1], pos[2], true, cells);
+    EXPECT_EQ(49, cells.size());
+  }
+}
+
+TEST(FootprintMaskTest, coversAnyPositionInTheCell){
+  costmap_2d::Costmap2D map(100, 100, 0.05, 0.0, 0.0);
+  std::vector<geometry_msgs::Point> footprint_spec(4);
+  footprint_spec[0].x = 0.42;
+  footprint_spec[0].y = 0.27;
+  footprint_spec[1].x = 0.42;
+  footprint_spec[1].y = -0.27;
+  footprint_spec[2].x = -0.31;
+  footprint_spec[2].y = -0.27;
+  footprint_spec[3].x = -0.31;
+  footprint_spec[3].y = 0.27;
+  FootprintMask mask;
+  mask.setFootprint(footprint_spec, map.getResolution(), 16);
+
+  FootprintHelper fh;
+  unsigned int seed = 1;
+  for (unsigned int i = 0; i < 2000; ++i) {
+    Eigen::Vector3f pos(2.5 + 0.05 * rand_r(&seed) / RAND_MAX, 2.5 + 0.05 * rand_r(&seed) / RAND_MAX,
+        2 * M_PI * rand_r(&seed) / RAND_MAX - M_PI);
+    std::vector<base_local_planner::Position2DInt> cells;
+    mask.getFootprintCells(map, pos[0], pos[1], pos[2], false, cells);
+    ASSERT_TRUE(contains(toSet(cells), toSet(fh.getFootprintCells(pos, footprint_spec, map, false))))
+        << "at " << pos[0] << ", " << pos[1] << ", " << pos[2];
+  }
+}
+
+TEST(FootprintMaskTest, boundsCostmapModel){
+  costmap_2d::Costmap2D map(10, 10, 1.0, 0.0, 0.0);
+  for (unsigned int x = 0; x < 10; ++x) {
+    for (unsigned int y = 0; y < 10; ++y) {
+      map.setCost(x, y, (x * 7 + y * 13) % 200);
+    }
+  }
+  std::vector<geometry_msgs::Point> footprint_spec = squareFootprint();
+  FootprintMask mask;
+  mask.setFootprint(footprint_spec, map.getResolution(), 360);
+  CostmapModel cm(map);
+
+  double thetas[5] = {0, M_PI_2, M_PI, -M_PI_2, 2 * M_PI};
+  for (unsigned int i = 0; i < 5; ++i) {
+    EXPECT_GE(mask.footprintCost(map, 4.5, 4.5, thetas[i]),
+        cm.footprintCost(4.5, 4.5, thetas[i], footprint_spec));
+  }
+
+  //only the grown outline is checked, like the outline in the costmap model
+  map.setCost(4, 4, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_GE(mask.footprintCost(map, 4.5, 4.5, 0), 0.0);
+
+  map.setCost(6, 4, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(-1.0, mask.footprintCost(map, 4.5, 4.5, 0));
+  map.setCost(6, 4, costmap_2d::NO_INFORMATION);
+  EXPECT_EQ(-1.0, mask.footprintCost(map, 4.5, 4.5, 0));
+
+  //footprints that leave the map are illegal
+  EXPECT_EQ(-1.0, mask.footprintCost(map, 1.5, 4.5, 0));
+  EXPECT_EQ(-1.0, mask.footprintCost(map, -1.0, 4.5, 0));
+}
+
+}
@@ -43,6 +43,9 @@
 #include <costmap_2d/costmap_2d_publisher.h>
 #include <costmap_2d/Costmap2DConfig.h>
 #include <costmap_2d/footprint.h>
+#include <costmap_2d/update_profiler.h>
+#include <costmap_2d/GetUpdateStatistics.h>
+#include <diagnostic_msgs/DiagnosticStatus.h>
 #include <geometry_msgs/Polygon.h>
 #include <geometry_msgs/PolygonStamped.h>
 #include <dynamic_reconfigure/server.h>
@@ -233,6 +236,22 @@ private:
   void reconfigureCB(costmap_2d::Costmap2DConfig &config, uint32_t level);
   void movementCB(const ros::TimerEvent &event);
   void mapUpdateLoop(double frequency);
+
+  /**
+   * @brief  Wake up the map update thread, used as the update request callback of the layered costmap
+   */
+  void requestUpdate();
+
+  /**
+   * @brief  Block until a layer requests an update, or the robot moved far enough or the map went stale
+   * @param frequency The rate at which the robot pose is checked while no update is requested
+   * @return True if the map should be updated
+   */
+  bool waitForUpdateEvent(double frequency);
+  void getUpdateStatistics(std::vector<diagnostic_msgs::DiagnosticStatus>& statistics) const;
+  void publishUpdateStatistics(const ros::TimerEvent &event);
+  bool updateStatisticsService(costmap_2d::GetUpdateStatistics::Request &req,
+                               costmap_2d::GetUpdateStatistics::Response &resp);
   bool map_update_thread_shutdown_;
   bool stop_updates_, initialized_, stopped_, robot_stopped_;
   boost::thread* map_update_thread_;  ///< @brief A thread for updating the map
@@ -253,6 +272,21 @@ private:
   std::vector<geometry_msgs::Point> padded_footprint_;
   float footprint_padding_;
   costmap_2d::Costmap2DConfig old_config_;
+
+  UpdateProfiler* profiler_;  ///< @brief Timing of the update loop, NULL unless profile_updates is set
+  int publish_channel_;
+  ros::Timer statistics_timer_;
+  ros::Publisher statistics_pub_;
+  ros::ServiceServer statistics_srv_;
+
+  bool update_on_events_;  ///< @brief Update only when new data arrived or the robot moved, instead of at a fixed rate
+  double min_event_update_period_, max_event_update_period_;
+  double update_translation_threshold_, update_rotation_threshold_;
+  bool update_requested_;
+  boost::mutex update_request_mutex_;
+  boost::condition_variable update_request_cond_;
+  ros::WallTime last_event_update_;
+  tf::Stamped<tf::Pose> last_event_update_pose_;
 };
 // class Costmap2DROS
 }  // namespace costmap_2d
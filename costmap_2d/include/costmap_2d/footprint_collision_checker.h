@@ -0,0 +1,115 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_FOOTPRINT_COLLISION_CHECKER_H_
+#define COSTMAP_2D_FOOTPRINT_COLLISION_CHECKER_H_
+
+#include <vector>
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/obstacle_distance_field.h>
+#include <geometry_msgs/Point.h>
+
+namespace costmap_2d
+{
+
+/**
+ * @brief A circle in the robot frame, part of a set of circles covering a footprint
+ */
+struct FootprintCircle
+{
+  double x;
+  double y;
+  double radius;
+};
+
+/**
+ * @brief  Cover a footprint with circles placed along its longer axis
+ * @param footprint The footprint of the robot in the robot frame
+ * @param num_circles The number of circles, 0 picks one circle per footprint width along the longer axis
+ * @return Circles whose union contains the footprint
+ */
+std::vector<FootprintCircle> computeCoveringCircles(const std::vector<geometry_msgs::Point>& footprint,
+                                                    unsigned int num_circles = 0);
+
+/**
+ * @class FootprintCollisionChecker
+ * @brief Checks whether a footprint overlaps lethal cells of a costmap.
+ *
+ * The footprint is first checked with its covering circles against an
+ * ObstacleDistanceField, which costs one lookup per circle. Only if a circle
+ * comes close to an obstacle, the footprint polygon is rasterized and its
+ * cells are checked one by one.
+ */
+class FootprintCollisionChecker
+{
+public:
+  FootprintCollisionChecker();
+
+  /**
+   * @brief  Set the footprint to check and compute its covering circles
+   * @param footprint The footprint of the robot in the robot frame
+   * @param num_circles The number of covering circles, 0 picks it from the shape of the footprint
+   */
+  void setFootprint(const std::vector<geometry_msgs::Point>& footprint, unsigned int num_circles = 0);
+
+  const std::vector<FootprintCircle>& getCircles() const
+  {
+    return circles_;
+  }
+
+  /**
+   * @brief  Check whether the footprint at a pose is free of lethal obstacles and lies on the map
+   * @param costmap The costmap to check against
+   * @param distance_field The distance field of the costmap, may be NULL to always check the polygon
+   * @param x The x position of the robot in world coordinates
+   * @param y The y position of the robot in world coordinates
+   * @param theta The orientation of the robot
+   * @return True if no cell of the footprint is a lethal obstacle
+   */
+  bool isCollisionFree(Costmap2D& costmap, const ObstacleDistanceField* distance_field,
+                       double x, double y, double theta) const;
+
+  /**
+   * @brief  Check the footprint polygon cell by cell, without using the distance field
+   */
+  bool isPolygonCollisionFree(Costmap2D& costmap, double x, double y, double theta) const;
+
+private:
+  std::vector<geometry_msgs::Point> footprint_;
+  std::vector<FootprintCircle> circles_;
+};
+
+}  // namespace costmap_2d
+
+#endif  // COSTMAP_2D_FOOTPRINT_COLLISION_CHECKER_H_
@@ -41,6 +41,7 @@
 #include <ros/ros.h>
 #include <costmap_2d/layer.h>
 #include <costmap_2d/layered_costmap.h>
+#include <costmap_2d/obstacle_distance_field.h>
 #include <costmap_2d/InflationPluginConfig.h>
 #include <dynamic_reconfigure/server.h>
 #include <boost/thread.hpp>
@@ -123,6 +124,16 @@ public:
    */
   void setInflationParameters(double inflation_radius, double cost_scaling_factor);
 
+  /**
+   * @brief  Get the distance from each cell to the nearest lethal obstacle, computed during inflation
+   * @return The distance field, or NULL if the compute_distance_field parameter is not set.
+   * The field is only valid while holding the lock of the master costmap.
+   */
+  const ObstacleDistanceField* getDistanceField() const
+  {
+    return compute_distance_field_ ? &distance_field_ : NULL;
+  }
+
 protected:
   virtual void onFootprintChanged();
   boost::recursive_mutex* inflation_access_;
@@ -160,6 +171,7 @@ private:
 
   void computeCaches();
   void deleteKernels();
+  void updateDistanceFieldBounds(const costmap_2d::Costmap2D& master_grid, int& min_i, int& min_j, int& max_i, int& max_j);
   void inflate_area(int min_i, int min_j, int max_i, int max_j, unsigned char* master_grid);
 
   unsigned int cellDistance(double world_dist)
@@ -188,6 +200,10 @@ private:
   void reconfigureCB(costmap_2d::InflationPluginConfig &config, uint32_t level);
 
   bool need_reinflation_;  ///< Indicates that the entire costmap should be reinflated next time around.
+
+  bool compute_distance_field_;
+  ObstacleDistanceField distance_field_;
+  double distance_field_origin_x_, distance_field_origin_y_;
 };
 
 }  // namespace costmap_2d
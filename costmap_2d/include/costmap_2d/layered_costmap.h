@@ -41,6 +41,9 @@
 #include <costmap_2d/cost_values.h>
 #include <costmap_2d/layer.h>
 #include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/update_profiler.h>
+#include <boost/function.hpp>
+#include <algorithm>
 #include <vector>
 #include <string>
 
@@ -132,6 +135,19 @@ public:
       return initialized_;
   }
 
+  /** @brief Get the union of the areas of the master costmap that
+   * changed since the last call, and start a new one. xn and yn are
+   * exclusive, the area is empty if xn <= x0. A resize or a move of the
+   * rolling window covers the whole map.
+   *
+   * Meant for one user that keeps data derived from the costmap, e.g. a
+   * planner. Call it with the mutex of the costmap locked. */
+  void takeChangedArea(unsigned int* x0, unsigned int* xn, unsigned int* y0, unsigned int* yn);
+
+  /** @brief Add cells to the area returned by takeChangedArea(), for
+   * changes made to the master costmap outside of updateMap(). */
+  void addChangedArea(unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn);
+
   /** @brief Updates the stored footprint, updates the circumscribed
    * and inscribed radii, and calls onFootprintChanged() in all
    * layers. */
@@ -154,6 +170,41 @@ public:
    * This is updated by setFootprint(). */
   double getInscribedRadius() { return inscribed_radius_; }
 
+  /** @brief Record the lock wait, per layer updateBounds()/updateCosts()
+   * durations and written cells and size of the updated area of every
+   * update in the given profiler. NULL (the default) disables
+   * profiling. The profiler is not owned by the LayeredCostmap. */
+  void setProfiler(UpdateProfiler* profiler);
+
+  bool isProfiling() const
+  {
+    return profiler_ != NULL;
+  }
+
+  /** @brief Called by layers from updateCosts() with the number of
+   * cells of the master grid they wrote. Layers that never call it
+   * have no written_cells channel. */
+  void addWrittenCells(unsigned int cells)
+  {
+    written_cells_ = std::max(written_cells_, 0L) + cells;
+  }
+
+  /** @brief Set the function called by requestUpdate(), typically
+   * waking up the thread that runs updateMap(). */
+  void setUpdateRequestCallback(const boost::function<void()>& callback)
+  {
+    update_request_callback_ = callback;
+  }
+
+  /** @brief Called by layers when they received data that should be
+   * integrated into the map as soon as possible, e.g. a new sensor
+   * reading. Safe to call from any thread. */
+  void requestUpdate()
+  {
+    if (update_request_callback_)
+      update_request_callback_();
+  }
+
 private:
   Costmap2D costmap_;
   std::string global_frame_;
@@ -163,6 +214,7 @@ private:
   bool current_;
   double minx_, miny_, maxx_, maxy_;
   unsigned int bx0_, bxn_, by0_, byn_;
+  unsigned int cx0_, cxn_, cy0_, cyn_;  /// < @brief The area changed since the last takeChangedArea()
 
   std::vector<boost::shared_ptr<Layer> > plugins_;
 
@@ -170,6 +222,13 @@ private:
   bool size_locked_;
   double circumscribed_radius_, inscribed_radius_;
   std::vector<geometry_msgs::Point> footprint_;
+
+  UpdateProfiler* profiler_;
+  std::vector<int> bounds_channels_, costs_channels_, written_channels_;
+  long written_cells_;  /// < @brief Cells written by the layer in updateCosts(), -1 if it did not tell
+  int lock_channel_, update_channel_, area_channel_;
+
+  boost::function<void()> update_request_callback_;
 };
 
 }  // namespace costmap_2d
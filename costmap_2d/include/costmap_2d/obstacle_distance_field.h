@@ -0,0 +1,155 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_OBSTACLE_DISTANCE_FIELD_H_
+#define COSTMAP_2D_OBSTACLE_DISTANCE_FIELD_H_
+
+#include <algorithm>
+#include <vector>
+
+namespace costmap_2d
+{
+
+/**
+ * @class ObstacleDistanceField
+ * @brief Stores, for every cell of a costmap, the distance in meters to the
+ * nearest lethal cell.
+ *
+ * Distances are only known up to getMaxDistance(); cells farther away from
+ * any obstacle hold exactly that value, which is therefore a lower bound.
+ */
+class ObstacleDistanceField
+{
+public:
+  ObstacleDistanceField() : size_x_(0), size_y_(0), max_distance_(0.0) {}
+
+  /**
+   * @brief  Resize the field, marking every cell as an obstacle until it is computed
+   * @param size_x The x size of the costmap in cells
+   * @param size_y The y size of the costmap in cells
+   * @param max_distance The distance stored for cells with no obstacle in range
+   */
+  void resize(unsigned int size_x, unsigned int size_y, double max_distance)
+  {
+    size_x_ = size_x;
+    size_y_ = size_y;
+    max_distance_ = max_distance;
+    distances_.assign(size_x * size_y, 0.0f);
+  }
+
+  /** @brief Release the field, making it invalid */
+  void clear()
+  {
+    size_x_ = size_y_ = 0;
+    distances_.clear();
+  }
+
+  /**
+   * @brief  Reset a region of the field to the maximum distance
+   */
+  void resetRegion(unsigned int x0, unsigned int y0, unsigned int xn, unsigned int yn)
+  {
+    for (unsigned int y = y0; y < yn; ++y)
+      std::fill(distances_.begin() + y * size_x_ + x0, distances_.begin() + y * size_x_ + xn, float(max_distance_));
+  }
+
+  /**
+   * @brief  Move the field along with a costmap whose origin moved by a number of cells
+   * @param cell_dx The change of the x origin in cells
+   * @param cell_dy The change of the y origin in cells
+   *
+   * Cells that were not covered before the move are marked as obstacles.
+   */
+  void shift(int cell_dx, int cell_dy)
+  {
+    std::vector<float> shifted(distances_.size(), 0.0f);
+    for (int y = 0; y < (int)size_y_; ++y)
+    {
+      int old_y = y + cell_dy;
+      if (old_y < 0 || old_y >= (int)size_y_)
+        continue;
+      for (int x = 0; x < (int)size_x_; ++x)
+      {
+        int old_x = x + cell_dx;
+        if (old_x >= 0 && old_x < (int)size_x_)
+          shifted[y * size_x_ + x] = distances_[old_y * size_x_ + old_x];
+      }
+    }
+    distances_.swap(shifted);
+  }
+
+  /**
+   * @brief  Record a distance for a cell, keeping the smaller of the stored and the given value
+   */
+  inline void lowerDistance(unsigned int index, float distance)
+  {
+    if (distance < distances_[index])
+      distances_[index] = distance;
+  }
+
+  /** @brief Whether the field has been sized for a costmap */
+  bool isValid() const
+  {
+    return !distances_.empty();
+  }
+
+  inline double getDistance(unsigned int mx, unsigned int my) const
+  {
+    return distances_[my * size_x_ + mx];
+  }
+
+  unsigned int getSizeInCellsX() const
+  {
+    return size_x_;
+  }
+
+  unsigned int getSizeInCellsY() const
+  {
+    return size_y_;
+  }
+
+  double getMaxDistance() const
+  {
+    return max_distance_;
+  }
+
+private:
+  unsigned int size_x_, size_y_;
+  double max_distance_;
+  std::vector<float> distances_;
+};
+
+}  // namespace costmap_2d
+
+#endif  // COSTMAP_2D_OBSTACLE_DISTANCE_FIELD_H_
@@ -0,0 +1,125 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#ifndef COSTMAP_2D_UPDATE_PROFILER_H_
+#define COSTMAP_2D_UPDATE_PROFILER_H_
+
+#include <string>
+#include <vector>
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread.hpp>
+
+namespace costmap_2d
+{
+
+/**
+ * @brief Summary of the samples recorded for one channel of an UpdateProfiler
+ */
+struct ProfileStatistics
+{
+  std::string name;
+  unsigned int count;
+  double mean, p50, p90, p99, max;
+};
+
+/**
+ * @class UpdateProfiler
+ * @brief Keeps the most recent samples of named measurements (e.g. the time
+ * a layer spends in updateCosts) taken during costmap updates.
+ *
+ * Each channel is a ring buffer written by a single thread, the update
+ * thread, without locking. Any other thread may read statistics at the same
+ * time; a sample that is overwritten while being read is simply one sample
+ * newer than expected.
+ */
+class UpdateProfiler
+{
+public:
+  static const unsigned int MAX_CHANNELS = 64;
+
+  /**
+   * @param window_size The number of most recent samples kept per channel
+   */
+  explicit UpdateProfiler(unsigned int window_size = 1000);
+  ~UpdateProfiler();
+
+  /**
+   * @brief  Get the channel with the given name, creating it if needed
+   * @return The channel id to pass to record(), or -1 if there are MAX_CHANNELS channels already
+   */
+  int getChannel(const std::string& name);
+
+  /**
+   * @brief  Record a sample, may only be called from one thread per channel
+   */
+  void record(int channel, double value);
+
+  /**
+   * @brief  Compute statistics over the samples of each channel recorded since the last reset()
+   */
+  void getStatistics(std::vector<ProfileStatistics>& statistics) const;
+
+  /**
+   * @brief  Forget all samples recorded so far
+   */
+  void reset();
+
+private:
+  class SampleRing
+  {
+  public:
+    explicit SampleRing(unsigned int size);
+
+    void push(double value);
+    void snapshot(std::vector<float>& samples) const;
+    void reset();
+
+  private:
+    unsigned int size_;
+    boost::scoped_array<boost::atomic<float> > samples_;
+    boost::atomic<unsigned long> written_;
+    boost::atomic<unsigned long> reset_mark_;
+  };
+
+  unsigned int window_size_;
+  SampleRing* rings_[MAX_CHANNELS];
+  std::vector<std::string> names_;
+  boost::atomic<unsigned int> num_channels_;
+  mutable boost::mutex names_mutex_;
+};
+
+}  // namespace costmap_2d
+
+#endif  // COSTMAP_2D_UPDATE_PROFILER_H_
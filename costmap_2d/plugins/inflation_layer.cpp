@@ -64,6 +64,9 @@ InflationLayer::InflationLayer()
   , last_min_y_(-std::numeric_limits<float>::max())
   , last_max_x_(std::numeric_limits<float>::max())
   , last_max_y_(std::numeric_limits<float>::max())
+  , compute_distance_field_(false)
+  , distance_field_origin_x_(0.0)
+  , distance_field_origin_y_(0.0)
 {
   inflation_access_ = new boost::recursive_mutex();
 }
@@ -79,6 +82,8 @@ void InflationLayer::onInitialize()
     seen_ = NULL;
     seen_size_ = 0;
     need_reinflation_ = false;
+    nh.param("compute_distance_field", compute_distance_field_, false);
+    distance_field_.clear();
 
     dynamic_reconfigure::Server<costmap_2d::InflationPluginConfig>::CallbackType cb = boost::bind(
         &InflationLayer::reconfigureCB, this, _1, _2);
@@ -173,7 +178,10 @@ void InflationLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i,
 {
   boost::unique_lock < boost::recursive_mutex > lock(*inflation_access_);
   if (!enabled_ || (cell_inflation_radius_ == 0))
+  {
+    distance_field_.clear();
     return;
+  }
 
   // make sure the inflation list is empty at the beginning of the cycle (should always be true)
   ROS_ASSERT_MSG(inflation_cells_.empty(), "The inflation list must be empty at the beginning of inflation");
@@ -195,6 +203,9 @@ void InflationLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i,
   }
   memset(seen_, false, size_x * size_y * sizeof(bool));
 
+  if (compute_distance_field_)
+    updateDistanceFieldBounds(master_grid, min_i, min_j, max_i, max_j);
+
   // We need to include in the inflation cells outside the bounding
   // box min_i...max_j, by the amount cell_inflation_radius_.  Cells
   // up to that distance outside the box can still influence the costs
@@ -229,6 +240,7 @@ void InflationLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i,
 
   // Process cells by increasing distance; new cells are appended to the corresponding distance bin, so they
   // can overtake previously inserted but farther away cells
+  unsigned int written_cells = 0;
   std::map<double, std::vector<CellData> >::iterator bin;
   for (bin = inflation_cells_.begin(); bin != inflation_cells_.end(); ++bin)
   {
@@ -252,6 +264,9 @@ void InflationLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i,
       unsigned int sx = cell.src_x_;
       unsigned int sy = cell.src_y_;
 
+      if (compute_distance_field_)
+        distance_field_.lowerDistance(index, distanceLookup(mx, my, sx, sy) * resolution_);
+
       // assign the cost associated with the distance from an obstacle to the cell
       unsigned char cost = costLookup(mx, my, sx, sy);
       unsigned char old_cost = master_array[index];
@@ -259,6 +274,7 @@ void InflationLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i,
         master_array[index] = cost;
       else
         master_array[index] = std::max(old_cost, cost);
+      ++written_cells;
 
       // attempt to put the neighbors of the current cell onto the inflation list
       if (mx > 0)
@@ -273,6 +289,39 @@ void InflationLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i,
   }
 
   inflation_cells_.clear();
+  layered_costmap_->addWrittenCells(written_cells);
+}
+
+void InflationLayer::updateDistanceFieldBounds(const costmap_2d::Costmap2D& master_grid,
+                                               int& min_i, int& min_j, int& max_i, int& max_j)
+{
+  unsigned int size_x = master_grid.getSizeInCellsX(), size_y = master_grid.getSizeInCellsY();
+  double max_distance = cell_inflation_radius_ * resolution_;
+
+  if (!distance_field_.isValid() || distance_field_.getSizeInCellsX() != size_x ||
+      distance_field_.getSizeInCellsY() != size_y || distance_field_.getMaxDistance() != max_distance)
+  {
+    // a new field has no distances yet, so the whole map has to be inflated once
+    distance_field_.resize(size_x, size_y, max_distance);
+    min_i = 0;
+    min_j = 0;
+    max_i = size_x;
+    max_j = size_y;
+  }
+  else if (master_grid.getOriginX() != distance_field_origin_x_ || master_grid.getOriginY() != distance_field_origin_y_)
+  {
+    // keep the field aligned with a rolling window
+    int cell_dx = int(round((master_grid.getOriginX() - distance_field_origin_x_) / resolution_));
+    int cell_dy = int(round((master_grid.getOriginY() - distance_field_origin_y_) / resolution_));
+    distance_field_.shift(cell_dx, cell_dy);
+  }
+  distance_field_origin_x_ = master_grid.getOriginX();
+  distance_field_origin_y_ = master_grid.getOriginY();
+
+  // cells in the bounds get their distance from the obstacles around them, all other cells
+  // can only get closer to an obstacle during this update
+  distance_field_.resetRegion(std::max(0, min_i), std::max(0, min_j),
+                              std::min(int(size_x), max_i), std::min(int(size_y), max_j));
 }
 
 /**
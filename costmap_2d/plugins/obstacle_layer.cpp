@@ -272,6 +272,7 @@ void ObstacleLayer::laserScanCallback(const sensor_msgs::LaserScanConstPtr& mess
   buffer->lock();
   buffer->bufferCloud(cloud);
   buffer->unlock();
+  layered_costmap_->requestUpdate();
 }
 
 void ObstacleLayer::laserScanValidInfCallback(const sensor_msgs::LaserScanConstPtr& raw_message,
@@ -309,6 +310,7 @@ void ObstacleLayer::laserScanValidInfCallback(const sensor_msgs::LaserScanConstP
   buffer->lock();
   buffer->bufferCloud(cloud);
   buffer->unlock();
+  layered_costmap_->requestUpdate();
 }
 
 void ObstacleLayer::pointCloudCallback(const sensor_msgs::PointCloudConstPtr& message,
@@ -326,6 +328,7 @@ void ObstacleLayer::pointCloudCallback(const sensor_msgs::PointCloudConstPtr& me
   buffer->lock();
   buffer->bufferCloud(cloud2);
   buffer->unlock();
+  layered_costmap_->requestUpdate();
 }
 
 void ObstacleLayer::pointCloud2Callback(const sensor_msgs::PointCloud2ConstPtr& message,
@@ -335,6 +338,7 @@ void ObstacleLayer::pointCloud2Callback(const sensor_msgs::PointCloud2ConstPtr&
   buffer->lock();
   buffer->bufferCloud(*message);
   buffer->unlock();
+  layered_costmap_->requestUpdate();
 }
 
 void ObstacleLayer::updateBounds(double robot_x, double robot_y, double robot_yaw, double* min_x,
@@ -443,7 +447,23 @@ void ObstacleLayer::updateCosts(costmap_2d::Costmap2D& master_grid, int min_i, i
       updateWithMax(master_grid, min_i, min_j, max_i, max_j);
       break;
     default:  // Nothing
-      break;
+      return;
+  }
+
+  // both methods write or merge every cell this layer has information about, counting them takes another pass
+  if (layered_costmap_->isProfiling())
+  {
+    unsigned int written_cells = 0;
+    for (int j = min_j; j < max_j; j++)
+    {
+      unsigned int it = getIndex(min_i, j);
+      for (int i = min_i; i < max_i; i++, it++)
+      {
+        if (costmap_[it] != NO_INFORMATION)
+          written_cells++;
+      }
+    }
+    layered_costmap_->addWrittenCells(written_cells);
   }
 }
 
@@ -212,6 +212,7 @@ void StaticLayer::incomingMap(const nav_msgs::OccupancyGridConstPtr& new_map)
   height_ = size_y_;
   map_received_ = true;
   has_updated_data_ = true;
+  layered_costmap_->requestUpdate();
 
   // shutdown the map subscrber if firt_map_only_ flag is on
   if (first_map_only_)
@@ -238,6 +239,7 @@ void StaticLayer::incomingUpdate(const map_msgs::OccupancyGridUpdateConstPtr& up
   width_ = update->width;
   height_ = update->height;
   has_updated_data_ = true;
+  layered_costmap_->requestUpdate();
 }
 
 void StaticLayer::activate()
@@ -37,7 +37,9 @@
  *********************************************************************/
 #include <costmap_2d/layered_costmap.h>
 #include <costmap_2d/costmap_2d_ros.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
 #include <cstdio>
+#include <sstream>
 #include <string>
 #include <algorithm>
 #include <vector>
@@ -62,7 +64,8 @@ void move_parameter(ros::NodeHandle& old_h, ros::NodeHandle& new_h, std::string
 Costmap2DROS::Costmap2DROS(std::string name, tf::TransformListener& tf) :
     layered_costmap_(NULL), name_(name), tf_(tf), stop_updates_(false), initialized_(true), stopped_(false),
     robot_stopped_(false), map_update_thread_(NULL), last_publish_(0),
-    plugin_loader_("costmap_2d", "costmap_2d::Layer"), publisher_(NULL)
+    plugin_loader_("costmap_2d", "costmap_2d::Layer"), publisher_(NULL), profiler_(NULL), publish_channel_(-1),
+    update_on_events_(false), update_requested_(true)
 {
   ros::NodeHandle private_nh("~/" + name);
   ros::NodeHandle g_nh;
@@ -106,6 +109,19 @@ Costmap2DROS::Costmap2DROS(std::string name, tf::TransformListener& tf) :
 
   layered_costmap_ = new LayeredCostmap(global_frame_, rolling_window, track_unknown_space);
 
+  // optionally update the map when layers receive new data or the robot moves, instead of at update_frequency
+  private_nh.param("update_on_events", update_on_events_, false);
+  if (update_on_events_)
+  {
+    double max_event_update_frequency;
+    private_nh.param("max_event_update_frequency", max_event_update_frequency, 20.0);
+    private_nh.param("max_event_update_period", max_event_update_period_, 1.0);
+    private_nh.param("update_translation_threshold", update_translation_threshold_, 0.05);
+    private_nh.param("update_rotation_threshold", update_rotation_threshold_, 0.05);
+    min_event_update_period_ = max_event_update_frequency > 0.0 ? 1.0 / max_event_update_frequency : 0.0;
+    layered_costmap_->setUpdateRequestCallback(boost::bind(&Costmap2DROS::requestUpdate, this));
+  }
+
   if (!private_nh.hasParam("plugins"))
   {
     resetOldParameters(private_nh);
@@ -150,6 +166,22 @@ Costmap2DROS::Costmap2DROS(std::string name, tf::TransformListener& tf) :
   publisher_ = new Costmap2DPublisher(&private_nh, layered_costmap_->getCostmap(), global_frame_, "costmap",
                                       always_send_full_costmap);
 
+  // optionally keep timing statistics of the update loop, broken down by layer
+  bool profile_updates;
+  private_nh.param("profile_updates", profile_updates, false);
+  if (profile_updates)
+  {
+    int profile_window_size;
+    private_nh.param("profile_window_size", profile_window_size, 1000);
+    profiler_ = new UpdateProfiler(std::max(profile_window_size, 1));
+    publish_channel_ = profiler_->getChannel("publish_ms");
+    layered_costmap_->setProfiler(profiler_);
+
+    statistics_pub_ = private_nh.advertise<diagnostic_msgs::DiagnosticArray>("update_statistics", 1);
+    statistics_srv_ = private_nh.advertiseService("get_update_statistics", &Costmap2DROS::updateStatisticsService, this);
+    statistics_timer_ = private_nh.createTimer(ros::Duration(1.0), &Costmap2DROS::publishUpdateStatistics, this);
+  }
+
   // create a thread to handle updating the map
   stop_updates_ = false;
   initialized_ = true;
@@ -182,6 +214,7 @@ Costmap2DROS::~Costmap2DROS()
     delete publisher_;
 
   delete layered_costmap_;
+  delete profiler_;
   delete dsrv_;
 }
 
@@ -379,6 +412,9 @@ void Costmap2DROS::mapUpdateLoop(double frequency)
   ros::Rate r(frequency);
   while (nh.ok() && !map_update_thread_shutdown_)
   {
+    if (update_on_events_ && !waitForUpdateEvent(frequency))
+      continue;
+
     struct timeval start, end;
     double start_t, end_t, t_diff;
     gettimeofday(&start, NULL);
@@ -399,10 +435,16 @@ void Costmap2DROS::mapUpdateLoop(double frequency)
       ros::Time now = ros::Time::now();
       if (last_publish_ + publish_cycle < now)
       {
+        ros::WallTime publish_start = ros::WallTime::now();
         publisher_->publishCostmap();
         last_publish_ = now;
+        if (profiler_)
+          profiler_->record(publish_channel_, (ros::WallTime::now() - publish_start).toSec() * 1e3);
       }
     }
+    if (update_on_events_)
+      continue;
+
     r.sleep();
     // make sure to sleep for the remainder of our cycle time
     if (r.cycleTime() > ros::Duration(1 / frequency))
@@ -411,6 +453,101 @@ void Costmap2DROS::mapUpdateLoop(double frequency)
   }
 }
 
+void Costmap2DROS::requestUpdate()
+{
+  {
+    boost::mutex::scoped_lock lock(update_request_mutex_);
+    update_requested_ = true;
+  }
+  update_request_cond_.notify_one();
+}
+
+bool Costmap2DROS::waitForUpdateEvent(double frequency)
+{
+  // limit the rate of updates, data arriving in the meantime is integrated by the next one
+  ros::WallDuration since_update = ros::WallTime::now() - last_event_update_;
+  if (since_update.toSec() < min_event_update_period_)
+    ros::WallDuration(min_event_update_period_ - since_update.toSec()).sleep();
+
+  bool requested;
+  {
+    boost::mutex::scoped_lock lock(update_request_mutex_);
+    if (!update_requested_)
+      update_request_cond_.timed_wait(lock, boost::posix_time::microseconds(static_cast<int64_t>(1e6 / frequency)));
+    requested = update_requested_;
+    update_requested_ = false;
+  }
+
+  if (map_update_thread_shutdown_)
+    return false;
+
+  // without new data the map only changes when the robot moves (e.g. a rolling window),
+  // or when observations expire, which the maximum period takes care of
+  tf::Stamped<tf::Pose> pose;
+  bool have_pose = getRobotPose(pose);
+  if (!requested && have_pose && (ros::WallTime::now() - last_event_update_).toSec() < max_event_update_period_)
+  {
+    double yaw_diff = tf::getYaw(pose.getRotation()) - tf::getYaw(last_event_update_pose_.getRotation());
+    if ((pose.getOrigin() - last_event_update_pose_.getOrigin()).length() < update_translation_threshold_
+        && fabs(atan2(sin(yaw_diff), cos(yaw_diff))) < update_rotation_threshold_)
+      return false;
+  }
+
+  if (have_pose)
+    last_event_update_pose_ = pose;
+  last_event_update_ = ros::WallTime::now();
+  return true;
+}
+
+void Costmap2DROS::getUpdateStatistics(std::vector<diagnostic_msgs::DiagnosticStatus>& statistics) const
+{
+  std::vector<ProfileStatistics> profile;
+  profiler_->getStatistics(profile);
+
+  statistics.clear();
+  for (unsigned int i = 0; i < profile.size(); ++i)
+  {
+    diagnostic_msgs::DiagnosticStatus status;
+    status.level = diagnostic_msgs::DiagnosticStatus::OK;
+    status.name = name_ + ": " + profile[i].name;
+    status.hardware_id = name_;
+
+    const char* keys[] = {"count", "mean", "p50", "p90", "p99", "max"};
+    double values[] = {double(profile[i].count), profile[i].mean, profile[i].p50, profile[i].p90, profile[i].p99,
+                       profile[i].max};
+    for (unsigned int j = 0; j < sizeof(values) / sizeof(values[0]); ++j)
+    {
+      diagnostic_msgs::KeyValue key_value;
+      key_value.key = keys[j];
+      std::ostringstream value;
+      value << values[j];
+      key_value.value = value.str();
+      status.values.push_back(key_value);
+    }
+    statistics.push_back(status);
+  }
+}
+
+void Costmap2DROS::publishUpdateStatistics(const ros::TimerEvent &event)
+{
+  if (statistics_pub_.getNumSubscribers() == 0)
+    return;
+
+  diagnostic_msgs::DiagnosticArray array;
+  array.header.stamp = ros::Time::now();
+  getUpdateStatistics(array.status);
+  statistics_pub_.publish(array);
+}
+
+bool Costmap2DROS::updateStatisticsService(costmap_2d::GetUpdateStatistics::Request &req,
+                                           costmap_2d::GetUpdateStatistics::Response &resp)
+{
+  getUpdateStatistics(resp.statistics);
+  if (req.reset)
+    profiler_->reset();
+  return true;
+}
+
 void Costmap2DROS::updateMap()
 {
   if (!stop_updates_)
@@ -451,6 +588,8 @@ void Costmap2DROS::start()
     stopped_ = false;
   }
   stop_updates_ = false;
+  if (update_on_events_)
+    requestUpdate();
 
   // block until the costmap is re-initialized.. meaning one update cycle has run
   ros::Rate r(100.0);
@@ -493,6 +632,7 @@ void Costmap2DROS::resetLayers()
 {
   Costmap2D* top = layered_costmap_->getCostmap();
   top->resetMap(0, 0, top->getSizeInCellsX(), top->getSizeInCellsY());
+  layered_costmap_->addChangedArea(0, top->getSizeInCellsX(), 0, top->getSizeInCellsY());
   std::vector < boost::shared_ptr<Layer> > *plugins = layered_costmap_->getPlugins();
   for (vector<boost::shared_ptr<Layer> >::iterator plugin = plugins->begin(); plugin != plugins->end();
       ++plugin)
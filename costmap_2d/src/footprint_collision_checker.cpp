@@ -0,0 +1,226 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/footprint_collision_checker.h>
+#include <costmap_2d/cost_values.h>
+#include <costmap_2d/footprint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace costmap_2d
+{
+
+namespace
+{
+
+// a point with u along the longer axis of the footprint and v across it
+struct AxisPoint
+{
+  double u;
+  double v;
+};
+
+// Sutherland-Hodgman clipping of a polygon against the half plane sign * (u - bound) >= 0
+std::vector<AxisPoint> clipPolygon(const std::vector<AxisPoint>& polygon, double bound, double sign)
+{
+  std::vector<AxisPoint> clipped;
+  for (unsigned int i = 0; i < polygon.size(); ++i)
+  {
+    const AxisPoint& current = polygon[i];
+    const AxisPoint& next = polygon[(i + 1) % polygon.size()];
+    double current_side = sign * (current.u - bound);
+    double next_side = sign * (next.u - bound);
+
+    if (current_side >= 0)
+      clipped.push_back(current);
+
+    if ((current_side >= 0) != (next_side >= 0))
+    {
+      AxisPoint intersection;
+      double t = current_side / (current_side - next_side);
+      intersection.u = bound;
+      intersection.v = current.v + t * (next.v - current.v);
+      clipped.push_back(intersection);
+    }
+  }
+  return clipped;
+}
+
+}  // namespace
+
+std::vector<FootprintCircle> computeCoveringCircles(const std::vector<geometry_msgs::Point>& footprint,
+                                                    unsigned int num_circles)
+{
+  std::vector<FootprintCircle> circles;
+  if (footprint.empty())
+    return circles;
+
+  double min_x = std::numeric_limits<double>::max(), max_x = -std::numeric_limits<double>::max();
+  double min_y = std::numeric_limits<double>::max(), max_y = -std::numeric_limits<double>::max();
+  for (unsigned int i = 0; i < footprint.size(); ++i)
+  {
+    min_x = std::min(min_x, footprint[i].x);
+    max_x = std::max(max_x, footprint[i].x);
+    min_y = std::min(min_y, footprint[i].y);
+    max_y = std::max(max_y, footprint[i].y);
+  }
+
+  // place the circles along the longer side of the bounding box
+  bool along_x = (max_x - min_x) >= (max_y - min_y);
+  std::vector<AxisPoint> polygon(footprint.size());
+  for (unsigned int i = 0; i < footprint.size(); ++i)
+  {
+    polygon[i].u = along_x ? footprint[i].x : footprint[i].y;
+    polygon[i].v = along_x ? footprint[i].y : footprint[i].x;
+  }
+  double min_u = along_x ? min_x : min_y, max_u = along_x ? max_x : max_y;
+  double width = along_x ? max_y - min_y : max_x - min_x;
+  double length = max_u - min_u;
+
+  if (num_circles == 0)
+    num_circles = width > 0.0 ? std::max(1, int(ceil(length / width))) : 1;
+
+  double step = length / num_circles;
+  for (unsigned int i = 0; i < num_circles; ++i)
+  {
+    double lower = min_u + i * step;
+    double upper = (i == num_circles - 1) ? max_u : lower + step;
+    std::vector<AxisPoint> slice = clipPolygon(clipPolygon(polygon, lower, 1.0), upper, -1.0);
+    if (slice.empty())
+      continue;
+
+    double min_v = std::numeric_limits<double>::max(), max_v = -std::numeric_limits<double>::max();
+    for (unsigned int j = 0; j < slice.size(); ++j)
+    {
+      min_v = std::min(min_v, slice[j].v);
+      max_v = std::max(max_v, slice[j].v);
+    }
+
+    // the point of the slice farthest from the center is one of its vertices
+    double center_u = (lower + upper) / 2, center_v = (min_v + max_v) / 2;
+    double radius = 0.0;
+    for (unsigned int j = 0; j < slice.size(); ++j)
+      radius = std::max(radius, hypot(slice[j].u - center_u, slice[j].v - center_v));
+
+    FootprintCircle circle;
+    circle.x = along_x ? center_u : center_v;
+    circle.y = along_x ? center_v : center_u;
+    circle.radius = radius;
+    circles.push_back(circle);
+  }
+  return circles;
+}
+
+FootprintCollisionChecker::FootprintCollisionChecker()
+{
+}
+
+void FootprintCollisionChecker::setFootprint(const std::vector<geometry_msgs::Point>& footprint,
+                                             unsigned int num_circles)
+{
+  footprint_ = footprint;
+  circles_ = computeCoveringCircles(footprint, num_circles);
+}
+
+bool FootprintCollisionChecker::isCollisionFree(Costmap2D& costmap, const ObstacleDistanceField* distance_field,
+                                                double x, double y, double theta) const
+{
+  if (distance_field == NULL || !distance_field->isValid() || circles_.empty() ||
+      distance_field->getSizeInCellsX() != costmap.getSizeInCellsX() ||
+      distance_field->getSizeInCellsY() != costmap.getSizeInCellsY())
+    return isPolygonCollisionFree(costmap, x, y, theta);
+
+  // The distance field holds distances between cell centers. A point anywhere in a cell can be half a cell
+  // diagonal closer to an obstacle, and the obstacle cell itself extends another half diagonal towards it.
+  // The inflation only approximates the nearest obstacle, which the extra cell of margin accounts for.
+  double resolution = costmap.getResolution();
+  double margin = resolution * (M_SQRT2 + 1.0);
+  double cos_th = cos(theta);
+  double sin_th = sin(theta);
+
+  for (unsigned int i = 0; i < circles_.size(); ++i)
+  {
+    const FootprintCircle& circle = circles_[i];
+    double wx = x + (circle.x * cos_th - circle.y * sin_th);
+    double wy = y + (circle.x * sin_th + circle.y * cos_th);
+
+    unsigned int mx, my, corner_x, corner_y;
+    if (!costmap.worldToMap(wx, wy, mx, my) ||
+        !costmap.worldToMap(wx - circle.radius, wy - circle.radius, corner_x, corner_y) ||
+        !costmap.worldToMap(wx + circle.radius, wy + circle.radius, corner_x, corner_y))
+      return isPolygonCollisionFree(costmap, x, y, theta);
+
+    // borderline case, the circle may or may not overlap the obstacle
+    if (distance_field->getDistance(mx, my) <= circle.radius + margin)
+      return isPolygonCollisionFree(costmap, x, y, theta);
+  }
+
+  return true;
+}
+
+bool FootprintCollisionChecker::isPolygonCollisionFree(Costmap2D& costmap, double x, double y, double theta) const
+{
+  unsigned int mx, my;
+  if (footprint_.size() < 3)
+  {
+    if (!costmap.worldToMap(x, y, mx, my))
+      return false;
+    return costmap.getCost(mx, my) != LETHAL_OBSTACLE;
+  }
+
+  std::vector<geometry_msgs::Point> oriented_footprint;
+  transformFootprint(x, y, theta, footprint_, oriented_footprint);
+
+  std::vector<MapLocation> map_polygon;
+  for (unsigned int i = 0; i < oriented_footprint.size(); ++i)
+  {
+    MapLocation loc;
+    if (!costmap.worldToMap(oriented_footprint[i].x, oriented_footprint[i].y, loc.x, loc.y))
+      return false;
+    map_polygon.push_back(loc);
+  }
+
+  std::vector<MapLocation> polygon_cells;
+  costmap.convexFillCells(map_polygon, polygon_cells);
+  for (unsigned int i = 0; i < polygon_cells.size(); ++i)
+  {
+    if (costmap.getCost(polygon_cells[i].x, polygon_cells[i].y) == LETHAL_OBSTACLE)
+      return false;
+  }
+  return true;
+}
+
+}  // namespace costmap_2d
@@ -48,7 +48,8 @@ namespace costmap_2d
 {
 
 LayeredCostmap::LayeredCostmap(std::string global_frame, bool rolling_window, bool track_unknown) :
-    costmap_(), global_frame_(global_frame), rolling_window_(rolling_window), initialized_(false), size_locked_(false)
+    costmap_(), global_frame_(global_frame), rolling_window_(rolling_window), cx0_(0), cxn_(0), cy0_(0), cyn_(0),
+    initialized_(false), size_locked_(false), profiler_(NULL), written_cells_(-1), lock_channel_(-1), update_channel_(-1), area_channel_(-1)
 {
   if (track_unknown)
     costmap_.setDefaultValue(255);
@@ -69,6 +70,7 @@ void LayeredCostmap::resizeMap(unsigned int size_x, unsigned int size_y, double
 {
   size_locked_ = size_locked;
   costmap_.resizeMap(size_x, size_y, resolution, origin_x, origin_y);
+  addChangedArea(0, size_x, 0, size_y);
   for (vector<boost::shared_ptr<Layer> >::iterator plugin = plugins_.begin(); plugin != plugins_.end();
       ++plugin)
   {
@@ -76,18 +78,52 @@ void LayeredCostmap::resizeMap(unsigned int size_x, unsigned int size_y, double
   }
 }
 
+void LayeredCostmap::setProfiler(UpdateProfiler* profiler)
+{
+  profiler_ = profiler;
+  bounds_channels_.clear();
+  costs_channels_.clear();
+  written_channels_.clear();
+  if (profiler_)
+  {
+    lock_channel_ = profiler_->getChannel("lock_wait_ms");
+    update_channel_ = profiler_->getChannel("update_map_ms");
+    area_channel_ = profiler_->getChannel("update_area");
+  }
+}
+
 void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
 {
+  ros::WallTime lock_start = ros::WallTime::now();
+
   // Lock for the remainder of this function, some plugins (e.g. VoxelLayer)
   // implement thread unsafe updateBounds() functions.
   boost::unique_lock<Costmap2D::mutex_t> lock(*(costmap_.getMutex()));
 
+  ros::WallTime update_start = ros::WallTime::now();
+  if (profiler_)
+  {
+    profiler_->record(lock_channel_, (update_start - lock_start).toSec() * 1e3);
+
+    // plugins can only be added, so the channels of the ones already profiled stay valid
+    for (unsigned int i = bounds_channels_.size(); i < plugins_.size(); ++i)
+    {
+      bounds_channels_.push_back(profiler_->getChannel(plugins_[i]->getName() + "/update_bounds_ms"));
+      costs_channels_.push_back(profiler_->getChannel(plugins_[i]->getName() + "/update_costs_ms"));
+      written_channels_.push_back(profiler_->getChannel(plugins_[i]->getName() + "/written_cells"));
+    }
+  }
+
   // if we're using a rolling buffer costmap... we need to update the origin using the robot's position
   if (rolling_window_)
   {
     double new_origin_x = robot_x - costmap_.getSizeInMetersX() / 2;
     double new_origin_y = robot_y - costmap_.getSizeInMetersY() / 2;
+    double origin_x = costmap_.getOriginX(), origin_y = costmap_.getOriginY();
     costmap_.updateOrigin(new_origin_x, new_origin_y);
+    // every cell moved
+    if (costmap_.getOriginX() != origin_x || costmap_.getOriginY() != origin_y)
+      addChangedArea(0, costmap_.getSizeInCellsX(), 0, costmap_.getSizeInCellsY());
   }
 
   if (plugins_.size() == 0)
@@ -103,7 +139,10 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
     double prev_miny = miny_;
     double prev_maxx = maxx_;
     double prev_maxy = maxy_;
+    ros::WallTime layer_start = ros::WallTime::now();
     (*plugin)->updateBounds(robot_x, robot_y, robot_yaw, &minx_, &miny_, &maxx_, &maxy_);
+    if (profiler_)
+      profiler_->record(bounds_channels_[plugin - plugins_.begin()], (ros::WallTime::now() - layer_start).toSec() * 1e3);
     if (minx_ > prev_minx || miny_ > prev_miny || maxx_ < prev_maxx || maxy_ < prev_maxy)
     {
       ROS_WARN_THROTTLE(1.0, "Illegal bounds change, was [tl: (%f, %f), br: (%f, %f)], but "
@@ -132,17 +171,60 @@ void LayeredCostmap::updateMap(double robot_x, double robot_y, double robot_yaw)
   for (vector<boost::shared_ptr<Layer> >::iterator plugin = plugins_.begin(); plugin != plugins_.end();
        ++plugin)
   {
+    ros::WallTime layer_start = ros::WallTime::now();
+    written_cells_ = -1;
     (*plugin)->updateCosts(costmap_, x0, y0, xn, yn);
+    if (profiler_)
+    {
+      profiler_->record(costs_channels_[plugin - plugins_.begin()], (ros::WallTime::now() - layer_start).toSec() * 1e3);
+      if (written_cells_ >= 0)
+        profiler_->record(written_channels_[plugin - plugins_.begin()], written_cells_);
+    }
+  }
+
+  if (profiler_)
+  {
+    // the size of the bounding box every layer is handed in updateCosts(), the layers tell how much of it they wrote
+    profiler_->record(area_channel_, double(xn - x0) * (yn - y0));
+    profiler_->record(update_channel_, (ros::WallTime::now() - update_start).toSec() * 1e3);
   }
 
   bx0_ = x0;
   bxn_ = xn;
   by0_ = y0;
   byn_ = yn;
+  addChangedArea(x0, xn, y0, yn);
 
   initialized_ = true;
 }
 
+void LayeredCostmap::takeChangedArea(unsigned int* x0, unsigned int* xn, unsigned int* y0, unsigned int* yn)
+{
+  *x0 = cx0_;
+  *xn = std::min(cxn_, costmap_.getSizeInCellsX());
+  *y0 = cy0_;
+  *yn = std::min(cyn_, costmap_.getSizeInCellsY());
+  cx0_ = cxn_ = cy0_ = cyn_ = 0;
+}
+
+void LayeredCostmap::addChangedArea(unsigned int x0, unsigned int xn, unsigned int y0, unsigned int yn)
+{
+  if (xn <= x0 || yn <= y0)
+    return;
+  if (cxn_ <= cx0_ || cyn_ <= cy0_)
+  {
+    cx0_ = x0;
+    cxn_ = xn;
+    cy0_ = y0;
+    cyn_ = yn;
+    return;
+  }
+  cx0_ = std::min(cx0_, x0);
+  cxn_ = std::max(cxn_, xn);
+  cy0_ = std::min(cy0_, y0);
+  cyn_ = std::max(cyn_, yn);
+}
+
 bool LayeredCostmap::isCurrent()
 {
   current_ = true;
@@ -0,0 +1,143 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *********************************************************************/
+#include <costmap_2d/update_profiler.h>
+
+#include <algorithm>
+
+namespace costmap_2d
+{
+
+UpdateProfiler::SampleRing::SampleRing(unsigned int size) :
+    size_(size), samples_(new boost::atomic<float>[size]), written_(0), reset_mark_(0)
+{
+}
+
+void UpdateProfiler::SampleRing::push(double value)
+{
+  unsigned long written = written_.load(boost::memory_order_relaxed);
+  samples_[written % size_].store(value, boost::memory_order_relaxed);
+  written_.store(written + 1, boost::memory_order_release);
+}
+
+void UpdateProfiler::SampleRing::snapshot(std::vector<float>& samples) const
+{
+  unsigned long written = written_.load(boost::memory_order_acquire);
+  unsigned long first = std::max(reset_mark_.load(boost::memory_order_relaxed), written > size_ ? written - size_ : 0);
+  samples.clear();
+  for (unsigned long i = first; i < written; ++i)
+    samples.push_back(samples_[i % size_].load(boost::memory_order_relaxed));
+}
+
+void UpdateProfiler::SampleRing::reset()
+{
+  reset_mark_.store(written_.load(boost::memory_order_acquire), boost::memory_order_relaxed);
+}
+
+UpdateProfiler::UpdateProfiler(unsigned int window_size) :
+    window_size_(std::max(1u, window_size)), num_channels_(0)
+{
+  std::fill(rings_, rings_ + MAX_CHANNELS, static_cast<SampleRing*>(NULL));
+}
+
+UpdateProfiler::~UpdateProfiler()
+{
+  for (unsigned int i = 0; i < MAX_CHANNELS; ++i)
+    delete rings_[i];
+}
+
+int UpdateProfiler::getChannel(const std::string& name)
+{
+  boost::mutex::scoped_lock lock(names_mutex_);
+  for (unsigned int i = 0; i < names_.size(); ++i)
+  {
+    if (names_[i] == name)
+      return i;
+  }
+
+  if (names_.size() >= MAX_CHANNELS)
+    return -1;
+
+  // the ring has to exist before readers can see the new channel count
+  unsigned int channel = names_.size();
+  rings_[channel] = new SampleRing(window_size_);
+  names_.push_back(name);
+  num_channels_.store(names_.size(), boost::memory_order_release);
+  return channel;
+}
+
+void UpdateProfiler::record(int channel, double value)
+{
+  if (channel >= 0 && channel < (int)num_channels_.load(boost::memory_order_acquire))
+    rings_[channel]->push(value);
+}
+
+void UpdateProfiler::getStatistics(std::vector<ProfileStatistics>& statistics) const
+{
+  statistics.clear();
+  boost::mutex::scoped_lock lock(names_mutex_);
+
+  std::vector<float> samples;
+  for (unsigned int i = 0; i < names_.size(); ++i)
+  {
+    rings_[i]->snapshot(samples);
+
+    ProfileStatistics stats;
+    stats.name = names_[i];
+    stats.count = samples.size();
+    stats.mean = stats.p50 = stats.p90 = stats.p99 = stats.max = 0.0;
+    if (!samples.empty())
+    {
+      std::sort(samples.begin(), samples.end());
+      double sum = 0.0;
+      for (unsigned int j = 0; j < samples.size(); ++j)
+        sum += samples[j];
+      stats.mean = sum / samples.size();
+      stats.p50 = samples[(samples.size() - 1) * 50 / 100];
+      stats.p90 = samples[(samples.size() - 1) * 90 / 100];
+      stats.p99 = samples[(samples.size() - 1) * 99 / 100];
+      stats.max = samples.back();
+    }
+    statistics.push_back(stats);
+  }
+}
+
+void UpdateProfiler::reset()
+{
+  boost::mutex::scoped_lock lock(names_mutex_);
+  for (unsigned int i = 0; i < names_.size(); ++i)
+    rings_[i]->reset();
+}
+
+}  // namespace costmap_2d
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * Replays the scans, clouds and transforms recorded in a bag file through a
+ * LayeredCostmap with obstacle (or voxel) and inflation layers, and reports
+ * how long each layer took per update cycle.
+ *
+ * No ROS master or TF server is needed: transforms are read from the /tf
+ * messages of the bag into a local tf::Transformer, and the sensor data is
+ * handed to the obstacle layer as static observations, bypassing the
+ * observation buffers, which leaves them without any use for a
+ * TransformListener. Layer parameters are left at their defaults when no
+ * master is running.
+ *
+ * usage: costmap_replay_benchmark bag [--global-frame odom] [--base-frame base_link]
+ *            [--update-frequency 5.0] [--size 6.0] [--resolution 0.05] [--voxel]
+ *            [topic ...]
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <costmap_2d/layered_costmap.h>
+#include <costmap_2d/obstacle_layer.h>
+#include <costmap_2d/voxel_layer.h>
+#include <costmap_2d/inflation_layer.h>
+#include <costmap_2d/footprint.h>
+#include <costmap_2d/update_profiler.h>
+#include <laser_geometry/laser_geometry.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include <pcl_ros/transforms.h>
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <sensor_msgs/LaserScan.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <tf/tf.h>
+#include <tf/tfMessage.h>
+
+using namespace costmap_2d;
+
+struct SensorReading
+{
+  std::string frame_id;
+  ros::Time stamp;
+  pcl::PointCloud<pcl::PointXYZ> cloud;
+};
+
+class ReplayBenchmark
+{
+public:
+  ReplayBenchmark(const std::string& global_frame, const std::string& base_frame, double update_period,
+                  bool voxel, double size, double resolution)
+    : global_frame_(global_frame), base_frame_(base_frame), update_period_(update_period),
+      transformer_(true, ros::Duration(30.0)), layers_(global_frame, true, false), profiler_(1000000),
+      cycles_(0), observations_(0), dropped_(0)
+  {
+    if (voxel)
+      obstacles_ = new VoxelLayer();
+    else
+      obstacles_ = new ObstacleLayer();
+    obstacles_->initialize(&layers_, voxel ? "voxels" : "obstacles", NULL);
+    layers_.addPlugin(boost::shared_ptr<Layer>(obstacles_));
+
+    InflationLayer* inflation = new InflationLayer();
+    inflation->initialize(&layers_, "inflation", NULL);
+    layers_.addPlugin(boost::shared_ptr<Layer>(inflation));
+
+    layers_.setFootprint(makeFootprintFromRadius(0.3));
+    unsigned int cells = std::max(1, int(size / resolution));
+    layers_.resizeMap(cells, cells, resolution, -size / 2, -size / 2);
+    layers_.setProfiler(&profiler_);
+  }
+
+  void addTransforms(const tf::tfMessage& message)
+  {
+    for (unsigned int i = 0; i < message.transforms.size(); ++i)
+    {
+      tf::StampedTransform transform;
+      tf::transformStampedMsgToTF(message.transforms[i], transform);
+      transformer_.setTransform(transform, "bag");
+    }
+    addPendingReadings();
+  }
+
+  void addScan(const sensor_msgs::LaserScan& scan)
+  {
+    sensor_msgs::PointCloud2 cloud;
+    projector_.projectLaser(scan, cloud);
+    addCloud(cloud);
+  }
+
+  void addCloud(const sensor_msgs::PointCloud2& cloud)
+  {
+    pending_.push_back(SensorReading());
+    pending_.back().frame_id = cloud.header.frame_id;
+    pending_.back().stamp = cloud.header.stamp;
+    pcl::fromROSMsg(cloud, pending_.back().cloud);
+    addPendingReadings();
+  }
+
+  /**
+   * @brief Run an update cycle whenever another update period of recorded time has passed
+   */
+  void spinOnce(const ros::Time& time)
+  {
+    if (!next_update_.isZero() && time < next_update_)
+      return;
+    next_update_ = time + ros::Duration(update_period_);
+
+    tf::StampedTransform pose;
+    try
+    {
+      transformer_.lookupTransform(global_frame_, base_frame_, ros::Time(0), pose);
+    }
+    catch (tf::TransformException& ex)
+    {
+      return;
+    }
+
+    layers_.updateMap(pose.getOrigin().x(), pose.getOrigin().y(), tf::getYaw(pose.getRotation()));
+    obstacles_->clearStaticObservations(true, true);
+    ++cycles_;
+  }
+
+  void report(double wall_time)
+  {
+    std::vector<ProfileStatistics> statistics;
+    profiler_.getStatistics(statistics);
+
+    printf("%u update cycles, %u observations, %u dropped, %.3f s wall time\n\n", cycles_, observations_, dropped_,
+           wall_time);
+    printf("%-32s %8s %10s %10s %10s %10s %10s\n", "channel", "count", "mean", "p50", "p90", "p99", "max");
+
+    std::map<std::string, double> totals;
+    for (unsigned int i = 0; i < statistics.size(); ++i)
+    {
+      const ProfileStatistics& s = statistics[i];
+      printf("%-32s %8u %10.4f %10.4f %10.4f %10.4f %10.4f\n", s.name.c_str(), s.count, s.mean, s.p50, s.p90, s.p99,
+             s.max);
+      totals[s.name] = s.mean * s.count;
+    }
+
+    // every layer is handed the whole updated area in updateCosts(), and some tell how many cells they wrote
+    printf("\n%-32s %14s %14s\n", "layer", "area cells/s", "written/s");
+    std::vector<boost::shared_ptr<Layer> >* plugins = layers_.getPlugins();
+    for (unsigned int i = 0; i < plugins->size(); ++i)
+    {
+      const std::string& name = (*plugins)[i]->getName();
+      double ms = totals[name + "/update_bounds_ms"] + totals[name + "/update_costs_ms"];
+      printf("%-32s %14.0f %14.0f\n", name.c_str(), ms > 0.0 ? totals["update_area"] / (ms / 1e3) : 0.0,
+             ms > 0.0 ? totals[name + "/written_cells"] / (ms / 1e3) : 0.0);
+    }
+  }
+
+private:
+  /**
+   * @brief Hand the readings whose transform is known to the obstacle layer
+   */
+  void addPendingReadings()
+  {
+    while (!pending_.empty())
+    {
+      SensorReading& reading = pending_.front();
+      tf::StampedTransform transform;
+      try
+      {
+        transformer_.lookupTransform(global_frame_, reading.frame_id, reading.stamp, transform);
+      }
+      catch (tf::ExtrapolationException& ex)
+      {
+        // keep waiting until the transforms are a second past the reading, they are recorded out of order
+        ros::Time latest;
+        transformer_.getLatestCommonTime(global_frame_, reading.frame_id, latest, NULL);
+        if (!latest.isZero() && latest - reading.stamp < ros::Duration(1.0))
+          return;
+        pending_.pop_front();
+        ++dropped_;
+        continue;
+      }
+      catch (tf::TransformException& ex)
+      {
+        pending_.pop_front();
+        ++dropped_;
+        continue;
+      }
+
+      geometry_msgs::Point origin;
+      origin.x = transform.getOrigin().x();
+      origin.y = transform.getOrigin().y();
+      origin.z = transform.getOrigin().z();
+
+      pcl::PointCloud<pcl::PointXYZ> global_cloud;
+      pcl_ros::transformPointCloud(reading.cloud, global_cloud, transform);
+
+      // same ranges as the defaults of an observation source
+      Observation observation(origin, global_cloud, 2.5, 3.0);
+      obstacles_->addStaticObservation(observation, true, true);
+      pending_.pop_front();
+      ++observations_;
+    }
+  }
+
+  std::string global_frame_, base_frame_;
+  double update_period_;
+  tf::Transformer transformer_;
+  laser_geometry::LaserProjection projector_;
+  LayeredCostmap layers_;
+  ObstacleLayer* obstacles_;
+  UpdateProfiler profiler_;
+  std::deque<SensorReading> pending_;
+  ros::Time next_update_;
+  unsigned int cycles_, observations_, dropped_;
+};
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "costmap_replay_benchmark", ros::init_options::AnonymousName | ros::init_options::NoRosout);
+
+  std::string bag_file, global_frame = "odom", base_frame = "base_link";
+  double update_frequency = 5.0, size = 6.0, resolution = 0.05;
+  bool voxel = false;
+  std::vector<std::string> topics;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--global-frame" && has_value)
+      global_frame = argv[++i];
+    else if (arg == "--base-frame" && has_value)
+      base_frame = argv[++i];
+    else if (arg == "--update-frequency" && has_value)
+      update_frequency = atof(argv[++i]);
+    else if (arg == "--size" && has_value)
+      size = atof(argv[++i]);
+    else if (arg == "--resolution" && has_value)
+      resolution = atof(argv[++i]);
+    else if (arg == "--voxel")
+      voxel = true;
+    else if (bag_file.empty())
+      bag_file = arg;
+    else
+      topics.push_back(arg);
+  }
+
+  if (bag_file.empty() || update_frequency <= 0.0 || resolution <= 0.0)
+  {
+    fprintf(stderr, "usage: %s bag [--global-frame odom] [--base-frame base_link] [--update-frequency 5.0] "
+            "[--size 6.0] [--resolution 0.05] [--voxel] [topic ...]\n", argv[0]);
+    return 1;
+  }
+
+  // don't wait forever on the master the layers try to advertise their topics with
+  if (!ros::master::check())
+    ros::master::setRetryTimeout(ros::WallDuration(0.01));
+
+  ReplayBenchmark benchmark(global_frame, base_frame, 1.0 / update_frequency, voxel, size, resolution);
+
+  rosbag::Bag bag;
+  try
+  {
+    bag.open(bag_file, rosbag::bagmode::Read);
+  }
+  catch (rosbag::BagException& ex)
+  {
+    fprintf(stderr, "Could not open %s: %s\n", bag_file.c_str(), ex.what());
+    return 1;
+  }
+
+  ros::WallTime start = ros::WallTime::now();
+  rosbag::View view(bag);
+  for (rosbag::View::iterator it = view.begin(); it != view.end(); ++it)
+  {
+    const rosbag::MessageInstance& message = *it;
+    bool sensor_topic = topics.empty()
+        || std::find(topics.begin(), topics.end(), message.getTopic()) != topics.end();
+
+    if (message.getTopic() == "/tf" || message.getTopic() == "tf")
+    {
+      tf::tfMessage::ConstPtr transforms = message.instantiate<tf::tfMessage>();
+      if (transforms)
+        benchmark.addTransforms(*transforms);
+    }
+    else if (sensor_topic && message.getDataType() == "sensor_msgs/LaserScan")
+    {
+      benchmark.addScan(*message.instantiate<sensor_msgs::LaserScan>());
+    }
+    else if (sensor_topic && message.getDataType() == "sensor_msgs/PointCloud2")
+    {
+      benchmark.addCloud(*message.instantiate<sensor_msgs::PointCloud2>());
+    }
+
+    benchmark.spinOnce(message.getTime());
+  }
+
+  benchmark.report((ros::WallTime::now() - start).toSec());
+  return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+
+#include "costmap_2d/cost_values.h"
+#include "costmap_2d/footprint_collision_checker.h"
+
+using namespace costmap_2d;
+
+std::vector<geometry_msgs::Point> makeRectangle(double length, double width)
+{
+  std::vector<geometry_msgs::Point> footprint(4);
+  footprint[0].x = length / 2; footprint[0].y = width / 2;
+  footprint[1].x = length / 2; footprint[1].y = -width / 2;
+  footprint[2].x = -length / 2; footprint[2].y = -width / 2;
+  footprint[3].x = -length / 2; footprint[3].y = width / 2;
+  return footprint;
+}
+
+// brute force distance between cell centers and the nearest lethal cell
+void computeDistanceField(const Costmap2D& costmap, double max_distance, ObstacleDistanceField& field)
+{
+  unsigned int size_x = costmap.getSizeInCellsX(), size_y = costmap.getSizeInCellsY();
+  field.resize(size_x, size_y, max_distance);
+  field.resetRegion(0, 0, size_x, size_y);
+  for (unsigned int ox = 0; ox < size_x; ++ox)
+    for (unsigned int oy = 0; oy < size_y; ++oy)
+      if (costmap.getCost(ox, oy) == LETHAL_OBSTACLE)
+        for (unsigned int x = 0; x < size_x; ++x)
+          for (unsigned int y = 0; y < size_y; ++y)
+            field.lowerDistance(y * size_x + x, hypot(double(x) - ox, double(y) - oy) * costmap.getResolution());
+}
+
+TEST(footprint_collision_checker, circles_cover_footprint)
+{
+  std::vector<geometry_msgs::Point> footprint = makeRectangle(2.0, 0.4);
+  std::vector<FootprintCircle> circles = computeCoveringCircles(footprint);
+  EXPECT_EQ(5, circles.size());
+
+  for (double x = -1.0; x <= 1.0; x += 0.01)
+  {
+    for (double y = -0.2; y <= 0.2; y += 0.01)
+    {
+      bool covered = false;
+      for (unsigned int i = 0; i < circles.size(); ++i)
+        covered |= hypot(x - circles[i].x, y - circles[i].y) <= circles[i].radius + 1e-9;
+      EXPECT_TRUE(covered) << x << ", " << y;
+    }
+  }
+
+  // the circles are much smaller than the circumscribed circle of the footprint
+  for (unsigned int i = 0; i < circles.size(); ++i)
+    EXPECT_LT(circles[i].radius, 0.3);
+
+  EXPECT_EQ(2, computeCoveringCircles(footprint, 2).size());
+}
+
+TEST(footprint_collision_checker, matches_polygon_check)
+{
+  Costmap2D costmap(60, 60, 0.05, 0.0, 0.0);
+  for (unsigned int i = 0; i < 40; ++i)
+    costmap.setCost(rand() % 60, rand() % 60, LETHAL_OBSTACLE);
+
+  ObstacleDistanceField field;
+  computeDistanceField(costmap, 1.0, field);
+
+  FootprintCollisionChecker checker;
+  checker.setFootprint(makeRectangle(0.8, 0.2));
+
+  unsigned int num_free = 0;
+  for (unsigned int i = 0; i < 500; ++i)
+  {
+    double x = 0.5 + 2.0 * rand() / RAND_MAX;
+    double y = 0.5 + 2.0 * rand() / RAND_MAX;
+    double theta = 2 * M_PI * rand() / RAND_MAX;
+    bool polygon_free = checker.isPolygonCollisionFree(costmap, x, y, theta);
+    EXPECT_EQ(polygon_free, checker.isCollisionFree(costmap, &field, x, y, theta));
+    num_free += polygon_free;
+  }
+  EXPECT_GT(num_free, 0);
+
+  // without a distance field only the polygon is checked
+  costmap.setCost(30, 30, LETHAL_OBSTACLE);
+  EXPECT_FALSE(checker.isCollisionFree(costmap, NULL, 1.525, 1.525, 0.0));
+
+  // footprints leaving the map are not free
+  EXPECT_FALSE(checker.isCollisionFree(costmap, &field, 0.1, 1.5, 0.0));
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
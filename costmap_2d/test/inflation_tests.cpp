@@ -31,9 +31,12 @@
  * @author David Lu!!
  * Test harness for InflationLayer for Costmap2D
  */
+#include <algorithm>
+#include <cmath>
 #include <map>
 
 #include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/costmap_layer.h>
 #include <costmap_2d/layered_costmap.h>
 #include <costmap_2d/obstacle_layer.h>
 #include <costmap_2d/inflation_layer.h>
@@ -402,6 +405,151 @@ TEST(costmap, testInflation3){
   ASSERT_EQ(countValues(*costmap, INSCRIBED_INFLATED_OBSTACLE), (unsigned int)4);
 }
 
+// a layer whose lethal cells are set directly, it only reports the cells it changed as updated
+class LethalCellsLayer : public CostmapLayer
+{
+public:
+  virtual void onInitialize()
+  {
+    current_ = true;
+    enabled_ = true;
+    matchSize();
+  }
+
+  void setLethal(unsigned int mx, unsigned int my, bool lethal)
+  {
+    setCost(mx, my, lethal ? LETHAL_OBSTACLE : FREE_SPACE);
+    double wx, wy;
+    mapToWorld(mx, my, wx, wy);
+    addExtraBounds(wx, wy, wx, wy);
+  }
+
+  virtual void updateBounds(double robot_x, double robot_y, double robot_yaw, double* min_x, double* min_y,
+                            double* max_x, double* max_y)
+  {
+    useExtraBounds(min_x, min_y, max_x, max_y);
+  }
+
+  virtual void updateCosts(Costmap2D& master_grid, int min_i, int min_j, int max_i, int max_j)
+  {
+    updateWithTrueOverwrite(master_grid, min_i, min_j, max_i, max_j);
+  }
+};
+
+// compare the incrementally updated distance field against the distances to every lethal cell
+void validateDistanceField(const Costmap2D& costmap, const ObstacleDistanceField* field)
+{
+  ASSERT_TRUE(field != NULL);
+  unsigned int size_x = costmap.getSizeInCellsX(), size_y = costmap.getSizeInCellsY();
+  ASSERT_EQ(size_x, field->getSizeInCellsX());
+  ASSERT_EQ(size_y, field->getSizeInCellsY());
+  double resolution = costmap.getResolution();
+  for (unsigned int y = 0; y < size_y; ++y)
+  {
+    for (unsigned int x = 0; x < size_x; ++x)
+    {
+      double expected = field->getMaxDistance();
+      for (unsigned int oy = 0; oy < size_y; ++oy)
+        for (unsigned int ox = 0; ox < size_x; ++ox)
+          if (costmap.getCost(ox, oy) == LETHAL_OBSTACLE)
+            expected = std::min(expected, hypot(double(x) - ox, double(y) - oy) * resolution);
+
+      // the wavefront may reach a cell from a neighbouring source first, but never from a removed one
+      EXPECT_GE(field->getDistance(x, y), expected - 1e-6) << x << ", " << y;
+      EXPECT_LE(field->getDistance(x, y), expected + resolution) << x << ", " << y;
+    }
+  }
+}
+
+TEST(costmap, testDistanceFieldMatchesBruteForce){
+  tf::TransformListener tf;
+  LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(40, 40, 0.1, 0, 0);
+  std::vector<Point> polygon = setRadii(layers, 0.1, 0.1, 0.5);
+  ros::NodeHandle nh;
+  nh.setParam("/inflation_tests/inflation/compute_distance_field", true);
+
+  LethalCellsLayer* lethal = new LethalCellsLayer();
+  layers.addPlugin(boost::shared_ptr<Layer>(lethal));
+  lethal->initialize(&layers, "lethal", &tf);
+  InflationLayer* ilayer = addInflationLayer(layers, tf);
+  layers.setFootprint(polygon);
+  nh.deleteParam("/inflation_tests/inflation/compute_distance_field");
+  Costmap2D* costmap = layers.getCostmap();
+
+  lethal->setLethal(10, 10, true);
+  lethal->setLethal(11, 10, true);
+  lethal->setLethal(30, 25, true);
+  layers.updateMap(0, 0, 0);
+  validateDistanceField(*costmap, ilayer->getDistanceField());
+
+  // an obstacle next to one already there only lowers the distances around it
+  lethal->setLethal(14, 12, true);
+  lethal->setLethal(20, 20, true);
+  layers.updateMap(0, 0, 0);
+  validateDistanceField(*costmap, ilayer->getDistanceField());
+
+  // removed obstacles raise the distances again, up to the ones left nearby
+  lethal->setLethal(10, 10, false);
+  lethal->setLethal(20, 20, false);
+  layers.updateMap(0, 0, 0);
+  validateDistanceField(*costmap, ilayer->getDistanceField());
+
+  lethal->setLethal(11, 10, false);
+  lethal->setLethal(14, 12, false);
+  lethal->setLethal(30, 25, false);
+  layers.updateMap(0, 0, 0);
+  ASSERT_EQ(countValues(*costmap, LETHAL_OBSTACLE), (unsigned int)0);
+  validateDistanceField(*costmap, ilayer->getDistanceField());
+}
+
+const ProfileStatistics* findChannel(const std::vector<ProfileStatistics>& statistics, const std::string& name)
+{
+  for (unsigned int i = 0; i < statistics.size(); ++i)
+    if (statistics[i].name == name)
+      return &statistics[i];
+  return NULL;
+}
+
+TEST(costmap, testWrittenCellsAreProfiled){
+  tf::TransformListener tf;
+  LayeredCostmap layers("frame", false, false);
+  layers.resizeMap(40, 40, 0.1, 0, 0);
+  std::vector<Point> polygon = setRadii(layers, 0.1, 0.1, 0.5);
+  UpdateProfiler profiler;
+  layers.setProfiler(&profiler);
+
+  LethalCellsLayer* lethal = new LethalCellsLayer();
+  layers.addPlugin(boost::shared_ptr<Layer>(lethal));
+  lethal->initialize(&layers, "lethal", &tf);
+  addInflationLayer(layers, tf);
+  layers.setFootprint(polygon);
+  Costmap2D* costmap = layers.getCostmap();
+
+  lethal->setLethal(10, 10, true);
+  layers.updateMap(0, 0, 0);
+
+  std::vector<ProfileStatistics> statistics;
+  profiler.getStatistics(statistics);
+  const ProfileStatistics* area = findChannel(statistics, "update_area");
+  const ProfileStatistics* lethal_cells = findChannel(statistics, "lethal/written_cells");
+  const ProfileStatistics* inflation_cells = findChannel(statistics, "inflation/written_cells");
+  ASSERT_TRUE(area != NULL && lethal_cells != NULL && inflation_cells != NULL);
+  ASSERT_EQ(area->count, 1u);
+
+  // the test layer does not count the cells it writes
+  ASSERT_EQ(lethal_cells->count, 0u);
+
+  // the inflation writes every cell it raised, and only the cells around the obstacle
+  unsigned int inflated = 0;
+  for (unsigned int y = 0; y < 40; ++y)
+    for (unsigned int x = 0; x < 40; ++x)
+      if (costmap->getCost(x, y) != FREE_SPACE)
+        inflated++;
+  ASSERT_EQ(inflation_cells->count, 1u);
+  ASSERT_GE(inflation_cells->mean, inflated);
+  ASSERT_LT(inflation_cells->mean, 40 * 40);
+}
 
 int main(int argc, char** argv){
   ros::init(argc, argv, "inflation_tests");
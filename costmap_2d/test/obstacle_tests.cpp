@@ -244,6 +244,49 @@ TEST(costmap, testMultipleAdditions){
 
 }
 
+/**
+ * Verify that the changed area covers all updates since it was last taken
+ */
+TEST(costmap, testChangedArea){
+  tf::TransformListener tf;
+  LayeredCostmap layers("frame", false, false);
+  addStaticLayer(layers, tf);
+  ObstacleLayer* olayer = addObstacleLayer(layers, tf);
+
+  // The static map changes the whole map
+  layers.updateMap(0,0,0);
+  unsigned int x0, xn, y0, yn;
+  layers.takeChangedArea(&x0, &xn, &y0, &yn);
+  ASSERT_EQ(x0, 0u);
+  ASSERT_EQ(xn, 10u);
+  ASSERT_EQ(y0, 0u);
+  ASSERT_EQ(yn, 10u);
+
+  // Nothing changed since
+  layers.takeChangedArea(&x0, &xn, &y0, &yn);
+  ASSERT_LE(xn, x0);
+
+  // Two updates before the area is taken again
+  addObservation(olayer, 5.0, 5.0, MAX_Z/2, 0, 0, MAX_Z/2);
+  layers.updateMap(0,0,0);
+  addObservation(olayer, 8.0, 2.0, MAX_Z/2, 0, 0, MAX_Z/2);
+  layers.updateMap(0,0,0);
+  layers.takeChangedArea(&x0, &xn, &y0, &yn);
+  ASSERT_LE(x0, 5u);
+  ASSERT_GT(xn, 8u);
+  ASSERT_LE(y0, 2u);
+  ASSERT_GT(yn, 5u);
+
+  // Changes made outside of the updates
+  layers.takeChangedArea(&x0, &xn, &y0, &yn);
+  layers.addChangedArea(2, 4, 3, 6);
+  layers.takeChangedArea(&x0, &xn, &y0, &yn);
+  ASSERT_EQ(x0, 2u);
+  ASSERT_EQ(xn, 4u);
+  ASSERT_EQ(y0, 3u);
+  ASSERT_EQ(yn, 6u);
+}
+
 
 int main(int argc, char** argv){
   ros::init(argc, argv, "obstacle_tests");
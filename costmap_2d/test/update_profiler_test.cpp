@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include "costmap_2d/update_profiler.h"
+
+using namespace costmap_2d;
+
+TEST(update_profiler, channels)
+{
+  UpdateProfiler profiler;
+  int a = profiler.getChannel("a");
+  int b = profiler.getChannel("b");
+  EXPECT_NE( a, b );
+  EXPECT_EQ( a, profiler.getChannel("a") );
+
+  std::vector<ProfileStatistics> statistics;
+  profiler.getStatistics( statistics );
+  ASSERT_EQ( 2, statistics.size() );
+  EXPECT_EQ( "a", statistics[0].name );
+  EXPECT_EQ( 0, statistics[0].count );
+}
+
+TEST(update_profiler, statistics)
+{
+  UpdateProfiler profiler( 100 );
+  int channel = profiler.getChannel("update_ms");
+  for (int i = 1; i <= 100; i++)
+    profiler.record( channel, i );
+
+  std::vector<ProfileStatistics> statistics;
+  profiler.getStatistics( statistics );
+  ASSERT_EQ( 1, statistics.size() );
+  EXPECT_EQ( 100, statistics[0].count );
+  EXPECT_DOUBLE_EQ( 50.5, statistics[0].mean );
+  EXPECT_NEAR( 50.0, statistics[0].p50, 1.0 );
+  EXPECT_NEAR( 90.0, statistics[0].p90, 1.0 );
+  EXPECT_NEAR( 99.0, statistics[0].p99, 1.0 );
+  EXPECT_DOUBLE_EQ( 100.0, statistics[0].max );
+}
+
+TEST(update_profiler, window_and_reset)
+{
+  UpdateProfiler profiler( 10 );
+  int channel = profiler.getChannel("update_ms");
+  for (int i = 0; i < 25; i++)
+    profiler.record( channel, i );
+
+  // only the 10 most recent samples are kept
+  std::vector<ProfileStatistics> statistics;
+  profiler.getStatistics( statistics );
+  EXPECT_EQ( 10, statistics[0].count );
+  EXPECT_DOUBLE_EQ( 19.5, statistics[0].mean );
+  EXPECT_DOUBLE_EQ( 24.0, statistics[0].max );
+
+  profiler.reset();
+  profiler.getStatistics( statistics );
+  EXPECT_EQ( 0, statistics[0].count );
+
+  profiler.record( channel, 3.0 );
+  profiler.getStatistics( statistics );
+  EXPECT_EQ( 1, statistics[0].count );
+  EXPECT_DOUBLE_EQ( 3.0, statistics[0].max );
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
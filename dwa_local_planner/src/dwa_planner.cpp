@@ -152,6 +152,10 @@ namespace dwa_local_planner {
     private_nh.param("sum_scores", sum_scores, false);
     obstacle_costs_.setSumScores(sum_scores);
 
+    int footprint_mask_headings;
+    private_nh.param("footprint_mask_headings", footprint_mask_headings, 0);
+    obstacle_costs_.setFootprintMaskHeadings(std::max(footprint_mask_headings, 0));
+
 
     private_nh.param("publish_cost_grid_pc", publish_cost_grid_pc_, false);
     map_viz_.initialize(name, planner_util->getGlobalFrame(), boost::bind(&DWAPlanner::getCellCosts, this, _1, _2, _3, _4, _5, _6));
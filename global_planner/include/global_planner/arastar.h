@@ -0,0 +1,125 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _ARASTAR_H
+#define _ARASTAR_H
+
+#include <global_planner/planner_core.h>
+#include <global_planner/expander.h>
+#include <global_planner/astar.h>
+#include <boost/function.hpp>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class ARAStarExpansion
+ * @brief Anytime Repairing A*, bounded by wall time instead of a number of cycles.
+ *
+ * The first search inflates the Manhattan heuristic of AStarExpansion by an epsilon, which
+ * finds a plan that costs at most epsilon times the optimal one after few expansions. Every
+ * following search lowers epsilon and only revisits the cells whose potential dropped since
+ * they were expanded, until epsilon reaches 1 or the time budget runs out. The first search is
+ * only bounded by the number of cycles, so that there is a plan whenever the goal can be reached.
+ *
+ * Potentials only ever decrease, so every reached cell keeps a neighbor with a lower one and
+ * the potential can be traced back from the goal at any point, also when the budget runs out
+ * in the middle of a search.
+ */
+class ARAStarExpansion : public Expander {
+    public:
+        /**
+         * @brief  Called with the potential after each search but the last, when it is ready to be traced
+         */
+        typedef boost::function<void(float* potential)> ImprovedCallback;
+
+        ARAStarExpansion(PotentialCalculator* p_calc, int nx, int ny);
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y, int cycles,
+                                float* potential);
+
+        /**
+         * @brief  Sets or resets the size of the map
+         * @param nx The x size of the map
+         * @param ny The y size of the map
+         */
+        void setSize(int nx, int ny);
+
+        /**
+         * @brief  Sets the heuristic inflation of the first search, and how much it is lowered for every next one
+         */
+        void setEpsilon(float initial, float step) {
+            initial_epsilon_ = initial;
+            epsilon_step_ = step;
+        }
+
+        /**
+         * @brief  Sets the wall time calculatePotentials may spend improving on the first plan in seconds, 0 for no limit
+         */
+        void setTimeBudget(double seconds) {
+            time_budget_ = seconds;
+        }
+
+        void setImprovedCallback(const ImprovedCallback& callback) {
+            callback_ = callback;
+        }
+
+        /**
+         * @brief  The epsilon of the last search that reached the goal, 0 if none did
+         */
+        float getEpsilon() const {
+            return epsilon_;
+        }
+
+    private:
+        void add(unsigned char* costs, float* potential, float prev_potential, int next_i, int end_x, int end_y);
+
+        inline float heuristic(int n, int end_x, int end_y) {
+            return (abs(end_x - n % nx_) + abs(end_y - n / nx_)) * neutral_cost_;
+        }
+
+        std::vector<Index> queue_;
+        std::vector<int> incons_; /**< cells lowered after they were expanded in the current search */
+        std::vector<unsigned int> closed_; /**< cells expanded in the current search are equal to epoch_ */
+        std::vector<unsigned int> listed_; /**< cells in incons_ are equal to epoch_ */
+        unsigned int epoch_;
+        float initial_epsilon_, epsilon_step_, epsilon_, search_epsilon_;
+        double time_budget_;
+        ImprovedCallback callback_;
+};
+
+} //end namespace global_planner
+#endif
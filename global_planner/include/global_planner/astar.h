@@ -40,6 +40,8 @@
 
 #include <global_planner/planner_core.h>
 #include <global_planner/expander.h>
+#include <global_planner/bucket_queue.h>
+#include <global_planner/landmark_heuristic.h>
 #include <vector>
 #include <algorithm>
 
@@ -65,9 +67,29 @@ class AStarExpansion : public Expander {
         AStarExpansion(PotentialCalculator* p_calc, int nx, int ny);
         bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y, int cycles,
                                 float* potential);
+
+        /**
+         * @brief  Use a BucketQueue as the open list instead of a binary heap
+         */
+        void setUseBucketQueue(bool use_buckets) {
+            use_buckets_ = use_buckets;
+        }
+
+        /**
+         * @brief  Raises the heuristic to the landmark bound where it is higher than the Manhattan distance,
+         *         which is inadmissible with the QuadraticCalculator just like the Manhattan distance
+         * @param landmarks The landmark tables, used as long as they are valid for the size of the map, or NULL
+         */
+        void setLandmarks(LandmarkHeuristic* landmarks) {
+            landmarks_ = landmarks;
+        }
     private:
         void add(unsigned char* costs, float* potential, float prev_potential, int next_i, int end_x, int end_y);
         std::vector<Index> queue_;
+        BucketQueue buckets_;
+        bool use_buckets_;
+        LandmarkHeuristic* landmarks_;
+        bool use_landmarks_; /**< whether landmarks_ is valid for the current search */
 };
 
 } //end namespace global_planner
@@ -0,0 +1,98 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _BIDIRECTIONAL_H
+#define _BIDIRECTIONAL_H
+
+#include <global_planner/planner_core.h>
+#include <global_planner/expander.h>
+#include <global_planner/astar.h>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class BidirectionalExpansion
+ * @brief Grows one frontier from the start and one from the end until they meet.
+ *
+ * Both frontiers are expanded like AStarExpansion, ordered by potential only
+ * (Dijkstra) or with the Manhattan heuristic towards the other end (A*), always
+ * advancing the one with the lower key. They stop once no path through their
+ * open cells can be cheaper than the best one through a cell reached from both
+ * sides, and the forward search continues with the backward potential as its
+ * heuristic.
+ * Within the area explored from the end, that heuristic is the exact remaining
+ * cost, so this last part only expands the cells along the path. The resulting
+ * potential is rooted at the start like the one of the other expanders, so the
+ * usual Traceback works on it.
+ */
+class BidirectionalExpansion : public Expander {
+    public:
+        BidirectionalExpansion(PotentialCalculator* p_calc, int nx, int ny);
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y, int cycles,
+                                float* potential);
+
+        /**
+         * @brief  Sets or resets the size of the map
+         * @param nx The x size of the map
+         * @param ny The y size of the map
+         */
+        void setSize(int nx, int ny);
+
+        /**
+         * @brief  Order both frontiers by potential plus the distance to the other end
+         */
+        void setUseHeuristic(bool use_heuristic) {
+            use_heuristic_ = use_heuristic;
+        }
+
+    private:
+        enum Direction {
+            FORWARD, BACKWARD, STITCH
+        };
+        void add(unsigned char* costs, float* potential, float prev_potential, int next_i, int end_x, int end_y,
+                 Direction direction);
+        void updateMeeting(unsigned char* costs, float* potential, int i, float& best);
+
+        std::vector<Index> forward_, backward_;
+        std::vector<float> back_potential_; /**< potential rooted at the end */
+        PotentialStamps back_stamps_; /**< which cells of back_potential_ belong to this search */
+        bool use_heuristic_;
+};
+
+} //end namespace global_planner
+#endif
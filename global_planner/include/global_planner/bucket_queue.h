@@ -0,0 +1,120 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _BUCKET_QUEUE_H
+#define _BUCKET_QUEUE_H
+
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class BucketQueue
+ * @brief Monotone priority queue of cell indices, bucketed by the integer part of their priority.
+ *
+ * The buckets form a ring that has to span the largest difference between a pushed
+ * priority and the smallest one in the queue, which for an expansion is the largest
+ * cost of a single step. Pushing a priority below the current bucket puts it in the
+ * current bucket, so the order is only exact up to the bucket width. Push and pop
+ * are O(1) amortized, and the buckets keep their memory between searches.
+ */
+class BucketQueue {
+    public:
+        BucketQueue() :
+                mask_(0), base_(0), current_(0), size_(0), started_(false) {
+        }
+
+        /**
+         * @brief  Empties the queue, making room for priorities up to span above the smallest one
+         */
+        void clear(float span) {
+            if (size_ > 0)
+                for (unsigned int i = 0; i < buckets_.size(); i++)
+                    buckets_[i].clear();
+
+            unsigned int num_buckets = 1;
+            while (num_buckets < span + 1)
+                num_buckets <<= 1;
+            if (num_buckets > buckets_.size())
+                buckets_.resize(num_buckets);
+            mask_ = buckets_.size() - 1;
+            base_ = 0;
+            current_ = 0;
+            size_ = 0;
+            started_ = false;
+        }
+
+        void push(int i, float priority) {
+            long key = (long) priority;
+            if (!started_) {
+                base_ = key;
+                started_ = true;
+            }
+            if (key < base_)
+                key = base_;
+            else if (key > base_ + (long) mask_)
+                key = base_ + mask_;
+            buckets_[(current_ + (key - base_)) & mask_].push_back(i);
+            size_++;
+        }
+
+        int pop() {
+            while (buckets_[current_].empty()) {
+                current_ = (current_ + 1) & mask_;
+                base_++;
+            }
+            int i = buckets_[current_].back();
+            buckets_[current_].pop_back();
+            size_--;
+            return i;
+        }
+
+        bool empty() const {
+            return size_ == 0;
+        }
+
+    private:
+        std::vector<std::vector<int> > buckets_;
+        unsigned int mask_;
+        long base_; /**< priority of the current bucket */
+        unsigned int current_;
+        unsigned int size_;
+        bool started_;
+};
+
+} //end namespace global_planner
+#endif
@@ -0,0 +1,112 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _COMPACT_DIJKSTRA_H
+#define _COMPACT_DIJKSTRA_H
+
+#include <vector>
+
+#include <global_planner/expander.h>
+#include <global_planner/compact_potential.h>
+
+namespace global_planner {
+
+/**
+ * @class CompactDijkstraExpansion
+ * @brief The priority block propagation of DijkstraExpansion on a CompactPotential.
+ *
+ * The potential takes 2 bytes per cell and the pending flags 1 byte, instead of 4 bytes each,
+ * which is what matters on very large maps. The quantum of the potential grows from 1/256 of
+ * the neutral cost up to a quarter of it, so the propagation reaches potentials of about
+ * 16000 times the neutral cost, i.e. paths of as many cells through free space. Cells are
+ * updated by the PotentialCalculator given to the constructor, like in DijkstraExpansion.
+ */
+class CompactDijkstraExpansion : public Expander {
+    public:
+        CompactDijkstraExpansion(PotentialCalculator* p_calc, int nx, int ny);
+
+        /**
+         * @brief  Propagates on the compact potential, and writes the result to a float array
+         */
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y, int cycles,
+                                float* potential);
+
+        /**
+         * @brief  Propagates on a compact potential, without any float array
+         */
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y, int cycles,
+                                CompactPotential& potential);
+
+        using Expander::clearEndpoint;
+        void clearEndpoint(unsigned char* costs, CompactPotential& potential, int gx, int gy, int s);
+
+        void setSize(int nx, int ny);
+
+        void setNeutralCost(unsigned char neutral_cost) {
+            neutral_cost_ = neutral_cost;
+            priorityIncrement_ = 2 * neutral_cost_;
+        }
+
+        void setPreciseStart(bool precise){ precise_ = precise; }
+
+    private:
+        float calculatePotential(const CompactPotential& potential, float cost, int n);
+        void updateCell(unsigned char* costs, CompactPotential& potential, int n);
+        void push(std::vector<int>& block, unsigned char* costs, int n);
+
+        float getCost(unsigned char* costs, int n) {
+            float c = costs[n];
+            if (c < lethal_cost_ - 1 || (unknown_ && c==255)) {
+                c = c * factor_ + neutral_cost_;
+                if (c >= lethal_cost_)
+                    c = lethal_cost_ - 1;
+                return c;
+            }
+            return lethal_cost_;
+        }
+
+        std::vector<int> current_, next_, over_; /**< priority blocks */
+        std::vector<unsigned char> pending_; /**< pending_ cells during propagation, those equal to pending_epoch_ */
+        unsigned char pending_epoch_;
+        bool precise_;
+        float threshold_, priorityIncrement_;
+        CompactPotential float_potential_; /**< used by the float version of calculatePotentials */
+        std::vector<float> stencil_; /**< neighbors of the updated cell, laid out with the row stride of the map */
+};
+
+} //end namespace global_planner
+#endif
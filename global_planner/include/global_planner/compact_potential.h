@@ -0,0 +1,155 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _COMPACT_POTENTIAL_H
+#define _COMPACT_POTENTIAL_H
+
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#include <global_planner/planner_core.h>
+
+namespace global_planner {
+
+/**
+ * @class CompactPotential
+ * @brief A potential field stored as one uint16_t per cell instead of a float.
+ *
+ * A cell holds its potential as a multiple of a quantum, which starts small and is doubled,
+ * halving every stored code, whenever a potential does not fit into the codes anymore. The
+ * quantum never grows beyond a maximum, and potentials that do not fit even then are not stored.
+ * A cell of the propagation is always at least about 0.7 times its cost above the neighbor it
+ * was computed from, so with a maximum quantum of a quarter of the smallest cost the stored
+ * field still descends strictly towards the start and can be traced on the grid.
+ */
+class CompactPotential {
+    public:
+        static const uint16_t UNREACHED = 0xffff;
+
+        CompactPotential() :
+                quantum_(1.0), inverse_quantum_(1.0), max_quantum_(1.0), saturated_(false), first_set_(0), last_set_(-1) {
+        }
+
+        /**
+         * @brief  Marks every cell unreached, only refilling the cells between the first and last one set since the
+         * last reset if the size did not change
+         * @param ns The number of cells
+         * @param quantum The initial potential step between two codes
+         * @param max_quantum The largest the quantum may grow to
+         */
+        void reset(int ns, float quantum, float max_quantum);
+
+        /**
+         * @brief  The potential of cell n, POT_HIGH if it is unreached
+         */
+        float operator[](int n) const {
+            return toPotential(codes_[n]);
+        }
+
+        /**
+         * @brief  The code of cell n, UNREACHED is larger than all others so they can be compared before converting
+         */
+        uint16_t getCode(int n) const {
+            return codes_[n];
+        }
+
+        float toPotential(uint16_t code) const {
+            return code == UNREACHED ? POT_HIGH : code * quantum_;
+        }
+
+        /**
+         * @brief  Stores the potential of cell n, rounded to the quantum
+         * @return False if the potential is too large even for the maximum quantum
+         */
+        bool set(int n, float potential) {
+            float code = potential * inverse_quantum_ + 0.5;
+            if (code >= UNREACHED) {
+                if (!fit(potential))
+                    return false;
+                code = potential * inverse_quantum_ + 0.5;
+            }
+            codes_[n] = (uint16_t) code;
+            first_set_ = std::min(first_set_, n);
+            last_set_ = std::max(last_set_, n);
+            return true;
+        }
+
+        /**
+         * @brief  Writes the potential of every cell to a float array
+         */
+        void decode(float* potential) const;
+
+        float getQuantum() const {
+            return quantum_;
+        }
+
+        /**
+         * @brief  The largest potential that can be stored with the maximum quantum
+         */
+        float getMaxPotential() const {
+            return (UNREACHED - 1) * max_quantum_;
+        }
+
+        /**
+         * @brief  Whether a potential was dropped since the last reset because it was too large
+         */
+        bool isSaturated() const {
+            return saturated_;
+        }
+
+        /**
+         * @brief  The memory taken by the codes, in bytes
+         */
+        size_t getMemoryUsage() const {
+            return codes_.capacity() * sizeof(uint16_t);
+        }
+
+    private:
+        /**
+         * @brief  Grows the quantum until the potential fits, marks the potential saturated if it cannot
+         */
+        bool fit(float potential);
+
+        std::vector<uint16_t> codes_;
+        float quantum_, inverse_quantum_, max_quantum_;
+        bool saturated_;
+        int first_set_, last_set_;
+};
+
+} //end namespace global_planner
+#endif
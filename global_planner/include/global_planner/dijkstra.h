@@ -43,14 +43,15 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
+#include <vector>
 
 #include <global_planner/planner_core.h>
 #include <global_planner/expander.h>
 
 // inserting onto the priority blocks
-#define push_cur(n)  { if (n>=0 && n<ns_ && !pending_[n] && getCost(costs, n)<lethal_cost_ && currentEnd_<PRIORITYBUFSIZE){ currentBuffer_[currentEnd_++]=n; pending_[n]=true; }}
-#define push_next(n) { if (n>=0 && n<ns_ && !pending_[n] && getCost(costs, n)<lethal_cost_ &&    nextEnd_<PRIORITYBUFSIZE){    nextBuffer_[   nextEnd_++]=n; pending_[n]=true; }}
-#define push_over(n) { if (n>=0 && n<ns_ && !pending_[n] && getCost(costs, n)<lethal_cost_ &&    overEnd_<PRIORITYBUFSIZE){    overBuffer_[   overEnd_++]=n; pending_[n]=true; }}
+#define push_cur(n)  { if (n>=0 && n<ns_ && pending_[n]!=pending_epoch_ && getCost(costs, n)<lethal_cost_ && currentEnd_<PRIORITYBUFSIZE){ currentBuffer_[currentEnd_++]=n; pending_[n]=pending_epoch_; }}
+#define push_next(n) { if (n>=0 && n<ns_ && pending_[n]!=pending_epoch_ && getCost(costs, n)<lethal_cost_ &&    nextEnd_<PRIORITYBUFSIZE){    nextBuffer_[   nextEnd_++]=n; pending_[n]=pending_epoch_; }}
+#define push_over(n) { if (n>=0 && n<ns_ && pending_[n]!=pending_epoch_ && getCost(costs, n)<lethal_cost_ &&    overEnd_<PRIORITYBUFSIZE){    overBuffer_[   overEnd_++]=n; pending_[n]=pending_epoch_; }}
 
 namespace global_planner {
 class DijkstraExpansion : public Expander {
@@ -73,8 +74,16 @@ class DijkstraExpansion : public Expander {
         }
 
         void setPreciseStart(bool precise){ precise_ = precise; }
+
+        /**
+         * @brief  Sets cells that have to be reached, besides the end point, before the expansion stops
+         * @param targets The indexes of the cells, cleared with an empty vector
+         */
+        void setTargets(const std::vector<int>& targets){ targets_ = targets; }
     private:
 
+        bool reachedTargets(float* potential);
+
         /**
          * @brief  Updates the cell at index n
          * @param costs The costmap
@@ -98,8 +107,10 @@ class DijkstraExpansion : public Expander {
         int *buffer1_, *buffer2_, *buffer3_; /**< storage buffers for priority blocks */
         int *currentBuffer_, *nextBuffer_, *overBuffer_; /**< priority buffer block ptrs */
         int currentEnd_, nextEnd_, overEnd_; /**< end points of arrays */
-        bool *pending_; /**< pending_ cells during propagation */
+        unsigned char *pending_; /**< pending_ cells during propagation, those equal to pending_epoch_ */
+        unsigned char pending_epoch_; /**< incremented for every propagation instead of clearing pending_ */
         bool precise_;
+        std::vector<int> targets_;
 
         /** block priority thresholds */
         float threshold_; /**< current threshold */
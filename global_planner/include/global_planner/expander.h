@@ -39,15 +39,18 @@
 #define _EXPANDER_H
 #include <global_planner/potential_calculator.h>
 #include <global_planner/planner_core.h>
+#include <global_planner/potential_stamps.h>
 
 namespace global_planner {
 
 class Expander {
     public:
         Expander(PotentialCalculator* p_calc, int nx, int ny) :
-                unknown_(true), lethal_cost_(253), neutral_cost_(50), factor_(3.0), p_calc_(p_calc) {
+                unknown_(true), lethal_cost_(253), neutral_cost_(50), cells_visited_(0), factor_(3.0), p_calc_(p_calc) {
             setSize(nx, ny);
         }
+        virtual ~Expander() {
+        }
         virtual bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y,
                                         int cycles, float* potential) = 0;
 
@@ -60,6 +63,7 @@ class Expander {
             nx_ = nx;
             ny_ = ny;
             ns_ = nx * ny;
+            stamps_.setSize(nx, ny);
         } /**< sets or resets the size of the map */
         void setLethalCost(unsigned char lethal_cost) {
             lethal_cost_ = lethal_cost;
@@ -74,16 +78,41 @@ class Expander {
             unknown_ = unknown;
         }
 
-        void clearEndpoint(unsigned char* costs, float* potential, int gx, int gy, int s){
+        /**
+         * @brief  The number of cells expanded by the last call to calculatePotentials
+         */
+        int getCellsVisited() const {
+            return cells_visited_;
+        }
+
+        /**
+         * @brief  Makes every cell of the potential read as POT_HIGH, in O(1)
+         */
+        void resetPotential() {
+            stamps_.reset();
+        }
+
+        /**
+         * @brief  The potential of cell n after the last call to calculatePotentials, POT_HIGH if it was not reached
+         */
+        virtual float getPotential(const float* potential, int n) const {
+            return stamps_.get(potential, n);
+        }
+
+        virtual void clearEndpoint(unsigned char* costs, float* potential, int gx, int gy, int s){
             int startCell = toIndex(gx, gy);
             for(int i=-s;i<=s;i++){
             for(int j=-s;j<=s;j++){
+                // the border cells are lethal, and their neighbors would be off the map
+                if(gx+i<1 || gx+i>nx_-2 || gy+j<1 || gy+j>ny_-2)
+                    continue;
                 int n = startCell+i+nx_*j;
-                if(potential[n]<POT_HIGH)
+                if(stamps_.get(potential, n)<POT_HIGH)
                     continue;
                 float c = costs[n]+neutral_cost_;
-                float pot = p_calc_->calculatePotential(potential, c, n);
-                potential[n] = pot;
+                // the end point need not have been reached, so its neighbors may be left from an earlier search
+                stamps_.claim(potential, n);
+                setPotential(potential, n, p_calc_->calculatePotential(potential, c, n));
             }
             }
         }
@@ -93,13 +122,17 @@ class Expander {
             return x + nx_ * y;
         }
 
+        inline void setPotential(float* potential, int n, float value) {
+            stamps_.set(potential, n, value);
+        }
+
         int nx_, ny_, ns_; /**< size of grid, in pixels */
         bool unknown_;
         unsigned char lethal_cost_, neutral_cost_;
         int cells_visited_;
         float factor_;
         PotentialCalculator* p_calc_;
-
+        PotentialStamps stamps_; /**< which cells of the potential were written since resetPotential */
 };
 
 } //end namespace global_planner
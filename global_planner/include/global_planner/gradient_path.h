@@ -46,9 +46,6 @@ namespace global_planner {
 class GradientPath : public Traceback {
     public:
         GradientPath(PotentialCalculator* p_calc);
-        ~GradientPath();
-
-        void setSize(int xs, int ys);
 
         //
         // Path construction
@@ -68,7 +65,18 @@ class GradientPath : public Traceback {
         }
         float gradCell(float* potential, int n);
 
-        float *gradx_, *grady_; /**< gradient arrays, size of potential array */
+        /**
+         * @brief  The slot of cell n in the gradient window, cells closer than GRADIENT_WINDOW on both axes never share one
+         */
+        inline int getGradientSlot(int n) {
+            return (n % xs_ & (GRADIENT_WINDOW - 1)) + (n / xs_ & (GRADIENT_WINDOW - 1)) * GRADIENT_WINDOW;
+        }
+
+        // the gradients are only needed around the current point of the path, so they are cached in a
+        // small window that slides along with it instead of arrays the size of the map
+        static const int GRADIENT_WINDOW = 16; /**< side of the window, a power of two */
+        int grad_cell_[GRADIENT_WINDOW * GRADIENT_WINDOW]; /**< the cell each slot holds the gradient of, -1 if none */
+        float gradx_[GRADIENT_WINDOW * GRADIENT_WINDOW], grady_[GRADIENT_WINDOW * GRADIENT_WINDOW];
 
         float pathStep_; /**< step size for following gradient */
 };
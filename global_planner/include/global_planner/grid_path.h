@@ -42,10 +42,20 @@
 
 namespace global_planner {
 
+class CompactPotential;
+
 class GridPath : public Traceback {
     public:
         GridPath(PotentialCalculator* p_calc): Traceback(p_calc){}
         bool getPath(float* potential, double start_x, double start_y, double end_x, double end_y, std::vector<std::pair<float, float> >& path);
+
+        /**
+         * @brief  Traces the path on a compact potential, like on a float one
+         */
+        bool getPath(const CompactPotential& potential, double start_x, double start_y, double end_x, double end_y, std::vector<std::pair<float, float> >& path);
+    private:
+        template<typename Potential>
+        bool descend(const Potential& potential, double start_x, double start_y, double end_x, double end_y, std::vector<std::pair<float, float> >& path);
 };
 
 } //end namespace global_planner
@@ -0,0 +1,68 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _HIERARCHICAL_PLANNER_H
+#define _HIERARCHICAL_PLANNER_H
+
+#include <global_planner/planner_core.h>
+
+namespace global_planner {
+
+/**
+ * @class HierarchicalPlanner
+ * @brief A GlobalPlanner that first plans on a graph of map clusters, and only expands
+ * the cells of the clusters along that coarse plan (see HPAStarExpansion).
+ *
+ * Takes the same parameters as GlobalPlanner, the chosen expander is used within the
+ * corridor. In addition, ~cluster_size sets the width of a cluster in cells and
+ * ~corridor_margin the number of clusters the corridor is widened by.
+ */
+class HierarchicalPlanner : public GlobalPlanner {
+    public:
+        HierarchicalPlanner();
+
+        /**
+         * @brief  Constructor for the HierarchicalPlanner object
+         * @param  name The name of this planner
+         * @param  costmap A pointer to the costmap to use
+         * @param  frame_id Frame of the costmap
+         */
+        HierarchicalPlanner(std::string name, costmap_2d::Costmap2D* costmap, std::string frame_id);
+};
+
+} //end namespace global_planner
+#endif
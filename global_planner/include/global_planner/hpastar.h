@@ -0,0 +1,166 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _HPASTAR_H
+#define _HPASTAR_H
+
+#include <global_planner/planner_core.h>
+#include <global_planner/expander.h>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class HPAStarExpansion
+ * @brief Hierarchical path-finding A* (HPA*) on top of another expander.
+ *
+ * The map is partitioned into square clusters. Wherever two neighboring clusters
+ * share a run of free cells along their border, a pair of entrance cells is placed
+ * on it, and the costs between the entrances of every cluster are precomputed with
+ * a search that stays inside the cluster. A plan is first found on this abstract
+ * graph, and the wrapped expander then computes the potential only within the
+ * clusters the abstract path passes through, widened by a margin of clusters. Cells
+ * outside of this corridor keep a potential of POT_HIGH, so any Traceback can
+ * extract the path. When the wrapped expander fails within the corridor, it is run
+ * again on the whole map.
+ *
+ * The costmap is taken to be the one of the previous call, except for the areas
+ * passed to markChanged since. Only the clusters in them and their neighbors are
+ * rebuilt.
+ */
+class HPAStarExpansion : public Expander {
+    public:
+        /**
+         * @param refiner The expander used within the corridor, owned by this expansion
+         * @param cluster_size The width of a cluster, in cells
+         * @param corridor_margin The number of clusters the corridor is widened by on each side
+         */
+        HPAStarExpansion(PotentialCalculator* p_calc, Expander* refiner, int nx, int ny, int cluster_size,
+                         int corridor_margin);
+        ~HPAStarExpansion();
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y, int cycles,
+                                float* potential);
+
+        /**
+         * @brief  Sets or resets the size of the map, which rebuilds all clusters
+         * @param nx The x size of the map
+         * @param ny The y size of the map
+         */
+        void setSize(int nx, int ny);
+
+        /**
+         * @brief  The potential is written by the refiner, so are the stamps telling which cells it reached
+         */
+        float getPotential(const float* potential, int n) const {
+            return refiner_->getPotential(potential, n);
+        }
+
+        void clearEndpoint(unsigned char* costs, float* potential, int gx, int gy, int s) {
+            refiner_->clearEndpoint(costs, potential, gx, gy, s);
+        }
+
+        /**
+         * @brief  Forget the abstract graph, the next call rebuilds all clusters
+         */
+        void reset() { needs_rebuild_ = true; }
+
+        /**
+         * @brief  Rebuild the clusters of an area of the costmap on the next call
+         * @param x0 The first column of the area
+         * @param y0 The first row of the area
+         * @param xn The column after the area
+         * @param yn The row after the area
+         */
+        void markChanged(int x0, int y0, int xn, int yn);
+
+    private:
+        struct Cluster {
+            int x0, y0, x1, y1; /**< cell bounds, x1 and y1 are exclusive */
+            std::vector<int> nodes; /**< entrance cells */
+            std::vector<float> dist; /**< dist[i * nodes.size() + j] is the cost from node i to node j */
+        };
+
+        float getCost(unsigned char* costs, int n) {
+            float c = costs[n];
+            if (c < lethal_cost_ - 1 || (unknown_ && c==255)) {
+                c = c * factor_ + neutral_cost_;
+                if (c >= lethal_cost_)
+                    c = lethal_cost_ - 1;
+                return c;
+            }
+            return lethal_cost_;
+        }
+
+        inline int clusterOf(int n) {
+            return (n % nx_) / cluster_size_ + (n / nx_) / cluster_size_ * cnx_;
+        }
+
+        void updateClusters(unsigned char* costs);
+        void findEntrances(unsigned char* costs, int a, int b, std::vector<std::pair<int, int> >& entrances);
+        void buildNodes(unsigned char* costs, int c);
+        void buildEdges(unsigned char* costs, int c);
+        void searchCluster(unsigned char* costs, int c, int source);
+        float localDistance(int c, int n) {
+            const Cluster& cl = clusters_[c];
+            return local_dist_[(n % nx_ - cl.x0) + (n / nx_ - cl.y0) * (cl.x1 - cl.x0)];
+        }
+        bool searchAbstract(unsigned char* costs, int start_i, int goal_i, std::vector<int>& path_clusters);
+        void setCorridor(unsigned char* costs, const std::vector<int>& path_clusters);
+
+        Expander* refiner_;
+        int cluster_size_, corridor_margin_;
+        int cnx_, cny_; /**< number of clusters in x and y */
+        std::vector<Cluster> clusters_;
+
+        std::vector<char> changed_; /**< the clusters marked since the last call */
+        std::vector<unsigned char> corridor_costs_; /**< the costmap within the corridor, lethal elsewhere */
+        std::vector<int> corridor_; /**< clusters copied into corridor_costs_ */
+
+        // scratch space of the searches
+        std::vector<float> local_dist_;
+        std::vector<int> offsets_;
+        std::vector<float> g_;
+        std::vector<int> parent_;
+
+        bool needs_rebuild_;
+        unsigned char last_lethal_cost_, last_neutral_cost_;
+        float last_factor_;
+        bool last_unknown_;
+};
+
+} //end namespace global_planner
+#endif
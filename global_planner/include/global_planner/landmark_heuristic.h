@@ -0,0 +1,123 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _LANDMARK_HEURISTIC_H
+#define _LANDMARK_HEURISTIC_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class LandmarkHeuristic
+ * @brief Landmark (ALT) lower bounds on the distance between two cells of a static map.
+ *
+ * The distance from each of a few landmark cells to every cell is computed with a
+ * breadth first search around the lethal cells of the map, and by the triangle inequality
+ * |d(L, goal) - d(L, n)| is a lower bound on the number of 4-connected steps from n to the
+ * goal which, unlike the Manhattan distance, accounts for the walls in between. A* scales the
+ * larger of the two by the neutral cost. The landmarks are picked one by one as the cell
+ * farthest from those picked so far.
+ *
+ * The bound counts 4-connected steps. Without use_quadratic every step costs at least the
+ * neutral cost, and the heuristic is admissible. The QuadraticCalculator lets a diagonal move
+ * cost as little as the neutral cost times sqrt(2), which is two steps, so the heuristic can
+ * overestimate by up to sqrt(2), just like the Manhattan distance, and the plans of A* are not
+ * guaranteed to be the cheapest.
+ *
+ * The distances are stored as uint16_t, scaled down on maps where they do not fit, so the
+ * tables take 2 bytes per landmark and cell. The map should only hold costs that do not
+ * change from plan to plan, i.e. the static layer: cells that are lethal in it but free
+ * while planning make the bound too high, unknown cells are treated as free.
+ */
+class LandmarkHeuristic {
+    public:
+        LandmarkHeuristic(unsigned int num_landmarks);
+
+        /**
+         * @brief  Recomputes the landmarks and their distances if the lethal cells of the map have changed
+         * @param costs The static costmap
+         * @param nx The x size of the map
+         * @param ny The y size of the map
+         * @return True if the tables were recomputed
+         */
+        bool update(const unsigned char* costs, int nx, int ny);
+
+        /**
+         * @brief  Whether the tables have been computed for a map of this size
+         */
+        bool isValid(int nx, int ny) const {
+            return !landmarks_.empty() && nx == nx_ && ny == ny_;
+        }
+
+        /**
+         * @brief  Sets the goal the distances of getDistance are bounded to
+         */
+        void setGoal(int goal);
+
+        /**
+         * @brief  A lower bound, in cells, on the length of a 4-connected path from cell n to the goal
+         */
+        float getDistance(int n) const;
+
+        /**
+         * @brief  The largest change of getDistance between neighboring cells
+         */
+        int getMaxStep() const;
+
+        const std::vector<int>& getLandmarks() const {
+            return landmarks_;
+        }
+
+    private:
+        static const uint16_t UNREACHED = 0xffff;
+
+        void computeDistances(int landmark, std::vector<int>& distance);
+
+        unsigned int num_landmarks_;
+        int nx_, ny_;
+        std::vector<unsigned char> blocked_; /**< lethal cells of the map the tables were computed for */
+        std::vector<int> landmarks_;
+        std::vector<std::vector<uint16_t> > tables_;
+        std::vector<int> scales_; /**< a table entry q stands for a distance in [q * scale, (q + 1) * scale) */
+        std::vector<uint16_t> goal_entries_;
+        std::vector<int> queue_;
+};
+
+} //end namespace global_planner
+#endif
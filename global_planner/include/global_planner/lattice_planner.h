@@ -0,0 +1,135 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _LATTICE_PLANNER_H
+#define _LATTICE_PLANNER_H
+
+#include <ros/ros.h>
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/costmap_2d_ros.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <geometry_msgs/Point.h>
+#include <nav_core/base_global_planner.h>
+#include <nav_core/tolerant_global_planner.h>
+#include <global_planner/motion_primitives.h>
+#include <global_planner/lattice_search.h>
+#include <boost/thread/mutex.hpp>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class LatticePlanner
+ * @brief A global planner for robots that cannot turn in place, which searches a state lattice
+ * of (x, y, heading) with the motion primitives of MotionPrimitives (see LatticeSearch).
+ *
+ * The plans respect ~min_turning_radius and keep the footprint of the robot off lethal cells
+ * at every pose, and each pose carries the heading of the robot along the motion.
+ */
+class LatticePlanner : public nav_core::BaseGlobalPlanner, public nav_core::TolerantGlobalPlanner {
+    public:
+        LatticePlanner();
+
+        /**
+         * @brief  Constructor for the LatticePlanner object
+         * @param  name The name of this planner
+         * @param  costmap A pointer to the costmap to use
+         * @param  frame_id Frame of the costmap
+         * @param  footprint The footprint of the robot
+         */
+        LatticePlanner(std::string name, costmap_2d::Costmap2D* costmap, std::string frame_id,
+                       const std::vector<geometry_msgs::Point>& footprint);
+
+        ~LatticePlanner();
+
+        /**
+         * @brief  Initialization function for the LatticePlanner object
+         * @param  name The name of this planner
+         * @param  costmap_ros A pointer to the ROS wrapper of the costmap to use for planning
+         */
+        void initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros);
+
+        void initialize(std::string name, costmap_2d::Costmap2D* costmap, std::string frame_id,
+                        const std::vector<geometry_msgs::Point>& footprint);
+
+        /**
+         * @brief Given a goal pose in the world, compute a plan
+         * @param start The start pose
+         * @param goal The goal pose
+         * @param plan The plan... filled by the planner
+         * @return True if a valid plan was found, false otherwise
+         */
+        bool makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                      std::vector<geometry_msgs::PoseStamped>& plan);
+
+        /**
+         * @brief Given a goal pose in the world, compute a plan
+         * @param start The start pose
+         * @param goal The goal pose
+         * @param tolerance The distance from the goal the plan may end at
+         * @param plan The plan... filled by the planner
+         * @return True if a valid plan was found, false otherwise
+         */
+        bool makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal, double tolerance,
+                      std::vector<geometry_msgs::PoseStamped>& plan);
+
+        /**
+         * @brief  Publish a path for visualization purposes
+         */
+        void publishPlan(const std::vector<geometry_msgs::PoseStamped>& path);
+
+    private:
+        /**
+         * @brief  Generates the primitives and the heuristic table for the resolution of the costmap
+         */
+        void generatePrimitives();
+
+        costmap_2d::Costmap2D* costmap_;
+        std::string frame_id_, tf_prefix_;
+        ros::Publisher plan_pub_;
+        bool initialized_;
+
+        std::vector<geometry_msgs::Point> footprint_;
+        double turning_radius_, primitive_length_, heuristic_table_radius_, default_tolerance_;
+        bool allow_reverse_;
+        MotionPrimitives primitives_;
+        LatticeSearch search_;
+        boost::mutex mutex_;
+};
+
+} //end namespace global_planner
+#endif
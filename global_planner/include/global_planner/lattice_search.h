@@ -0,0 +1,191 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _LATTICE_SEARCH_H
+#define _LATTICE_SEARCH_H
+
+#include <global_planner/motion_primitives.h>
+#include <boost/unordered_map.hpp>
+#include <algorithm>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @brief A primitive of a lattice path, applied from the state at cell (x, y)
+ */
+struct LatticeStep {
+    int x, y;
+    const MotionPrimitive* primitive;
+};
+
+/**
+ * @class LatticeSearch
+ * @brief A* over the (x, y, heading) states of a MotionPrimitives lattice on a costmap.
+ *
+ * A primitive collides if its footprint mask covers a lethal cell, or with a circular
+ * footprint, if its center passes an inscribed cell. Checking the masks is the expensive
+ * part, so they are only checked once the center comes closer to an obstacle than the
+ * circumscribed radius, i.e. reaches the cost set with setMaskThreshold. A primitive costs
+ * its length in meters, scaled by the turn or reverse penalty and by the highest cost its
+ * center passes.
+ *
+ * The heuristic is the larger of two bounds: the length of the shortest 16-connected path
+ * around the inscribed cells, computed from the goal for every plan, and a table of the
+ * cost of the lattice path in free space between states near each other, computed once.
+ * The first captures the obstacles, the second the turning radius.
+ */
+class LatticeSearch {
+    public:
+        LatticeSearch(const MotionPrimitives& primitives);
+
+        /**
+         * @param turn_penalty The factor on the length of turns
+         * @param reverse_penalty The factor on the length of reverse steps
+         * @param cost_factor The factor on the normalized cost of the cells passed
+         */
+        void setPenalties(double turn_penalty, double reverse_penalty, double cost_factor);
+
+        void setHasUnknown(bool unknown) {
+            unknown_ = unknown;
+        }
+
+        /**
+         * @brief  Sets the lowest cost of the cells passed for which the footprint masks are checked, 0 to always check them
+         */
+        void setMaskThreshold(unsigned char cost) {
+            mask_threshold_ = cost;
+        }
+
+        /**
+         * @brief  Sets the factor on the heuristic, paths cost at most epsilon times as much as the best one
+         */
+        void setEpsilon(float epsilon) {
+            epsilon_ = std::max(1.0f, epsilon);
+        }
+
+        void setMaxExpansions(int max_expansions) {
+            max_expansions_ = max_expansions;
+        }
+
+        /**
+         * @brief  Computes the free space costs between states up to a distance apart, after the primitives and penalties are set
+         * @param radius The distance in meters, 0 to not use a table
+         */
+        void computeHeuristicTable(double radius);
+
+        /**
+         * @brief  Searches for a lattice path
+         * @param costs The costmap
+         * @param nx The x size of the map
+         * @param ny The y size of the map
+         * @param start_x The cell of the start
+         * @param start_y
+         * @param start_heading The heading of the start
+         * @param goal_x The cell of the goal
+         * @param goal_y
+         * @param goal_heading The heading of the goal, paths end with it
+         * @param tolerance The distance from the goal cell, in cells, paths may end at
+         * @param path Filled with the steps from the start to the goal
+         * @return True if a path was found
+         */
+        bool search(const unsigned char* costs, int nx, int ny, int start_x, int start_y, int start_heading,
+                    int goal_x, int goal_y, int goal_heading, double tolerance, std::vector<LatticeStep>& path);
+
+        int getExpansions() const {
+            return expansions_;
+        }
+
+        /**
+         * @brief  The cost of the last path found
+         */
+        double getCost() const {
+            return cost_;
+        }
+
+        /**
+         * @brief  The free space cost from a state at cell (0, 0) to a state at (dx, dy), -1 outside of the table
+         */
+        float getTableCost(int start_heading, int dx, int dy, int end_heading) const;
+
+    private:
+        struct Node {
+            unsigned int state;
+            float g;
+            int parent, primitive;
+            bool closed;
+        };
+
+        /**
+         * @brief  The cost of a primitive from a cell, or a negative value if it collides or leaves the map
+         */
+        float primitiveCost(const unsigned char* costs, int x, int y, const MotionPrimitive& primitive) const;
+        float penalty(const MotionPrimitive& primitive) const;
+        void computeDistances(const unsigned char* costs, int start_x, int start_y, int goal_x, int goal_y,
+                              double tolerance);
+        float heuristic(int x, int y, int heading) const;
+        bool blocked(unsigned char cost) const;
+
+        const MotionPrimitives& primitives_;
+        double turn_penalty_, reverse_penalty_, cost_factor_;
+        bool unknown_;
+        unsigned char mask_threshold_;
+        float epsilon_;
+        int max_expansions_, expansions_;
+        double cost_;
+
+        int nx_, ny_;
+        int start_x_, start_y_, goal_x_, goal_y_, goal_heading_;
+        double tolerance_;
+        bool use_table_;
+
+        // the 16-connected distances to the goal in meters, of the cells settled before the search stopped at horizon_
+        std::vector<float> distances_;
+        std::vector<unsigned char> settled_;
+        std::vector<int> touched_;
+        float horizon_;
+
+        // the costs from a state at (0, 0) with one of the first four headings, the others are rotations of them
+        int table_radius_;
+        std::vector<float> table_;
+
+        std::vector<Node> nodes_;
+        boost::unordered_map<unsigned int, int> index_;
+};
+
+} //end namespace global_planner
+#endif
@@ -0,0 +1,117 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _LPASTAR_H
+#define _LPASTAR_H
+
+#include <global_planner/planner_core.h>
+#include <global_planner/expander.h>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class LPAStarExpansion
+ * @brief Lifelong Planning A* (without heuristic) over the interpolated potential.
+ *
+ * The potentials (g values), their one-step lookahead (rhs values) and the open
+ * list are kept between calls. Each call compares the costmap with the costs of
+ * the previous call and only repairs the potential around the cells that changed,
+ * so the work depends on the size of the change rather than the size of the map.
+ * The search restarts from scratch when the map is resized, the start cell moves
+ * or the cost parameters change.
+ *
+ * Since only the start cell is fixed, the planner should root the search at the
+ * goal and trace the path back from the robot.
+ */
+class LPAStarExpansion : public Expander {
+    public:
+        LPAStarExpansion(PotentialCalculator* p_calc, int nx, int ny);
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y, int cycles,
+                                float* potential);
+
+        /**
+         * @brief  Sets or resets the size of the map, which restarts the search
+         * @param nx The x size of the map
+         * @param ny The y size of the map
+         */
+        void setSize(int nx, int ny);
+
+        /**
+         * @brief  Forget the previous search, the next call expands from scratch
+         */
+        void reset() { needs_reset_ = true; }
+
+    private:
+        void restart(unsigned char* costs, int start_i);
+        void updateCell(unsigned char* costs, int n);
+
+        float getCost(unsigned char* costs, int n) {
+            float c = costs[n];
+            if (c < lethal_cost_ - 1 || (unknown_ && c==255)) {
+                c = c * factor_ + neutral_cost_;
+                if (c >= lethal_cost_)
+                    c = lethal_cost_ - 1;
+                return c;
+            }
+            return lethal_cost_;
+        }
+
+        inline float key(int n) {
+            return std::min(g_[n], rhs_[n]);
+        }
+
+        // binary heap of inconsistent cells with a position index for decrease-key and removal
+        void heapUpdate(int n);
+        void heapRemove(int n);
+        int heapPop();
+        void heapSiftUp(int pos);
+        void heapSiftDown(int pos);
+
+        std::vector<float> g_, rhs_;
+        std::vector<unsigned char> last_costs_;
+        std::vector<int> heap_, heap_pos_;
+
+        bool needs_reset_;
+        int start_i_;
+        unsigned char last_lethal_cost_, last_neutral_cost_;
+        float last_factor_;
+        bool last_unknown_;
+};
+
+} //end namespace global_planner
+#endif
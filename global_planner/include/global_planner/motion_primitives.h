@@ -0,0 +1,133 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _MOTION_PRIMITIVES_H
+#define _MOTION_PRIMITIVES_H
+
+#include <vector>
+#include <geometry_msgs/Point.h>
+
+namespace global_planner {
+
+/**
+ * @brief A pose along a motion primitive, in cells relative to the center of its start cell
+ */
+struct LatticePose {
+    double x, y, theta;
+};
+
+/**
+ * @brief A short, kinematically feasible motion from one lattice state to another
+ */
+struct MotionPrimitive {
+    int start_heading, end_heading;
+    int dx, dy; /**< the end cell relative to the start cell */
+    double length; /**< in meters */
+    bool turn, reverse;
+    std::vector<LatticePose> poses; /**< the last pose lies on the center of the end cell */
+
+    // cells relative to the start cell: covered by the footprint along the motion, and passed by its center
+    std::vector<int> mask_dx, mask_dy;
+    std::vector<int> trace_dx, trace_dy;
+    int min_dx, max_dx, min_dy, max_dy; /**< bounds of the mask */
+};
+
+/**
+ * @class MotionPrimitives
+ * @brief The motions of a state lattice over (x, y, heading), for robots that cannot turn in place.
+ *
+ * The 16 headings point along the cell vectors (1, 0), (2, 1), (1, 1), (1, 2), ... so that
+ * straight motions end on cell centers, which makes them slightly non-uniform. From every
+ * heading there is a one-vector step, a longer step of about step_length, and arcs to both
+ * neighboring headings with the minimum turning radius. An arc endpoint is rounded to the
+ * nearest cell, and the motion is a cubic Hermite curve between the exact start and end
+ * states, so consecutive primitives join without kinks. Reverse steps are optional.
+ *
+ * For every primitive the cells swept by the footprint are rasterized once with the
+ * polygon functions of costmap_2d, so checking a motion against the costmap is a lookup
+ * over cell offsets. Only convex footprints are rasterized exactly, like in CostmapModel.
+ */
+class MotionPrimitives {
+    public:
+        static const int NUM_HEADINGS = 16;
+
+        MotionPrimitives();
+
+        /**
+         * @brief  Generates the primitives and their footprint masks
+         * @param resolution The resolution of the costmap in meters per cell
+         * @param turning_radius The minimum turning radius of the robot in meters
+         * @param step_length The length of the long straight steps in meters
+         * @param allow_reverse Whether to add steps backwards
+         * @param footprint The footprint of the robot, with less than 3 points only the center is traced
+         */
+        void generate(double resolution, double turning_radius, double step_length, bool allow_reverse,
+                      const std::vector<geometry_msgs::Point>& footprint);
+
+        const std::vector<MotionPrimitive>& getPrimitives(int heading) const {
+            return primitives_[heading];
+        }
+
+        /**
+         * @brief  Whether the masks cover the footprint polygon, or only the cells passed by its center
+         */
+        bool hasFootprint() const {
+            return has_footprint_;
+        }
+
+        double getResolution() const {
+            return resolution_;
+        }
+
+        static double getHeadingAngle(int heading);
+
+        /**
+         * @brief  The heading closest to an angle
+         */
+        static int getHeading(double theta);
+
+    private:
+        void addPrimitive(int heading, int end_heading, int dx, int dy, bool turn, bool reverse);
+        void rasterize(const std::vector<geometry_msgs::Point>& footprint);
+
+        std::vector<std::vector<MotionPrimitive> > primitives_;
+        double resolution_;
+        bool has_footprint_;
+};
+
+} //end namespace global_planner
+#endif
@@ -46,7 +46,10 @@
 #include <tf/transform_datatypes.h>
 #include <vector>
 #include <nav_core/base_global_planner.h>
+#include <nav_core/tolerant_global_planner.h>
+#include <nav_core/anytime_global_planner.h>
 #include <nav_msgs/GetPlan.h>
+#include <navfn/MakeNavPlans.h>
 #include <dynamic_reconfigure/server.h>
 #include <global_planner/potential_calculator.h>
 #include <global_planner/expander.h>
@@ -58,13 +61,21 @@ namespace global_planner {
 
 class Expander;
 class GridPath;
+class DijkstraExpansion;
+class ARAStarExpansion;
+class CompactDijkstraExpansion;
+class HPAStarExpansion;
+class CompactPotential;
+class LandmarkHeuristic;
+class PotentialPublisher;
 
 /**
  * @class PlannerCore
  * @brief Provides a ROS wrapper for the global_planner planner which runs a fast, interpolated navigation function on a costmap.
  */
 
-class GlobalPlanner : public nav_core::BaseGlobalPlanner {
+class GlobalPlanner : public nav_core::BaseGlobalPlanner, public nav_core::AnytimeGlobalPlanner,
+        public nav_core::TolerantGlobalPlanner {
     public:
         /**
          * @brief  Default constructor for the PlannerCore object
@@ -114,6 +125,29 @@ class GlobalPlanner : public nav_core::BaseGlobalPlanner {
         bool makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal, double tolerance,
                       std::vector<geometry_msgs::PoseStamped>& plan);
 
+        /**
+         * @brief Given a goal pose in the world, compute a plan, and report the plans found on the way with the anytime planner
+         * @param start The start pose
+         * @param goal The goal pose
+         * @param plan The plan... filled by the planner
+         * @param callback Called with every plan the anytime planner improves on before it returns
+         * @return True if a valid plan was found, false otherwise
+         */
+        bool makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                      std::vector<geometry_msgs::PoseStamped>& plan, const PlanCallback& callback);
+
+        /**
+         * @brief Given many goal poses in the world, compute their costs and plans with a single Dijkstra expansion
+         * from the start, which stops once it has reached all of the goals
+         * @param start The start pose
+         * @param goals The goal poses
+         * @param costs Filled with the potential at each goal, POT_HIGH for the goals that could not be reached
+         * @param plans If not NULL, filled with the plan to each goal, empty for the goals that could not be reached
+         * @return True if at least one goal could be reached, false otherwise
+         */
+        bool makePlans(const geometry_msgs::PoseStamped& start, const std::vector<geometry_msgs::PoseStamped>& goals,
+                       std::vector<double>& costs, std::vector<std::vector<geometry_msgs::PoseStamped> >* plans = NULL);
+
         /**
          * @brief  Computes the full navigation function for the map given a point in the world to start from
          * @param world_point The point to use for seeding the navigation function
@@ -164,6 +198,8 @@ class GlobalPlanner : public nav_core::BaseGlobalPlanner {
 
         bool makePlanService(nav_msgs::GetPlan::Request& req, nav_msgs::GetPlan::Response& resp);
 
+        bool makePlansService(navfn::MakeNavPlans::Request& req, navfn::MakeNavPlans::Response& resp);
+
     protected:
 
         /**
@@ -173,33 +209,89 @@ class GlobalPlanner : public nav_core::BaseGlobalPlanner {
         std::string frame_id_;
         ros::Publisher plan_pub_;
         bool initialized_, allow_unknown_, visualize_potential_;
+        bool hierarchical_; /**< plan on a cluster graph first, see HPAStarExpansion */
 
     private:
         void mapToWorld(double mx, double my, double& wx, double& wy);
         bool worldToMap(double wx, double wy, double& mx, double& my);
         void clearRobotCell(const tf::Stamped<tf::Pose>& global_pose, unsigned int mx, unsigned int my);
-        void publishPotential(float* potential);
+        template<typename Potential>
+        void publishPotential(const Potential& potential, const std::vector<geometry_msgs::PoseStamped>& plan);
+        void improvedPotential(float* potential, double start_x, double start_y, double goal_x, double goal_y,
+                               const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal);
+        bool getPlanFromPotential(Traceback* path_maker, float* potential, double start_x, double start_y,
+                                  double end_x, double end_y, const geometry_msgs::PoseStamped& goal,
+                                  std::vector<geometry_msgs::PoseStamped>& plan);
+        bool getPlanFromPath(const std::vector<std::pair<float, float> >& path, const geometry_msgs::PoseStamped& goal,
+                             std::vector<geometry_msgs::PoseStamped>& plan);
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double goal_x, double goal_y,
+                                 unsigned int start_x_i, unsigned int start_y_i, unsigned int goal_x_i,
+                                 unsigned int goal_y_i);
+
+        /**
+         * @brief  Closes the border of the corridor around the last plan in the costmap, until openCorridor
+         * @return False if the goal changed or the robot is not inside the corridor, the costmap is left alone then
+         */
+        bool closeCorridor(unsigned int start_x, unsigned int start_y, unsigned int goal_x, unsigned int goal_y);
+        void openCorridor();
 
         double planner_window_x_, planner_window_y_, default_tolerance_;
         std::string tf_prefix_;
         boost::mutex mutex_;
-        ros::ServiceServer make_plan_srv_;
+        ros::ServiceServer make_plan_srv_, make_plans_srv_;
 
         PotentialCalculator* p_calc_;
         Expander* planner_;
         Traceback* path_maker_;
         OrientationFilter* orientation_filter_;
 
+        ARAStarExpansion* anytime_planner_; /**< planner_ when it is the anytime planner, NULL otherwise */
+        HPAStarExpansion* hierarchical_planner_; /**< planner_ when it is the hierarchical planner, NULL otherwise */
+        costmap_2d::LayeredCostmap* layered_costmap_; /**< tells what changed between plans, NULL for a bare costmap */
+        PlanCallback plan_callback_;
+
+        // with the compact potential, potential_array_ is only allocated for batch queries
+        CompactDijkstraExpansion* compact_planner_; /**< planner_ when it is the compact planner, NULL otherwise */
+        CompactPotential* compact_potential_;
+
+        // the batch queries share potential_array_, and planner_ when it is a Dijkstra expansion
+        DijkstraExpansion* batch_planner_; /**< made on the first batch query */
+        Traceback* batch_path_maker_;
+        bool use_grid_path_;
+        int lethal_cost_, neutral_cost_; /**< the costs of the last reconfigure, for the batch expansion */
+        double cost_factor_;
+
+        LandmarkHeuristic* landmarks_;
+        costmap_2d::Costmap2D* landmark_map_; /**< the layer of the costmap the landmarks are computed on */
+
         bool publish_potential_;
-        ros::Publisher potential_pub_;
+        PotentialPublisher* potential_publisher_;
         int publish_scale_;
+        int potential_downsample_; /**< only every n-th cell of the potential is published on both axes */
+        double potential_crop_margin_; /**< if positive, only the potential around the plan is published */
+
+        // replans to the same goal only expand the corridor around the last plan, the cells around it are lethal
+        double corridor_width_; /**< full width of the corridor in meters, 0 disables it */
+        std::vector<geometry_msgs::PoseStamped> last_plan_;
+        geometry_msgs::Point last_goal_; /**< the goal last_plan_ was made for, it may end anywhere within the tolerance */
+        std::vector<unsigned char> corridor_mask_; /**< the corridor in its bounding box */
+        std::vector<int> corridor_cells_; /**< the cells of the corridor in its bounding box */
+        std::vector<int> corridor_border_; /**< the cells of the costmap closeCorridor closed */
+        std::vector<unsigned char> corridor_border_costs_; /**< their costs, for openCorridor */
 
         void outlineMap(unsigned char* costarr, int nx, int ny, unsigned char value);
+        /**
+         * @brief  The cells of the map within 2 cells of a goal, which clearEndpoint may change
+         */
+        void cellsAroundGoal(int goal_i, int nx, int ny, std::vector<int>& cells);
+        void resizePotentialArray(int size);
         unsigned char* cost_array_;
         float* potential_array_;
+        int potential_array_size_; /**< number of cells allocated for potential_array_ */
         unsigned int start_x_, start_y_, end_x_, end_y_;
 
         bool old_navfn_behavior_;
+        bool root_at_goal_;
         float convert_offset_;
 
         dynamic_reconfigure::Server<global_planner::GlobalPlannerConfig> *dsrv_;
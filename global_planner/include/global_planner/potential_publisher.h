@@ -0,0 +1,133 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _POTENTIAL_PUBLISHER_H
+#define _POTENTIAL_PUBLISHER_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <ros/ros.h>
+#include <nav_msgs/OccupancyGrid.h>
+#include <boost/thread.hpp>
+
+#include <global_planner/planner_core.h>
+
+namespace global_planner {
+
+/**
+ * @class PotentialPublisher
+ * @brief Publishes a potential as an OccupancyGrid from a background thread.
+ *
+ * The planning thread only copies the region that is shown, every step-th cell of it on both axes,
+ * and finds its largest potential on the way. Scaling the copy into the message and publishing
+ * it happens in the background, and a copy that is still waiting when the next one comes in is
+ * replaced, so a slow subscriber never holds up planning.
+ */
+class PotentialPublisher {
+    public:
+        PotentialPublisher(ros::NodeHandle& nh, const std::string& topic);
+        ~PotentialPublisher();
+
+        bool hasSubscribers() const {
+            return publisher_.getNumSubscribers() > 0;
+        }
+
+        /**
+         * @brief  Copies a region of the potential, and hands it to the background thread
+         * @param potential The potential of the whole map, anything with operator[] returning the potential of a cell
+         * @param nx The x size of the map
+         * @param x0 The first column of the region
+         * @param y0 The first row of the region
+         * @param x1 The column after the region
+         * @param y1 The row after the region
+         * @param step Only every step-th cell of the region is published on both axes
+         * @param grid The header of the message, and the resolution and origin of the whole map
+         * @param scale The value the largest potential is published as
+         */
+        template<typename Potential>
+        void publish(const Potential& potential, int nx, int x0, int y0, int x1, int y1, int step,
+                     const nav_msgs::OccupancyGrid& grid, int scale) {
+            step = std::max(1, step);
+            int width = (x1 - x0 + step - 1) / step, height = (y1 - y0 + step - 1) / step;
+            std::vector<float> values(width * height);
+            float max = 0.0;
+            for (int y = 0; y < height; y++) {
+                const int row = (y0 + y * step) * nx + x0;
+                for (int x = 0; x < width; x++) {
+                    float value = potential[row + x * step];
+                    values[y * width + x] = value;
+                    if (value < POT_HIGH && value > max)
+                        max = value;
+                }
+            }
+
+            boost::mutex::scoped_lock lock(mutex_);
+            grid_ = grid;
+            // each published cell is centered on the cell it was copied from, not on the block that starts there
+            grid_.info.origin.position.x += (x0 - (step - 1) / 2.0) * grid.info.resolution;
+            grid_.info.origin.position.y += (y0 - (step - 1) / 2.0) * grid.info.resolution;
+            grid_.info.resolution *= step;
+            grid_.info.width = width;
+            grid_.info.height = height;
+            values_.swap(values);
+            max_ = max;
+            scale_ = scale;
+            pending_ = true;
+            condition_.notify_one();
+        }
+
+    private:
+        void publishThread();
+
+        ros::Publisher publisher_;
+
+        boost::mutex mutex_;
+        boost::condition_variable condition_;
+        boost::thread* thread_;
+        bool pending_, stop_;
+
+        // the copy waiting for the background thread
+        nav_msgs::OccupancyGrid grid_;
+        std::vector<float> values_;
+        float max_;
+        int scale_;
+};
+
+} //end namespace global_planner
+#endif
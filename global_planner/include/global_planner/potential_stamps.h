@@ -0,0 +1,124 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _POTENTIAL_STAMPS_H
+#define _POTENTIAL_STAMPS_H
+
+#include <algorithm>
+#include <vector>
+
+#include <global_planner/planner_core.h>
+
+namespace global_planner {
+
+/**
+ * @class PotentialStamps
+ * @brief Generation stamps telling which cells of a potential array belong to the current search.
+ *
+ * A reset starts a new generation instead of filling the array, and is only O(N) when the
+ * one byte counter wraps around. Cells of older generations read as POT_HIGH through get().
+ * When a cell is first written, the stale cells up to two cells around it are set to POT_HIGH,
+ * so the calculators and the tracebacks, which only look that far around reached cells, can
+ * keep reading the array directly.
+ */
+class PotentialStamps {
+    public:
+        PotentialStamps() :
+                nx_(0), ns_(0), generation_(1) {
+        }
+
+        void setSize(int nx, int ny) {
+            nx_ = nx;
+            ns_ = nx * ny;
+        }
+
+        /**
+         * @brief  Makes every cell read as POT_HIGH, the stamps are allocated by the first reset after a resize
+         */
+        void reset() {
+            if ((int) stamps_.size() != ns_) {
+                stamps_.assign(ns_, 0);
+                generation_ = 1;
+            } else if (++generation_ == 0) {
+                std::fill(stamps_.begin(), stamps_.end(), 0);
+                generation_ = 1;
+            }
+        }
+
+        /**
+         * @brief  The potential of cell n, POT_HIGH if it is left from an earlier search
+         */
+        inline float get(const float* potential, int n) const {
+            return stamps_[n] == generation_ ? potential[n] : POT_HIGH;
+        }
+
+        inline void set(float* potential, int n, float value) {
+            if (stamps_[n] != generation_ || potential[n] >= POT_HIGH)
+                claim(potential, n);
+            potential[n] = value;
+        }
+
+        /**
+         * @brief  Sets the stale cells up to two cells around cell n to POT_HIGH, and makes them current
+         */
+        void claim(float* potential, int n) {
+            // a cell at the end of a row claims some at the start of the next one too, which does no harm
+            for (int row = n - 2 * nx_; row <= n + 2 * nx_; row += nx_) {
+                int last = std::min(row + 2, ns_ - 1);
+                for (int m = std::max(row - 2, 0); m <= last; m++)
+                    if (stamps_[m] != generation_) {
+                        stamps_[m] = generation_;
+                        potential[m] = POT_HIGH;
+                    }
+            }
+        }
+
+        /**
+         * @brief  Marks every cell current, after the whole array was written
+         */
+        void setAll() {
+            std::fill(stamps_.begin(), stamps_.end(), generation_);
+        }
+
+    private:
+        int nx_, ns_;
+        std::vector<unsigned char> stamps_;
+        unsigned char generation_;
+};
+
+} //end namespace global_planner
+#endif
@@ -0,0 +1,99 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#ifndef _THETASTAR_H
+#define _THETASTAR_H
+
+#include <global_planner/planner_core.h>
+#include <global_planner/expander.h>
+#include <global_planner/astar.h>
+#include <vector>
+
+namespace global_planner {
+
+/**
+ * @class ThetaStarExpansion
+ * @brief Any-angle search with Lazy Theta*.
+ *
+ * An 8-connected A* in which every cell takes the parent of the cell that reaches
+ * it, as long as the straight line between them does not cross a lethal cell.
+ * The line is only checked once the cell is expanded, and if it is blocked the
+ * cell falls back to its best expanded neighbor. The cost of a segment is its
+ * length times the average cost of the cells along the line, which are traversed
+ * like Costmap2D::raytraceLine does.
+ *
+ * The potential holds the cost from the start, but the path follows the parents,
+ * so use ThetaStarPath to extract it.
+ */
+class ThetaStarExpansion : public Expander {
+    public:
+        ThetaStarExpansion(PotentialCalculator* p_calc, int nx, int ny);
+        bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y, int cycles,
+                                float* potential);
+
+        /**
+         * @brief  Sets or resets the size of the map
+         * @param nx The x size of the map
+         * @param ny The y size of the map
+         */
+        void setSize(int nx, int ny);
+
+        /**
+         * @brief  The cell a cell is reached from in straight line by the last search, -1 if it was not expanded
+         */
+        int getParent(int n) const {
+            return closed_[n] == epoch_ ? parent_[n] : -1;
+        }
+
+    private:
+        inline bool traversable(unsigned char* costs, int n) {
+            return costs[n] < lethal_cost_ || (unknown_ && costs[n] == 255);
+        }
+
+        /**
+         * @brief  Cost of the straight line between two cells, or POT_HIGH if it is blocked
+         */
+        float lineCost(unsigned char* costs, int a, int b);
+
+        std::vector<Index> queue_;
+        std::vector<int> parent_;
+        std::vector<unsigned char> closed_; /**< cells expanded in the current search are equal to epoch_ */
+        unsigned char epoch_;
+};
+
+} //end namespace global_planner
+#endif
@@ -0,0 +1,152 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/arastar.h>
+#include <costmap_2d/cost_values.h>
+#include <ros/time.h>
+#include <stdlib.h>
+
+namespace global_planner {
+
+ARAStarExpansion::ARAStarExpansion(PotentialCalculator* p_calc, int nx, int ny) :
+        Expander(p_calc, nx, ny), epoch_(0), initial_epsilon_(3.0), epsilon_step_(0.5), epsilon_(0.0),
+        search_epsilon_(1.0), time_budget_(0.0) {
+    setSize(nx, ny);
+}
+
+void ARAStarExpansion::setSize(int nx, int ny) {
+    Expander::setSize(nx, ny);
+    if ((int) closed_.size() != ns_) {
+        closed_.assign(ns_, 0);
+        listed_.assign(ns_, 0);
+        epoch_ = 0;
+    }
+}
+
+bool ARAStarExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x,
+                                           double end_y, int cycles, float* potential) {
+    ros::WallTime deadline = ros::WallTime::now() + ros::WallDuration(time_budget_ > 0 ? time_budget_ : 1e9);
+    queue_.clear();
+    incons_.clear();
+    cells_visited_ = 0;
+    epsilon_ = 0.0;
+    epoch_++;
+
+    int start_i = toIndex(start_x, start_y);
+    int goal_i = toIndex(end_x, end_y);
+    resetPotential();
+    setPotential(potential, start_i, 0);
+
+    search_epsilon_ = std::max(1.0f, initial_epsilon_);
+    queue_.push_back(Index(start_i, search_epsilon_ * heuristic(start_i, end_x, end_y)));
+
+    int cycle = 0;
+    while (true) {
+        // expand until no cell in the queue can lead to a cheaper goal
+        while (queue_.size() > 0 && queue_[0].cost < stamps_.get(potential, goal_i)) {
+            // the budget only cuts the improvements short, the first search always gets to the goal
+            if (cycle >= cycles || (epsilon_ > 0 && cycle % 256 == 0 && ros::WallTime::now() > deadline))
+                return stamps_.get(potential, goal_i) < POT_HIGH;
+
+            int i = queue_[0].i;
+            std::pop_heap(queue_.begin(), queue_.end(), greater1());
+            queue_.pop_back();
+            // cells are pushed again when they are lowered, the first time they come out counts
+            if (closed_[i] == epoch_)
+                continue;
+            closed_[i] = epoch_;
+            cells_visited_++;
+            cycle++;
+
+            add(costs, potential, potential[i], i + 1, end_x, end_y);
+            add(costs, potential, potential[i], i - 1, end_x, end_y);
+            add(costs, potential, potential[i], i + nx_, end_x, end_y);
+            add(costs, potential, potential[i], i - nx_, end_x, end_y);
+        }
+
+        if (stamps_.get(potential, goal_i) >= POT_HIGH)
+            return false;
+        epsilon_ = search_epsilon_;
+        if (search_epsilon_ <= 1.0 || epsilon_step_ <= 0 || ros::WallTime::now() > deadline)
+            return true;
+
+        if (callback_)
+            callback_(potential);
+
+        // the next search starts from the open and the inconsistent cells, with the lower epsilon
+        search_epsilon_ = std::max(1.0f, search_epsilon_ - epsilon_step_);
+        std::vector<Index> open;
+        open.swap(queue_);
+        for (unsigned int k = 0; k < open.size(); k++)
+            if (closed_[open[k].i] != epoch_)
+                incons_.push_back(open[k].i);
+        epoch_++;
+        for (unsigned int k = 0; k < incons_.size(); k++) {
+            int n = incons_[k];
+            queue_.push_back(Index(n, potential[n] + search_epsilon_ * heuristic(n, end_x, end_y)));
+        }
+        std::make_heap(queue_.begin(), queue_.end(), greater1());
+        incons_.clear();
+    }
+}
+
+void ARAStarExpansion::add(unsigned char* costs, float* potential, float prev_potential, int next_i, int end_x,
+                           int end_y) {
+    if (next_i < 0 || next_i >= ns_)
+        return;
+
+    if(costs[next_i]>=lethal_cost_ && !(unknown_ && costs[next_i]==costmap_2d::NO_INFORMATION))
+        return;
+
+    float pot = p_calc_->calculatePotential(potential, costs[next_i] + neutral_cost_, next_i, prev_potential);
+    if (pot >= potential[next_i])
+        return;
+    setPotential(potential, next_i, pot);
+
+    if (closed_[next_i] == epoch_) {
+        // expanded already in this search, it waits for the next one
+        if (listed_[next_i] != epoch_) {
+            listed_[next_i] = epoch_;
+            incons_.push_back(next_i);
+        }
+        return;
+    }
+    queue_.push_back(Index(next_i, pot + search_epsilon_ * heuristic(next_i, end_x, end_y)));
+    std::push_heap(queue_.begin(), queue_.end(), greater1());
+}
+
+} //end namespace global_planner
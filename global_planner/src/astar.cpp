@@ -41,27 +41,41 @@
 namespace global_planner {
 
 AStarExpansion::AStarExpansion(PotentialCalculator* p_calc, int xs, int ys) :
-        Expander(p_calc, xs, ys) {
+        Expander(p_calc, xs, ys), use_buckets_(false), landmarks_(NULL), use_landmarks_(false) {
 }
 
 bool AStarExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y,
                                         int cycles, float* potential) {
     queue_.clear();
+    cells_visited_ = 0;
     int start_i = toIndex(start_x, start_y);
-    queue_.push_back(Index(start_i, 0));
-
-    std::fill(potential, potential + ns_, POT_HIGH);
-    potential[start_i] = 0;
-
     int goal_i = toIndex(end_x, end_y);
+    use_landmarks_ = landmarks_ && landmarks_->isValid(nx_, ny_);
+    if (use_landmarks_)
+        landmarks_->setGoal(goal_i);
+    if (use_buckets_) {
+        // a step adds at most the cost of a cell plus the largest step of the heuristic
+        buckets_.clear(255 + (1 + (use_landmarks_ ? landmarks_->getMaxStep() : 1)) * neutral_cost_);
+        buckets_.push(start_i, 0);
+    } else
+        queue_.push_back(Index(start_i, 0));
+
+    resetPotential();
+    setPotential(potential, start_i, 0);
+
     int cycle = 0;
 
-    while (queue_.size() > 0 && cycle < cycles) {
-        Index top = queue_[0];
-        std::pop_heap(queue_.begin(), queue_.end(), greater1());
-        queue_.pop_back();
+    while ((use_buckets_ ? !buckets_.empty() : queue_.size() > 0) && cycle < cycles) {
+        int i;
+        if (use_buckets_) {
+            i = buckets_.pop();
+        } else {
+            i = queue_[0].i;
+            std::pop_heap(queue_.begin(), queue_.end(), greater1());
+            queue_.pop_back();
+        }
+        cells_visited_++;
 
-        int i = top.i;
         if (i == goal_i)
             return true;
 
@@ -87,12 +101,19 @@ void AStarExpansion::add(unsigned char* costs, float* potential, float prev_pote
     if(costs[next_i]>=lethal_cost_ && !(unknown_ && costs[next_i]==costmap_2d::NO_INFORMATION))
         return;
 
-    potential[next_i] = p_calc_->calculatePotential(potential, costs[next_i] + neutral_cost_, next_i, prev_potential);
+    setPotential(potential, next_i,
+                 p_calc_->calculatePotential(potential, costs[next_i] + neutral_cost_, next_i, prev_potential));
     int x = next_i % nx_, y = next_i / nx_;
     float distance = abs(end_x - x) + abs(end_y - y);
-
-    queue_.push_back(Index(next_i, potential[next_i] + distance * neutral_cost_));
-    std::push_heap(queue_.begin(), queue_.end(), greater1());
+    if (use_landmarks_)
+        distance = std::max(distance, landmarks_->getDistance(next_i));
+
+    if (use_buckets_) {
+        buckets_.push(next_i, potential[next_i] + distance * neutral_cost_);
+    } else {
+        queue_.push_back(Index(next_i, potential[next_i] + distance * neutral_cost_));
+        std::push_heap(queue_.begin(), queue_.end(), greater1());
+    }
 }
 
 } //end namespace global_planner
@@ -0,0 +1,180 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/bidirectional.h>
+#include <costmap_2d/cost_values.h>
+
+namespace global_planner {
+
+BidirectionalExpansion::BidirectionalExpansion(PotentialCalculator* p_calc, int nx, int ny) :
+        Expander(p_calc, nx, ny), use_heuristic_(true) {
+    setSize(nx, ny);
+}
+
+void BidirectionalExpansion::setSize(int nx, int ny) {
+    Expander::setSize(nx, ny);
+    if ((int) back_potential_.size() != ns_)
+        back_potential_.resize(ns_);
+    back_stamps_.setSize(nx, ny);
+}
+
+bool BidirectionalExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x,
+                                                 double end_y, int cycles, float* potential) {
+    int start_i = toIndex(start_x, start_y), goal_i = toIndex(end_x, end_y);
+    cells_visited_ = 0;
+
+    resetPotential();
+    back_stamps_.reset();
+
+    forward_.clear();
+    backward_.clear();
+    setPotential(potential, start_i, 0);
+    forward_.push_back(Index(start_i, 0));
+    float* back = &back_potential_[0];
+    back_stamps_.set(back, goal_i, 0);
+    backward_.push_back(Index(goal_i, 0));
+
+    float goal_cost = costs[goal_i] + neutral_cost_;
+    float best = POT_HIGH; // lowest potential through a cell reached from both sides, without the cost of the goal
+    int cycle = 0;
+    while (forward_.size() > 0 && backward_.size() > 0 && cycle < cycles) {
+        // stop once no path through the open cells can be cheaper than the best meeting cell
+        if (best < POT_HIGH) {
+            if (use_heuristic_ ? forward_[0].cost >= best + goal_cost || backward_[0].cost >= best + 255 + neutral_cost_
+                               : forward_[0].cost + backward_[0].cost >= best)
+                break;
+        }
+
+        bool forward = forward_[0].cost <= backward_[0].cost;
+        std::vector<Index>& queue = forward ? forward_ : backward_;
+        int i = queue[0].i;
+        std::pop_heap(queue.begin(), queue.end(), greater1());
+        queue.pop_back();
+        cells_visited_++;
+        cycle++;
+
+        if (forward) {
+            add(costs, potential, potential[i], i + 1, end_x, end_y, FORWARD);
+            add(costs, potential, potential[i], i - 1, end_x, end_y, FORWARD);
+            add(costs, potential, potential[i], i + nx_, end_x, end_y, FORWARD);
+            add(costs, potential, potential[i], i - nx_, end_x, end_y, FORWARD);
+        } else {
+            add(costs, back, back[i], i + 1, start_x, start_y, BACKWARD);
+            add(costs, back, back[i], i - 1, start_x, start_y, BACKWARD);
+            add(costs, back, back[i], i + nx_, start_x, start_y, BACKWARD);
+            add(costs, back, back[i], i - nx_, start_x, start_y, BACKWARD);
+        }
+        updateMeeting(costs, potential, i, best);
+    }
+    if (best >= POT_HIGH)
+        return false;
+
+    // continue from the start, guided by the potential from the end
+    for (unsigned int i = 0; i < forward_.size(); i++) {
+        int n = forward_[i].i;
+        forward_[i].cost = potential[n] + back_stamps_.get(back, n) - (costs[n] + neutral_cost_);
+    }
+    std::make_heap(forward_.begin(), forward_.end(), greater1());
+
+    while (forward_.size() > 0 && cycle < cycles) {
+        int i = forward_[0].i;
+        std::pop_heap(forward_.begin(), forward_.end(), greater1());
+        forward_.pop_back();
+        cells_visited_++;
+        cycle++;
+
+        if (i == goal_i)
+            return true;
+
+        add(costs, potential, potential[i], i + 1, end_x, end_y, STITCH);
+        add(costs, potential, potential[i], i - 1, end_x, end_y, STITCH);
+        add(costs, potential, potential[i], i + nx_, end_x, end_y, STITCH);
+        add(costs, potential, potential[i], i - nx_, end_x, end_y, STITCH);
+    }
+
+    return false;
+}
+
+//
+// Both potentials include the cost of the cell itself, so a path through a cell
+// reached from both sides counts that cost once too often
+//
+void BidirectionalExpansion::updateMeeting(unsigned char* costs, float* potential, int i, float& best) {
+    int neighbors[4] = { i + 1, i - 1, i + nx_, i - nx_ };
+    for (int k = 0; k < 4; k++) {
+        int n = neighbors[k];
+        if (n < 0 || n >= ns_)
+            continue;
+        // a cell reached from one side only may hold a potential of an earlier search on the other
+        float forward = stamps_.get(potential, n), backward = back_stamps_.get(&back_potential_[0], n);
+        if (forward >= POT_HIGH || backward >= POT_HIGH)
+            continue;
+        best = std::min(best, forward + backward - (costs[n] + neutral_cost_));
+    }
+}
+
+void BidirectionalExpansion::add(unsigned char* costs, float* potential, float prev_potential, int next_i, int end_x,
+                                 int end_y, Direction direction) {
+    if (next_i < 0 || next_i >= ns_)
+        return;
+
+    if (potential[next_i] < POT_HIGH)
+        return;
+
+    if(costs[next_i]>=lethal_cost_ && !(unknown_ && costs[next_i]==costmap_2d::NO_INFORMATION))
+        return;
+
+    float pot = p_calc_->calculatePotential(potential, costs[next_i] + neutral_cost_, next_i, prev_potential);
+    float key = pot;
+    if (direction == BACKWARD)
+        back_stamps_.set(potential, next_i, pot);
+    else
+        setPotential(potential, next_i, pot);
+
+    if (direction == STITCH)
+        key += back_stamps_.get(&back_potential_[0], next_i) - (costs[next_i] + neutral_cost_);
+    else if (use_heuristic_) {
+        int x = next_i % nx_, y = next_i / nx_;
+        key += (abs(end_x - x) + abs(end_y - y)) * neutral_cost_;
+    }
+
+    std::vector<Index>& queue = direction == BACKWARD ? backward_ : forward_;
+    queue.push_back(Index(next_i, key));
+    std::push_heap(queue.begin(), queue.end(), greater1());
+}
+
+} //end namespace global_planner
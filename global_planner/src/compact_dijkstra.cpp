@@ -0,0 +1,203 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/compact_dijkstra.h>
+#include <algorithm>
+#include <math.h>
+
+namespace global_planner {
+
+CompactDijkstraExpansion::CompactDijkstraExpansion(PotentialCalculator* p_calc, int nx, int ny) :
+        Expander(p_calc, nx, ny), pending_epoch_(0), precise_(false), threshold_(0) {
+    priorityIncrement_ = 2 * neutral_cost_;
+}
+
+void CompactDijkstraExpansion::setSize(int nx, int ny) {
+    Expander::setSize(nx, ny);
+    if ((int) pending_.size() != ns_) {
+        pending_.assign(ns_, 0);
+        pending_epoch_ = 0;
+    }
+    stencil_.assign(2 * nx_ + 1, POT_HIGH);
+}
+
+bool CompactDijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x,
+                                                   double end_y, int cycles, float* potential) {
+    bool found = calculatePotentials(costs, start_x, start_y, end_x, end_y, cycles, float_potential_);
+    resetPotential();
+    float_potential_.decode(potential);
+    stamps_.setAll();
+    return found;
+}
+
+inline void CompactDijkstraExpansion::push(std::vector<int>& block, unsigned char* costs, int n) {
+    if (n >= 0 && n < ns_ && pending_[n] != pending_epoch_ && getCost(costs, n) < lethal_cost_) {
+        block.push_back(n);
+        pending_[n] = pending_epoch_;
+    }
+}
+
+bool CompactDijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x,
+                                                   double end_y, int cycles, CompactPotential& potential) {
+    cells_visited_ = 0;
+    threshold_ = lethal_cost_;
+    current_.clear();
+    next_.clear();
+    over_.clear();
+    // a new epoch clears all pending_ flags, unless the counter wraps around
+    if (++pending_epoch_ == 0) {
+        std::fill(pending_.begin(), pending_.end(), 0);
+        pending_epoch_ = 1;
+    }
+    potential.reset(ns_, neutral_cost_ / 256.0, neutral_cost_ / 4.0);
+
+    // set goal
+    int k = toIndex(start_x, start_y);
+
+    if(precise_)
+    {
+        double dx = start_x - (int)start_x, dy = start_y - (int)start_y;
+        dx = floorf(dx * 100 + 0.5) / 100;
+        dy = floorf(dy * 100 + 0.5) / 100;
+        potential.set(k, neutral_cost_ * 2 * dx * dy);
+        potential.set(k+1, neutral_cost_ * 2 * (1-dx)*dy);
+        potential.set(k+nx_, neutral_cost_*2*dx*(1-dy));
+        potential.set(k+nx_+1, neutral_cost_*2*(1-dx)*(1-dy));
+
+        push(current_, costs, k+2);
+        push(current_, costs, k-1);
+        push(current_, costs, k+nx_-1);
+        push(current_, costs, k+nx_+2);
+
+        push(current_, costs, k-nx_);
+        push(current_, costs, k-nx_+1);
+        push(current_, costs, k+nx_*2);
+        push(current_, costs, k+nx_*2+1);
+    }else{
+        potential.set(k, 0);
+        push(current_, costs, k+1);
+        push(current_, costs, k-1);
+        push(current_, costs, k-nx_);
+        push(current_, costs, k+nx_);
+    }
+
+    int startCell = toIndex(end_x, end_y);
+
+    int cycle = 0;
+    for (; cycle < cycles; cycle++) {
+        if (current_.empty() && next_.empty()) // priority blocks empty
+            return false;
+
+        // reset pending_ flags on current priority buffer, and process it
+        for (unsigned int i = 0; i < current_.size(); i++)
+            pending_[current_[i]] = 0;
+        for (unsigned int i = 0; i < current_.size(); i++)
+            updateCell(costs, potential, current_[i]);
+
+        current_.swap(next_);
+        next_.clear();
+
+        // see if we're done with this priority level
+        if (current_.empty()) {
+            threshold_ += priorityIncrement_;
+            current_.swap(over_);
+        }
+
+        // check if we've hit the Start cell
+        if (potential[startCell] < POT_HIGH)
+            break;
+    }
+    return cycle < cycles;
+}
+
+//
+// Copies the four neighbors from the compact potential into a float stencil with the row
+// stride of the map, so that the configured PotentialCalculator does the update
+//
+
+float CompactDijkstraExpansion::calculatePotential(const CompactPotential& potential, float cost, int n) {
+    stencil_[0] = potential.toPotential(potential.getCode(n - nx_));
+    stencil_[nx_ - 1] = potential.toPotential(potential.getCode(n - 1));
+    stencil_[nx_ + 1] = potential.toPotential(potential.getCode(n + 1));
+    stencil_[2 * nx_] = potential.toPotential(potential.getCode(n + nx_));
+    return p_calc_->calculatePotential(&stencil_[0], cost, nx_);
+}
+
+#define INVSQRT2 0.707106781
+
+inline void CompactDijkstraExpansion::updateCell(unsigned char* costs, CompactPotential& potential, int n) {
+    cells_visited_++;
+
+    float c = getCost(costs, n);
+    if (c >= lethal_cost_)    // don't propagate into obstacles
+        return;
+
+    float pot = calculatePotential(potential, c, n);
+    // potentials beyond the range of the codes are dropped, which leaves the cells behind them unreached
+    if (pot >= potential[n] || !potential.set(n, pot))
+        return;
+
+    // the rounded value is what the neighbors will read
+    pot = potential[n];
+    std::vector<int>& block = pot < threshold_ ? next_ : over_;
+    int neighbors[4] = { n - 1, n + 1, n - nx_, n + nx_ };
+    for (int i = 0; i < 4; i++) {
+        int m = neighbors[i];
+        if (potential[m] > pot + INVSQRT2 * getCost(costs, m))
+            push(block, costs, m);
+    }
+}
+
+void CompactDijkstraExpansion::clearEndpoint(unsigned char* costs, CompactPotential& potential, int gx, int gy, int s) {
+    int startCell = toIndex(gx, gy);
+    for(int i=-s;i<=s;i++){
+    for(int j=-s;j<=s;j++){
+        // the border cells are lethal, and their neighbors would be off the map
+        if(gx+i<1 || gx+i>nx_-2 || gy+j<1 || gy+j>ny_-2)
+            continue;
+        int n = startCell+i+nx_*j;
+        if(potential[n]<POT_HIGH)
+            continue;
+        float c = costs[n]+neutral_cost_;
+        float pot = calculatePotential(potential, c, n);
+        if (pot < POT_HIGH)
+            potential.set(n, pot);
+    }
+    }
+}
+
+} //end namespace global_planner
@@ -0,0 +1,79 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/compact_potential.h>
+
+namespace global_planner {
+
+const uint16_t CompactPotential::UNREACHED;
+
+void CompactPotential::reset(int ns, float quantum, float max_quantum) {
+    if ((int) codes_.size() == ns) {
+        if (first_set_ <= last_set_)
+            std::fill(codes_.begin() + first_set_, codes_.begin() + last_set_ + 1, UNREACHED);
+    } else
+        codes_.assign(ns, UNREACHED);
+    first_set_ = ns;
+    last_set_ = -1;
+    quantum_ = quantum;
+    inverse_quantum_ = 1.0 / quantum;
+    max_quantum_ = max_quantum;
+    saturated_ = false;
+}
+
+bool CompactPotential::fit(float potential) {
+    while (potential * inverse_quantum_ + 0.5 >= UNREACHED) {
+        if (quantum_ * 2 > max_quantum_) {
+            saturated_ = true;
+            return false;
+        }
+        // halving the codes keeps them rounded to the nearest multiple of the new quantum
+        quantum_ *= 2;
+        inverse_quantum_ = 1.0 / quantum_;
+        for (int i = first_set_; i <= last_set_; i++)
+            if (codes_[i] != UNREACHED)
+                codes_[i] = (codes_[i] + 1) >> 1;
+    }
+    return true;
+}
+
+void CompactPotential::decode(float* potential) const {
+    for (unsigned int i = 0; i < codes_.size(); i++)
+        potential[i] = (*this)[i];
+}
+
+} //end namespace global_planner
@@ -40,7 +40,7 @@
 namespace global_planner {
 
 DijkstraExpansion::DijkstraExpansion(PotentialCalculator* p_calc, int nx, int ny) :
-        Expander(p_calc, nx, ny), pending_(NULL), precise_(false) {
+        Expander(p_calc, nx, ny), pending_(NULL), pending_epoch_(0), precise_(false) {
     // priority buffers
     buffer1_ = new int[PRIORITYBUFSIZE];
     buffer2_ = new int[PRIORITYBUFSIZE];
@@ -61,12 +61,19 @@ DijkstraExpansion::~DijkstraExpansion() {
 // Set/Reset map size
 //
 void DijkstraExpansion::setSize(int xs, int ys) {
+    // called before every plan, keep the buffer unless the size changed
+    if (pending_ && xs * ys == ns_) {
+        Expander::setSize(xs, ys);
+        return;
+    }
+
     Expander::setSize(xs, ys);
     if (pending_)
         delete[] pending_;
 
-    pending_ = new bool[ns_];
-    memset(pending_, 0, ns_ * sizeof(bool));
+    pending_ = new unsigned char[ns_];
+    memset(pending_, 0, ns_ * sizeof(unsigned char));
+    pending_epoch_ = 0;
 }
 
 //
@@ -88,8 +95,12 @@ bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x
     nextEnd_ = 0;
     overBuffer_ = buffer3_;
     overEnd_ = 0;
-    memset(pending_, 0, ns_ * sizeof(bool));
-    std::fill(potential, potential + ns_, POT_HIGH);
+    // a new epoch clears all pending_ flags, unless the counter wraps around
+    if (++pending_epoch_ == 0) {
+        memset(pending_, 0, ns_ * sizeof(unsigned char));
+        pending_epoch_ = 1;
+    }
+    resetPotential();
 
     // set goal
     int k = toIndex(start_x, start_y);
@@ -99,10 +110,10 @@ bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x
         double dx = start_x - (int)start_x, dy = start_y - (int)start_y;
         dx = floorf(dx * 100 + 0.5) / 100;
         dy = floorf(dy * 100 + 0.5) / 100;
-        potential[k] = neutral_cost_ * 2 * dx * dy;
-        potential[k+1] = neutral_cost_ * 2 * (1-dx)*dy;
-        potential[k+nx_] = neutral_cost_*2*dx*(1-dy);
-        potential[k+nx_+1] = neutral_cost_*2*(1-dx)*(1-dy);//*/
+        setPotential(potential, k, neutral_cost_ * 2 * dx * dy);
+        setPotential(potential, k+1, neutral_cost_ * 2 * (1-dx)*dy);
+        setPotential(potential, k+nx_, neutral_cost_*2*dx*(1-dy));
+        setPotential(potential, k+nx_+1, neutral_cost_*2*(1-dx)*(1-dy));//*/
 
         push_cur(k+2);
         push_cur(k-1);
@@ -114,7 +125,7 @@ bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x
         push_cur(k+nx_*2);
         push_cur(k+nx_*2+1);
     }else{
-        potential[k] = 0;
+        setPotential(potential, k, 0);
         push_cur(k+1);
         push_cur(k-1);
         push_cur(k-nx_);
@@ -143,7 +154,7 @@ bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x
         int *pb = currentBuffer_;
         int i = currentEnd_;
         while (i-- > 0)
-            pending_[*(pb++)] = false;
+            pending_[*(pb++)] = 0;
 
         // process current priority buffer
         pb = currentBuffer_;
@@ -169,7 +180,7 @@ bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x
         }
 
         // check if we've hit the Start cell
-        if (potential[startCell] < POT_HIGH)
+        if (stamps_.get(potential, startCell) < POT_HIGH && reachedTargets(potential))
             break;
     }
     //ROS_INFO("CYCLES %d/%d ", cycle, cycles);
@@ -179,6 +190,13 @@ bool DijkstraExpansion::calculatePotentials(unsigned char* costs, double start_x
         return false;
 }
 
+bool DijkstraExpansion::reachedTargets(float* potential) {
+    for (unsigned int i = 0; i < targets_.size(); i++)
+        if (stamps_.get(potential, targets_[i]) >= POT_HIGH)
+            return false;
+    return true;
+}
+
 //
 // Critical function: calculate updated potential value of a cell,
 //   given its neighbors' values
@@ -205,7 +223,7 @@ inline void DijkstraExpansion::updateCell(unsigned char* costs, float* potential
         float re = INVSQRT2 * (float)getCost(costs, n + 1);
         float ue = INVSQRT2 * (float)getCost(costs, n - nx_);
         float de = INVSQRT2 * (float)getCost(costs, n + nx_);
-        potential[n] = pot;
+        setPotential(potential, n, pot);
         //ROS_INFO("UPDATE %d %d %d %f", n, n%nx, n/nx, potential[n]);
         if (pot < threshold_)    // low-cost buffer block
                 {
@@ -42,27 +42,10 @@
 
 namespace global_planner {
 
+const int GradientPath::GRADIENT_WINDOW;
+
 GradientPath::GradientPath(PotentialCalculator* p_calc) :
         Traceback(p_calc), pathStep_(0.5) {
-    gradx_ = grady_ = NULL;
-}
-
-GradientPath::~GradientPath() {
-
-    if (gradx_)
-        delete[] gradx_;
-    if (grady_)
-        delete[] grady_;
-}
-
-void GradientPath::setSize(int xs, int ys) {
-    Traceback::setSize(xs, ys);
-    if (gradx_)
-        delete[] gradx_;
-    if (grady_)
-        delete[] grady_;
-    gradx_ = new float[xs * ys];
-    grady_ = new float[xs * ys];
 }
 
 bool GradientPath::getPath(float* potential, double start_x, double start_y, double goal_x, double goal_y, std::vector<std::pair<float, float> >& path) {
@@ -73,8 +56,7 @@ bool GradientPath::getPath(float* potential, double start_x, double start_y, dou
     float dx = goal_x - (int)goal_x;
     float dy = goal_y - (int)goal_y;
     int ns = xs_ * ys_;
-    memset(gradx_, 0, ns * sizeof(float));
-    memset(grady_, 0, ns * sizeof(float));
+    std::fill(grad_cell_, grad_cell_ + GRADIENT_WINDOW * GRADIENT_WINDOW, -1);
 
     int c = 0;
     while (c++<ns*4) {
@@ -183,18 +165,20 @@ bool GradientPath::getPath(float* potential, double start_x, double start_y, dou
             gradCell(potential, stc + 1);
             gradCell(potential, stcnx);
             gradCell(potential, stcnx + 1);
+            int g00 = getGradientSlot(stc), g01 = getGradientSlot(stc + 1);
+            int g10 = getGradientSlot(stcnx), g11 = getGradientSlot(stcnx + 1);
 
             // get interpolated gradient
-            float x1 = (1.0 - dx) * gradx_[stc] + dx * gradx_[stc + 1];
-            float x2 = (1.0 - dx) * gradx_[stcnx] + dx * gradx_[stcnx + 1];
+            float x1 = (1.0 - dx) * gradx_[g00] + dx * gradx_[g01];
+            float x2 = (1.0 - dx) * gradx_[g10] + dx * gradx_[g11];
             float x = (1.0 - dy) * x1 + dy * x2; // interpolated x
-            float y1 = (1.0 - dx) * grady_[stc] + dx * grady_[stc + 1];
-            float y2 = (1.0 - dx) * grady_[stcnx] + dx * grady_[stcnx + 1];
+            float y1 = (1.0 - dx) * grady_[g00] + dx * grady_[g01];
+            float y2 = (1.0 - dx) * grady_[g10] + dx * grady_[g11];
             float y = (1.0 - dy) * y1 + dy * y2; // interpolated y
 
             // show gradients
             ROS_DEBUG(
-                    "[Path] %0.2f,%0.2f  %0.2f,%0.2f  %0.2f,%0.2f  %0.2f,%0.2f; final x=%.3f, y=%.3f\n", gradx_[stc], grady_[stc], gradx_[stc+1], grady_[stc+1], gradx_[stcnx], grady_[stcnx], gradx_[stcnx+1], grady_[stcnx+1], x, y);
+                    "[Path] %0.2f,%0.2f  %0.2f,%0.2f  %0.2f,%0.2f  %0.2f,%0.2f; final x=%.3f, y=%.3f\n", gradx_[g00], grady_[g00], gradx_[g01], grady_[g01], gradx_[g10], grady_[g10], gradx_[g11], grady_[g11], x, y);
 
             // check for zero gradient, failed
             if (x == 0.0 && y == 0.0) {
@@ -264,9 +248,13 @@ bool GradientPath::getPath(float* potential, double start_x, double start_y, dou
 // calculate gradient at a cell
 // positive value are to the right and down
 float GradientPath::gradCell(float* potential, int n) {
-    if (gradx_[n] + grady_[n] > 0.0)    // check this cell
+    int slot = getGradientSlot(n);
+    if (grad_cell_[slot] == n)    // check this cell
         return 1.0;
 
+    grad_cell_[slot] = n;
+    gradx_[slot] = grady_[slot] = 0.0;
+
     if (n < xs_ || n > xs_ * ys_ - xs_)    // would be out of bounds
         return 0.0;
     float cv = potential[n];
@@ -305,8 +293,8 @@ float GradientPath::gradCell(float* potential, int n) {
     float norm = hypot(dx, dy);
     if (norm > 0) {
         norm = 1.0 / norm;
-        gradx_[n] = norm * dx;
-        grady_[n] = norm * dy;
+        gradx_[slot] = norm * dx;
+        grady_[slot] = norm * dy;
     }
     return norm;
 }
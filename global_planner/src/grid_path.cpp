@@ -36,11 +36,21 @@
  *         David V. Lu!!
  *********************************************************************/
 #include <global_planner/grid_path.h>
+#include <global_planner/compact_potential.h>
 #include <algorithm>
 #include <stdio.h>
 namespace global_planner {
 
 bool GridPath::getPath(float* potential, double start_x, double start_y, double end_x, double end_y, std::vector<std::pair<float, float> >& path) {
+    return descend(potential, start_x, start_y, end_x, end_y, path);
+}
+
+bool GridPath::getPath(const CompactPotential& potential, double start_x, double start_y, double end_x, double end_y, std::vector<std::pair<float, float> >& path) {
+    return descend(potential, start_x, start_y, end_x, end_y, path);
+}
+
+template<typename Potential>
+bool GridPath::descend(const Potential& potential, double start_x, double start_y, double end_x, double end_y, std::vector<std::pair<float, float> >& path) {
     std::pair<float, float> current;
     current.first = end_x;
     current.second = end_y;
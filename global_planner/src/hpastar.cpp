@@ -0,0 +1,405 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/hpastar.h>
+#include <global_planner/astar.h>
+#include <costmap_2d/cost_values.h>
+#include <algorithm>
+#include <queue>
+#include <string.h>
+#include <stdlib.h>
+
+namespace global_planner {
+
+// runs of free cells at least this long get an entrance at both of their ends
+#define LONG_ENTRANCE 6
+
+HPAStarExpansion::HPAStarExpansion(PotentialCalculator* p_calc, Expander* refiner, int nx, int ny, int cluster_size,
+                                   int corridor_margin) :
+        Expander(p_calc, nx, ny), refiner_(refiner), cluster_size_(std::max(cluster_size, 2)),
+        corridor_margin_(std::max(corridor_margin, 0)), cnx_(0), cny_(0), needs_rebuild_(true) {
+    setSize(nx, ny);
+}
+
+HPAStarExpansion::~HPAStarExpansion() {
+    delete refiner_;
+}
+
+void HPAStarExpansion::setSize(int nx, int ny) {
+    refiner_->setSize(nx, ny);
+    // the planner sets the size before every plan, only a real change invalidates the clusters
+    if (nx == nx_ && ny == ny_ && !clusters_.empty())
+        return;
+
+    Expander::setSize(nx, ny);
+    cnx_ = (nx + cluster_size_ - 1) / cluster_size_;
+    cny_ = (ny + cluster_size_ - 1) / cluster_size_;
+    clusters_.assign(cnx_ * cny_, Cluster());
+    for (int cy = 0; cy < cny_; cy++)
+        for (int cx = 0; cx < cnx_; cx++) {
+            Cluster& cl = clusters_[cx + cy * cnx_];
+            cl.x0 = cx * cluster_size_;
+            cl.y0 = cy * cluster_size_;
+            cl.x1 = std::min(cl.x0 + cluster_size_, nx);
+            cl.y1 = std::min(cl.y0 + cluster_size_, ny);
+        }
+
+    changed_.assign(clusters_.size(), 0);
+    corridor_costs_.assign(ns_, costmap_2d::LETHAL_OBSTACLE);
+    corridor_.clear();
+    local_dist_.resize(cluster_size_ * cluster_size_);
+    needs_rebuild_ = true;
+}
+
+bool HPAStarExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x,
+                                           double end_y, int cycles, float* potential) {
+    cells_visited_ = 0;
+
+    updateClusters(costs);
+
+    std::vector<int> path_clusters;
+    if (!searchAbstract(costs, toIndex(start_x, start_y), toIndex(end_x, end_y), path_clusters)) {
+        refiner_->resetPotential();
+        return false;
+    }
+    setCorridor(costs, path_clusters);
+
+    refiner_->setLethalCost(lethal_cost_);
+    refiner_->setNeutralCost(neutral_cost_);
+    refiner_->setFactor(factor_);
+    refiner_->setHasUnknown(unknown_);
+    bool found = refiner_->calculatePotentials(&corridor_costs_[0], start_x, start_y, end_x, end_y, cycles, potential);
+    cells_visited_ = refiner_->getCellsVisited();
+    if (!found) {
+        // the abstract path is only an estimate of the refiner's costs, if the corridor is not
+        // good enough the plan is still found on the whole map
+        found = refiner_->calculatePotentials(costs, start_x, start_y, end_x, end_y, cycles, potential);
+        cells_visited_ += refiner_->getCellsVisited();
+    }
+    return found;
+}
+
+void HPAStarExpansion::markChanged(int x0, int y0, int xn, int yn) {
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    xn = std::min(xn, nx_);
+    yn = std::min(yn, ny_);
+    if (xn <= x0 || yn <= y0)
+        return;
+    for (int cy = y0 / cluster_size_; cy <= (yn - 1) / cluster_size_; cy++)
+        for (int cx = x0 / cluster_size_; cx <= (xn - 1) / cluster_size_; cx++)
+            changed_[cx + cy * cnx_] = 1;
+}
+
+void HPAStarExpansion::updateClusters(unsigned char* costs) {
+    if (lethal_cost_ != last_lethal_cost_ || neutral_cost_ != last_neutral_cost_ || factor_ != last_factor_
+            || unknown_ != last_unknown_)
+        needs_rebuild_ = true;
+
+    std::vector<char> dirty(clusters_.size(), 1);
+    if (!needs_rebuild_)
+        dirty.swap(changed_);
+    changed_.assign(clusters_.size(), 0);
+
+    // the entrances on the border of a changed cluster also belong to its neighbors
+    std::vector<char> rebuild(dirty);
+    for (int cy = 0; cy < cny_; cy++)
+        for (int cx = 0; cx < cnx_; cx++) {
+            if (!dirty[cx + cy * cnx_])
+                continue;
+            if (cx > 0)
+                rebuild[cx - 1 + cy * cnx_] = 1;
+            if (cx < cnx_ - 1)
+                rebuild[cx + 1 + cy * cnx_] = 1;
+            if (cy > 0)
+                rebuild[cx + (cy - 1) * cnx_] = 1;
+            if (cy < cny_ - 1)
+                rebuild[cx + (cy + 1) * cnx_] = 1;
+        }
+
+    for (unsigned int c = 0; c < clusters_.size(); c++)
+        if (rebuild[c])
+            buildNodes(costs, c);
+    for (unsigned int c = 0; c < clusters_.size(); c++)
+        if (rebuild[c])
+            buildEdges(costs, c);
+
+    last_lethal_cost_ = lethal_cost_;
+    last_neutral_cost_ = neutral_cost_;
+    last_factor_ = factor_;
+    last_unknown_ = unknown_;
+    needs_rebuild_ = false;
+}
+
+//
+// Entrances between cluster a and its right or upper neighbor b, as pairs of
+// a cell in a and the adjacent cell in b. Both clusters get the same pairs.
+//
+void HPAStarExpansion::findEntrances(unsigned char* costs, int a, int b, std::vector<std::pair<int, int> >& entrances) {
+    const Cluster& ca = clusters_[a];
+    bool vertical = clusters_[b].y0 == ca.y0;
+    int length = vertical ? ca.y1 - ca.y0 : ca.x1 - ca.x0;
+    int first = vertical ? toIndex(ca.x1 - 1, ca.y0) : toIndex(ca.x0, ca.y1 - 1);
+    int step = vertical ? nx_ : 1;
+    int across = vertical ? 1 : nx_;
+
+    entrances.clear();
+    int run = -1;
+    for (int i = 0; i <= length; i++) {
+        int n = first + i * step;
+        bool open = i < length && getCost(costs, n) < lethal_cost_ && getCost(costs, n + across) < lethal_cost_;
+        if (open && run < 0)
+            run = i;
+        else if (!open && run >= 0) {
+            if (i - run >= LONG_ENTRANCE) {
+                entrances.push_back(std::make_pair(first + run * step, first + run * step + across));
+                entrances.push_back(std::make_pair(first + (i - 1) * step, first + (i - 1) * step + across));
+            } else {
+                int mid = first + (run + i - 1) / 2 * step;
+                entrances.push_back(std::make_pair(mid, mid + across));
+            }
+            run = -1;
+        }
+    }
+}
+
+void HPAStarExpansion::buildNodes(unsigned char* costs, int c) {
+    int cx = c % cnx_, cy = c / cnx_;
+    std::vector<int>& nodes = clusters_[c].nodes;
+    nodes.clear();
+
+    std::vector<std::pair<int, int> > entrances;
+    for (int side = 0; side < 4; side++) {
+        if ((side == 0 && cx == 0) || (side == 1 && cx == cnx_ - 1) || (side == 2 && cy == 0)
+                || (side == 3 && cy == cny_ - 1))
+            continue;
+        if (side == 0)
+            findEntrances(costs, c - 1, c, entrances);
+        else if (side == 1)
+            findEntrances(costs, c, c + 1, entrances);
+        else if (side == 2)
+            findEntrances(costs, c - cnx_, c, entrances);
+        else
+            findEntrances(costs, c, c + cnx_, entrances);
+
+        for (unsigned int i = 0; i < entrances.size(); i++) {
+            int n = (side == 0 || side == 2) ? entrances[i].second : entrances[i].first;
+            if (std::find(nodes.begin(), nodes.end(), n) == nodes.end())
+                nodes.push_back(n);
+        }
+    }
+}
+
+void HPAStarExpansion::buildEdges(unsigned char* costs, int c) {
+    Cluster& cl = clusters_[c];
+    int k = cl.nodes.size();
+    cl.dist.resize(k * k);
+    for (int i = 0; i < k; i++) {
+        searchCluster(costs, c, cl.nodes[i]);
+        for (int j = 0; j < k; j++)
+            cl.dist[i * k + j] = localDistance(c, cl.nodes[j]);
+    }
+}
+
+//
+// Dijkstra search from a cell that does not leave its cluster, with the
+// cost of a step being the cost of the cell it enters
+//
+void HPAStarExpansion::searchCluster(unsigned char* costs, int c, int source) {
+    const Cluster& cl = clusters_[c];
+    int w = cl.x1 - cl.x0, h = cl.y1 - cl.y0;
+    std::fill(local_dist_.begin(), local_dist_.begin() + w * h, POT_HIGH);
+
+    std::priority_queue<std::pair<float, int>, std::vector<std::pair<float, int> >, std::greater<std::pair<float, int> > > queue;
+    int l = (source % nx_ - cl.x0) + (source / nx_ - cl.y0) * w;
+    local_dist_[l] = 0;
+    queue.push(std::make_pair(0.0f, l));
+
+    while (!queue.empty()) {
+        float d = queue.top().first;
+        l = queue.top().second;
+        queue.pop();
+        if (d > local_dist_[l])
+            continue;
+
+        int x = l % w, y = l / w;
+        for (int i = 0; i < 4; i++) {
+            int x2 = x + (i == 0) - (i == 1), y2 = y + (i == 2) - (i == 3);
+            if (x2 < 0 || x2 >= w || y2 < 0 || y2 >= h)
+                continue;
+            float cost = getCost(costs, toIndex(cl.x0 + x2, cl.y0 + y2));
+            if (cost >= lethal_cost_)
+                continue;
+            int l2 = x2 + y2 * w;
+            if (d + cost < local_dist_[l2]) {
+                local_dist_[l2] = d + cost;
+                queue.push(std::make_pair(d + cost, l2));
+            }
+        }
+    }
+}
+
+//
+// A* over the entrances, with the start and goal cells as extra nodes that are
+// connected to the entrances of their clusters. Returns the clusters the path
+// passes through.
+//
+bool HPAStarExpansion::searchAbstract(unsigned char* costs, int start_i, int goal_i, std::vector<int>& path_clusters) {
+    int num_clusters = clusters_.size();
+    offsets_.resize(num_clusters + 1);
+    offsets_[0] = 0;
+    for (int c = 0; c < num_clusters; c++)
+        offsets_[c + 1] = offsets_[c] + clusters_[c].nodes.size();
+    int start_node = offsets_[num_clusters], goal_node = start_node + 1;
+
+    int start_cluster = clusterOf(start_i), goal_cluster = clusterOf(goal_i);
+    const Cluster& sc = clusters_[start_cluster];
+    const Cluster& gc = clusters_[goal_cluster];
+
+    searchCluster(costs, start_cluster, start_i);
+    std::vector<float> start_dist(sc.nodes.size());
+    for (unsigned int j = 0; j < sc.nodes.size(); j++)
+        start_dist[j] = localDistance(start_cluster, sc.nodes[j]);
+    float direct = start_cluster == goal_cluster ? localDistance(start_cluster, goal_i) : POT_HIGH;
+
+    searchCluster(costs, goal_cluster, goal_i);
+    std::vector<float> goal_dist(gc.nodes.size());
+    for (unsigned int j = 0; j < gc.nodes.size(); j++)
+        goal_dist[j] = localDistance(goal_cluster, gc.nodes[j]);
+
+    g_.assign(goal_node + 1, POT_HIGH);
+    parent_.assign(goal_node + 1, -1);
+    std::vector<Index> queue;
+    int gx = goal_i % nx_, gy = goal_i / nx_;
+
+#define RELAX(to, to_cell, cost) { \
+        float g = g_[u] + (cost); \
+        if (g < g_[to]) { \
+            g_[to] = g; \
+            parent_[to] = u; \
+            queue.push_back(Index(to, g + neutral_cost_ * (abs((to_cell) % nx_ - gx) + abs((to_cell) / nx_ - gy)))); \
+            std::push_heap(queue.begin(), queue.end(), greater1()); \
+        } }
+
+    g_[start_node] = 0;
+    queue.push_back(Index(start_node, 0));
+    while (!queue.empty()) {
+        Index top = queue[0];
+        std::pop_heap(queue.begin(), queue.end(), greater1());
+        queue.pop_back();
+        int u = top.i;
+        if (u == goal_node)
+            break;
+
+        if (u == start_node) {
+            for (unsigned int j = 0; j < sc.nodes.size(); j++)
+                if (start_dist[j] < POT_HIGH)
+                    RELAX(offsets_[start_cluster] + j, sc.nodes[j], start_dist[j]);
+            if (direct < POT_HIGH)
+                RELAX(goal_node, goal_i, direct);
+            continue;
+        }
+
+        int c = std::upper_bound(offsets_.begin(), offsets_.end(), u) - offsets_.begin() - 1;
+        const Cluster& cl = clusters_[c];
+        int j = u - offsets_[c], k = cl.nodes.size();
+        int n = cl.nodes[j];
+
+        for (int i = 0; i < k; i++)
+            if (i != j && cl.dist[j * k + i] < POT_HIGH)
+                RELAX(offsets_[c] + i, cl.nodes[i], cl.dist[j * k + i]);
+
+        // entrances come in pairs of adjacent cells in neighboring clusters
+        int x = n % nx_, y = n / nx_;
+        int neighbors[4] = { x > 0 ? n - 1 : -1, x < nx_ - 1 ? n + 1 : -1, y > 0 ? n - nx_ : -1,
+                             y < ny_ - 1 ? n + nx_ : -1 };
+        for (int i = 0; i < 4; i++) {
+            int m = neighbors[i];
+            if (m < 0 || clusterOf(m) == c)
+                continue;
+            int c2 = clusterOf(m);
+            const std::vector<int>& nodes = clusters_[c2].nodes;
+            std::vector<int>::const_iterator it = std::find(nodes.begin(), nodes.end(), m);
+            if (it != nodes.end())
+                RELAX(offsets_[c2] + (it - nodes.begin()), m, getCost(costs, m));
+        }
+
+        if (c == goal_cluster && goal_dist[j] < POT_HIGH)
+            RELAX(goal_node, goal_i, goal_dist[j]);
+    }
+#undef RELAX
+
+    if (g_[goal_node] >= POT_HIGH)
+        return false;
+
+    path_clusters.clear();
+    path_clusters.push_back(goal_cluster);
+    for (int u = parent_[goal_node]; u >= 0 && u != start_node; u = parent_[u])
+        path_clusters.push_back(std::upper_bound(offsets_.begin(), offsets_.end(), u) - offsets_.begin() - 1);
+    path_clusters.push_back(start_cluster);
+    return true;
+}
+
+void HPAStarExpansion::setCorridor(unsigned char* costs, const std::vector<int>& path_clusters) {
+    for (unsigned int i = 0; i < corridor_.size(); i++) {
+        const Cluster& cl = clusters_[corridor_[i]];
+        for (int y = cl.y0; y < cl.y1; y++)
+            memset(&corridor_costs_[toIndex(cl.x0, y)], costmap_2d::LETHAL_OBSTACLE, cl.x1 - cl.x0);
+    }
+
+    std::vector<char> in_corridor(clusters_.size(), 0);
+    corridor_.clear();
+    for (unsigned int i = 0; i < path_clusters.size(); i++) {
+        int cx = path_clusters[i] % cnx_, cy = path_clusters[i] / cnx_;
+        for (int y = std::max(cy - corridor_margin_, 0); y <= std::min(cy + corridor_margin_, cny_ - 1); y++)
+            for (int x = std::max(cx - corridor_margin_, 0); x <= std::min(cx + corridor_margin_, cnx_ - 1); x++) {
+                int c = x + y * cnx_;
+                if (in_corridor[c])
+                    continue;
+                in_corridor[c] = 1;
+                corridor_.push_back(c);
+            }
+    }
+
+    for (unsigned int i = 0; i < corridor_.size(); i++) {
+        const Cluster& cl = clusters_[corridor_[i]];
+        for (int y = cl.y0; y < cl.y1; y++)
+            memcpy(&corridor_costs_[toIndex(cl.x0, y)], costs + toIndex(cl.x0, y), cl.x1 - cl.x0);
+    }
+}
+
+} //end namespace global_planner
@@ -0,0 +1,150 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/landmark_heuristic.h>
+#include <costmap_2d/cost_values.h>
+#include <stdlib.h>
+#include <algorithm>
+
+namespace global_planner {
+
+const uint16_t LandmarkHeuristic::UNREACHED;
+
+LandmarkHeuristic::LandmarkHeuristic(unsigned int num_landmarks) :
+        num_landmarks_(num_landmarks), nx_(0), ny_(0) {
+}
+
+bool LandmarkHeuristic::update(const unsigned char* costs, int nx, int ny) {
+    int ns = nx * ny;
+    bool changed = nx != nx_ || ny != ny_;
+    if (changed)
+        blocked_.assign(ns, 0);
+    for (int i = 0; i < ns; i++) {
+        unsigned char blocked = costs[i] == costmap_2d::LETHAL_OBSTACLE;
+        if (blocked != blocked_[i]) {
+            blocked_[i] = blocked;
+            changed = true;
+        }
+    }
+    if (!changed)
+        return false;
+
+    nx_ = nx;
+    ny_ = ny;
+    landmarks_.clear();
+    tables_.clear();
+    scales_.clear();
+
+    int first = std::find(blocked_.begin(), blocked_.end(), 0) - blocked_.begin();
+    if (num_landmarks_ == 0 || first == ns)
+        return true;
+
+    // the first landmark is the cell farthest from the first free cell, every next one the farthest from all landmarks so far
+    std::vector<int> distance;
+    std::vector<int> nearest(ns, -1);
+    computeDistances(first, distance);
+    int landmark = std::max_element(distance.begin(), distance.end()) - distance.begin();
+
+    while (landmarks_.size() < num_landmarks_) {
+        computeDistances(landmark, distance);
+
+        int max_distance = *std::max_element(distance.begin(), distance.end());
+        int scale = max_distance / (UNREACHED - 1) + 1;
+        std::vector<uint16_t> table(ns, UNREACHED);
+        for (int i = 0; i < ns; i++) {
+            if (distance[i] < 0)
+                continue;
+            table[i] = distance[i] / scale;
+            if (nearest[i] < 0 || distance[i] < nearest[i])
+                nearest[i] = distance[i];
+        }
+        landmarks_.push_back(landmark);
+        tables_.push_back(table);
+        scales_.push_back(scale);
+
+        landmark = std::max_element(nearest.begin(), nearest.end()) - nearest.begin();
+        if (nearest[landmark] <= 0)
+            break;
+    }
+    goal_entries_.assign(landmarks_.size(), UNREACHED);
+    return true;
+}
+
+void LandmarkHeuristic::computeDistances(int landmark, std::vector<int>& distance) {
+    distance.assign(nx_ * ny_, -1);
+    queue_.clear();
+    queue_.push_back(landmark);
+    distance[landmark] = 0;
+
+    for (unsigned int head = 0; head < queue_.size(); head++) {
+        int i = queue_[head];
+        int x = i % nx_, y = i / nx_;
+        int neighbors[4] = { x > 0 ? i - 1 : -1, x < nx_ - 1 ? i + 1 : -1, y > 0 ? i - nx_ : -1, y < ny_ - 1 ? i + nx_ : -1 };
+        for (int k = 0; k < 4; k++) {
+            int n = neighbors[k];
+            if (n < 0 || blocked_[n] || distance[n] >= 0)
+                continue;
+            distance[n] = distance[i] + 1;
+            queue_.push_back(n);
+        }
+    }
+}
+
+void LandmarkHeuristic::setGoal(int goal) {
+    for (unsigned int k = 0; k < landmarks_.size(); k++)
+        goal_entries_[k] = tables_[k][goal];
+}
+
+float LandmarkHeuristic::getDistance(int n) const {
+    int best = 0;
+    for (unsigned int k = 0; k < landmarks_.size(); k++) {
+        int goal_entry = goal_entries_[k], entry = tables_[k][n];
+        if (goal_entry == UNREACHED || entry == UNREACHED)
+            continue;
+        // with the entries rounded down, the distances can be up to scale - 1 closer than the entries tell
+        best = std::max(best, abs(goal_entry - entry) * scales_[k] - (scales_[k] - 1));
+    }
+    return best;
+}
+
+int LandmarkHeuristic::getMaxStep() const {
+    if (scales_.empty())
+        return 1;
+    return *std::max_element(scales_.begin(), scales_.end());
+}
+
+} //end namespace global_planner
@@ -0,0 +1,236 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/lattice_planner.h>
+#include <pluginlib/class_list_macros.h>
+#include <tf/transform_datatypes.h>
+#include <tf/transform_listener.h>
+#include <costmap_2d/inflation_layer.h>
+#include <nav_msgs/Path.h>
+#include <math.h>
+
+//register this planner as a BaseGlobalPlanner plugin
+PLUGINLIB_EXPORT_CLASS(global_planner::LatticePlanner, nav_core::BaseGlobalPlanner)
+
+namespace global_planner {
+
+LatticePlanner::LatticePlanner() :
+        costmap_(NULL), initialized_(false), search_(primitives_) {
+}
+
+LatticePlanner::LatticePlanner(std::string name, costmap_2d::Costmap2D* costmap, std::string frame_id,
+                               const std::vector<geometry_msgs::Point>& footprint) :
+        costmap_(NULL), initialized_(false), search_(primitives_) {
+    //initialize the planner
+    initialize(name, costmap, frame_id, footprint);
+}
+
+LatticePlanner::~LatticePlanner() {
+}
+
+void LatticePlanner::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros) {
+    initialize(name, costmap_ros->getCostmap(), costmap_ros->getGlobalFrameID(), costmap_ros->getRobotFootprint());
+
+    // the footprint can only touch an obstacle if the cell under its center, which may be up to half a cell
+    // diagonal away, is inflated at least as much as the circumscribed radius plus another half diagonal
+    double resolution = costmap_->getResolution();
+    double reach = costmap_ros->getLayeredCostmap()->getCircumscribedRadius() + M_SQRT2 * resolution;
+    std::vector<boost::shared_ptr<costmap_2d::Layer> >* plugins = costmap_ros->getLayeredCostmap()->getPlugins();
+    for (unsigned int i = 0; i < plugins->size(); i++) {
+        costmap_2d::InflationLayer* inflation = dynamic_cast<costmap_2d::InflationLayer*>((*plugins)[i].get());
+        if (!inflation)
+            continue;
+        double inflation_radius;
+        ros::NodeHandle("~/" + inflation->getName()).param("inflation_radius", inflation_radius, 0.55);
+        if (inflation_radius >= reach) {
+            search_.setMaskThreshold(inflation->computeCost(reach / resolution));
+            return;
+        }
+    }
+    ROS_WARN("The costmap is not inflated beyond the circumscribed radius, the footprint is checked at every step");
+}
+
+void LatticePlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap, std::string frame_id,
+                                const std::vector<geometry_msgs::Point>& footprint) {
+    if (!initialized_) {
+        ros::NodeHandle private_nh("~/" + name);
+        costmap_ = costmap;
+        frame_id_ = frame_id;
+        footprint_ = footprint;
+
+        private_nh.param("min_turning_radius", turning_radius_, 1.0);
+        private_nh.param("primitive_length", primitive_length_, 0.4);
+        private_nh.param("allow_reverse", allow_reverse_, false);
+        private_nh.param("heuristic_table_radius", heuristic_table_radius_, 2.0);
+        private_nh.param("default_tolerance", default_tolerance_, 0.0);
+
+        double turn_penalty, reverse_penalty, cost_factor, epsilon;
+        private_nh.param("turn_penalty", turn_penalty, 1.2);
+        private_nh.param("reverse_penalty", reverse_penalty, 3.0);
+        private_nh.param("cost_factor", cost_factor, 3.0);
+        search_.setPenalties(turn_penalty, reverse_penalty, cost_factor);
+        private_nh.param("epsilon", epsilon, 1.0);
+        search_.setEpsilon(epsilon);
+
+        bool allow_unknown;
+        int max_expansions;
+        private_nh.param("allow_unknown", allow_unknown, true);
+        search_.setHasUnknown(allow_unknown);
+        private_nh.param("max_expansions", max_expansions, 500000);
+        search_.setMaxExpansions(max_expansions);
+
+        generatePrimitives();
+
+        plan_pub_ = private_nh.advertise<nav_msgs::Path>("plan", 1);
+
+        //get the tf prefix
+        ros::NodeHandle prefix_nh;
+        tf_prefix_ = tf::getPrefixParam(prefix_nh);
+
+        initialized_ = true;
+    } else
+        ROS_WARN("This planner has already been initialized, you can't call it twice, doing nothing");
+}
+
+void LatticePlanner::generatePrimitives() {
+    ros::WallTime begin = ros::WallTime::now();
+    primitives_.generate(costmap_->getResolution(), turning_radius_, primitive_length_, allow_reverse_, footprint_);
+    search_.computeHeuristicTable(heuristic_table_radius_);
+    ROS_DEBUG("Generated the motion primitives and the heuristic table in %.1f ms",
+              (ros::WallTime::now() - begin).toSec() * 1000);
+}
+
+bool LatticePlanner::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                              std::vector<geometry_msgs::PoseStamped>& plan) {
+    return makePlan(start, goal, default_tolerance_, plan);
+}
+
+bool LatticePlanner::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                              double tolerance, std::vector<geometry_msgs::PoseStamped>& plan) {
+    boost::mutex::scoped_lock lock(mutex_);
+    if (!initialized_) {
+        ROS_ERROR(
+                "This planner has not been initialized yet, but it is being used, please call initialize() before use");
+        return false;
+    }
+
+    //clear the plan, just in case
+    plan.clear();
+
+    //until tf can handle transforming things that are way in the past... we'll require the goal to be in our global frame
+    if (tf::resolve(tf_prefix_, goal.header.frame_id) != tf::resolve(tf_prefix_, frame_id_)) {
+        ROS_ERROR(
+                "The goal pose passed to this planner must be in the %s frame.  It is instead in the %s frame.", tf::resolve(tf_prefix_, frame_id_).c_str(), tf::resolve(tf_prefix_, goal.header.frame_id).c_str());
+        return false;
+    }
+
+    if (tf::resolve(tf_prefix_, start.header.frame_id) != tf::resolve(tf_prefix_, frame_id_)) {
+        ROS_ERROR(
+                "The start pose passed to this planner must be in the %s frame.  It is instead in the %s frame.", tf::resolve(tf_prefix_, frame_id_).c_str(), tf::resolve(tf_prefix_, start.header.frame_id).c_str());
+        return false;
+    }
+
+    unsigned int start_x, start_y, goal_x, goal_y;
+    if (!costmap_->worldToMap(start.pose.position.x, start.pose.position.y, start_x, start_y)) {
+        ROS_WARN(
+                "The robot's start position is off the global costmap. Planning will always fail, are you sure the robot has been properly localized?");
+        return false;
+    }
+    if (!costmap_->worldToMap(goal.pose.position.x, goal.pose.position.y, goal_x, goal_y)) {
+        ROS_WARN_THROTTLE(1.0,
+                "The goal sent to the planner is off the global costmap. Planning will always fail to this goal.");
+        return false;
+    }
+
+    // the primitives are made for one resolution
+    double resolution = costmap_->getResolution();
+    if (resolution != primitives_.getResolution())
+        generatePrimitives();
+
+    int start_heading = MotionPrimitives::getHeading(tf::getYaw(start.pose.orientation));
+    int goal_heading = MotionPrimitives::getHeading(tf::getYaw(goal.pose.orientation));
+    std::vector<LatticeStep> path;
+    bool found = search_.search(costmap_->getCharMap(), costmap_->getSizeInCellsX(), costmap_->getSizeInCellsY(),
+                                start_x, start_y, start_heading, goal_x, goal_y, goal_heading, tolerance / resolution,
+                                path);
+    ROS_DEBUG("Expanded %d lattice states", search_.getExpansions());
+    if (!found) {
+        ROS_ERROR("Failed to get a plan.");
+        return false;
+    }
+
+    ros::Time plan_time = ros::Time::now();
+    geometry_msgs::PoseStamped pose = start;
+    pose.header.stamp = plan_time;
+    plan.push_back(pose);
+    for (unsigned int i = 0; i < path.size(); i++) {
+        const std::vector<LatticePose>& poses = path[i].primitive->poses;
+        for (unsigned int j = 0; j < poses.size(); j++) {
+            pose.pose.position.x = costmap_->getOriginX() + (path[i].x + 0.5 + poses[j].x) * resolution;
+            pose.pose.position.y = costmap_->getOriginY() + (path[i].y + 0.5 + poses[j].y) * resolution;
+            pose.pose.orientation = tf::createQuaternionMsgFromYaw(poses[j].theta);
+            plan.push_back(pose);
+        }
+    }
+
+    // within the tolerance the plan ends where the lattice reached, not at the goal
+    int end_x = start_x, end_y = start_y;
+    if (!path.empty()) {
+        end_x = path.back().x + path.back().primitive->dx;
+        end_y = path.back().y + path.back().primitive->dy;
+    }
+    if (end_x == (int) goal_x && end_y == (int) goal_y) {
+        geometry_msgs::PoseStamped goal_copy = goal;
+        goal_copy.header.stamp = plan_time;
+        plan.push_back(goal_copy);
+    }
+
+    //publish the plan for visualization purposes
+    publishPlan(plan);
+    return true;
+}
+
+void LatticePlanner::publishPlan(const std::vector<geometry_msgs::PoseStamped>& path) {
+    //create a message for the plan
+    nav_msgs::Path gui_path;
+    gui_path.header.frame_id = frame_id_;
+    gui_path.header.stamp = ros::Time::now();
+    gui_path.poses = path;
+    plan_pub_.publish(gui_path);
+}
+
+} //end namespace global_planner
@@ -0,0 +1,364 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/lattice_search.h>
+#include <costmap_2d/cost_values.h>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <math.h>
+
+namespace global_planner {
+
+typedef std::pair<float, int> QueueEntry;
+typedef std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry> > Queue;
+
+static const int NUM_HEADINGS = MotionPrimitives::NUM_HEADINGS;
+
+// the moves of the 16-connected distances: the 8 neighbors and the knight moves in between
+static const int MOVE_X[16] = {1, 2, 1, 1, 0, -1, -1, -2, -1, -2, -1, -1, 0, 1, 1, 2};
+static const int MOVE_Y[16] = {0, 1, 1, 2, 1, 2, 1, 1, 0, -1, -1, -2, -1, -2, -1, -1};
+
+LatticeSearch::LatticeSearch(const MotionPrimitives& primitives) :
+        primitives_(primitives), turn_penalty_(1.0), reverse_penalty_(1.0), cost_factor_(0.0), unknown_(true),
+        mask_threshold_(0), epsilon_(1.0f), max_expansions_(0), expansions_(0), cost_(0.0), nx_(0), ny_(0), start_x_(0), start_y_(0), goal_x_(0), goal_y_(0),
+        goal_heading_(0), tolerance_(0.0), use_table_(false), horizon_(0.0), table_radius_(0) {
+}
+
+void LatticeSearch::setPenalties(double turn_penalty, double reverse_penalty, double cost_factor) {
+    turn_penalty_ = std::max(1.0, turn_penalty);
+    reverse_penalty_ = std::max(1.0, reverse_penalty);
+    cost_factor_ = std::max(0.0, cost_factor);
+}
+
+float LatticeSearch::penalty(const MotionPrimitive& primitive) const {
+    if (primitive.reverse)
+        return reverse_penalty_;
+    return primitive.turn ? turn_penalty_ : 1.0;
+}
+
+void LatticeSearch::computeHeuristicTable(double radius) {
+    table_.clear();
+    table_radius_ = 0;
+    if (radius <= 0.0 || primitives_.getResolution() <= 0.0)
+        return;
+
+    // search a margin beyond the table, so that paths which swing wide are not cut off at its border
+    int reach = 0;
+    for (int h = 0; h < NUM_HEADINGS; h++) {
+        const std::vector<MotionPrimitive>& p = primitives_.getPrimitives(h);
+        for (unsigned int k = 0; k < p.size(); k++)
+            reach = std::max(reach, std::max(abs(p[k].dx), abs(p[k].dy)));
+    }
+    table_radius_ = (int) ceil(radius / primitives_.getResolution());
+    int outer = table_radius_ + 2 * reach;
+    int size = 2 * table_radius_ + 1, outer_size = 2 * outer + 1;
+    table_.assign(NUM_HEADINGS / 4 * size * size * NUM_HEADINGS, -1.0f);
+
+    std::vector<float> g(outer_size * outer_size * NUM_HEADINGS);
+    for (int start = 0; start < NUM_HEADINGS / 4; start++) {
+        std::fill(g.begin(), g.end(), -1.0f);
+        Queue queue;
+        int s = (outer * outer_size + outer) * NUM_HEADINGS + start;
+        g[s] = 0.0f;
+        queue.push(QueueEntry(0.0f, s));
+        while (!queue.empty()) {
+            QueueEntry top = queue.top();
+            queue.pop();
+            if (top.first > g[top.second])
+                continue;
+            int h = top.second % NUM_HEADINGS, cell = top.second / NUM_HEADINGS;
+            int x = cell % outer_size, y = cell / outer_size;
+
+            const std::vector<MotionPrimitive>& p = primitives_.getPrimitives(h);
+            for (unsigned int k = 0; k < p.size(); k++) {
+                int nx = x + p[k].dx, ny = y + p[k].dy;
+                if (nx < 0 || nx >= outer_size || ny < 0 || ny >= outer_size)
+                    continue;
+                int n = (ny * outer_size + nx) * NUM_HEADINGS + p[k].end_heading;
+                float cost = top.first + p[k].length * penalty(p[k]);
+                if (g[n] < 0 || cost < g[n]) {
+                    g[n] = cost;
+                    queue.push(QueueEntry(cost, n));
+                }
+            }
+        }
+
+        for (int dy = -table_radius_; dy <= table_radius_; dy++)
+            for (int dx = -table_radius_; dx <= table_radius_; dx++)
+                for (int h = 0; h < NUM_HEADINGS; h++)
+                    table_[((start * size + dy + table_radius_) * size + dx + table_radius_) * NUM_HEADINGS + h] =
+                            g[((dy + outer) * outer_size + dx + outer) * NUM_HEADINGS + h];
+    }
+}
+
+float LatticeSearch::getTableCost(int start_heading, int dx, int dy, int end_heading) const {
+    if (table_.empty() || abs(dx) > table_radius_ || abs(dy) > table_radius_)
+        return -1.0f;
+
+    // rotate back to the first quadrant
+    for (int r = 0; r < start_heading / (NUM_HEADINGS / 4); r++) {
+        int x = dx;
+        dx = dy;
+        dy = -x;
+    }
+    end_heading = (end_heading - start_heading / (NUM_HEADINGS / 4) * (NUM_HEADINGS / 4) + NUM_HEADINGS) % NUM_HEADINGS;
+    int size = 2 * table_radius_ + 1;
+    return table_[(((start_heading % (NUM_HEADINGS / 4)) * size + dy + table_radius_) * size + dx + table_radius_)
+            * NUM_HEADINGS + end_heading];
+}
+
+bool LatticeSearch::blocked(unsigned char cost) const {
+    return cost >= costmap_2d::INSCRIBED_INFLATED_OBSTACLE && (cost != costmap_2d::NO_INFORMATION || !unknown_);
+}
+
+void LatticeSearch::computeDistances(const unsigned char* costs, int start_x, int start_y, int goal_x, int goal_y,
+                                     double tolerance) {
+    if ((int) distances_.size() != nx_ * ny_) {
+        distances_.assign(nx_ * ny_, -1.0f);
+        settled_.assign(nx_ * ny_, 0);
+        touched_.clear();
+    }
+    for (unsigned int i = 0; i < touched_.size(); i++) {
+        distances_[touched_[i]] = -1.0f;
+        settled_[touched_[i]] = 0;
+    }
+    touched_.clear();
+
+    double resolution = primitives_.getResolution();
+    float step[16];
+    for (int m = 0; m < 16; m++)
+        step[m] = hypot(MOVE_X[m], MOVE_Y[m]) * resolution;
+
+    // an A* from the goal towards the start, every cell within the tolerance of the goal is a goal
+    Queue queue;
+    int r = (int) tolerance;
+    for (int dy = -r; dy <= r; dy++)
+        for (int dx = -r; dx <= r; dx++) {
+            int x = goal_x + dx, y = goal_y + dy;
+            if (dx * dx + dy * dy > tolerance * tolerance || x < 0 || x >= nx_ || y < 0 || y >= ny_)
+                continue;
+            if (dx * dx + dy * dy > 0 && blocked(costs[y * nx_ + x]))
+                continue;
+            distances_[y * nx_ + x] = 0.0f;
+            touched_.push_back(y * nx_ + x);
+            queue.push(QueueEntry(hypot(x - start_x, y - start_y) * resolution, y * nx_ + x));
+        }
+
+    // the search goes on for a meter past the start to settle the cells a path may swing out to, a cell
+    // which is not settled by then is at least horizon_ minus its straight line distance to the start away
+    int start = start_y * nx_ + start_x;
+    float stop = -1.0f;
+    horizon_ = 0.0f;
+    while (!queue.empty()) {
+        QueueEntry top = queue.top();
+        if (stop >= 0 && top.first > stop)
+            break;
+        queue.pop();
+        int x = top.second % nx_, y = top.second / nx_;
+        if (settled_[top.second])
+            continue;
+        settled_[top.second] = 1;
+        horizon_ = top.first;
+        if (top.second == start)
+            stop = top.first + 1.0;
+
+        for (int m = 0; m < 16; m++) {
+            int x2 = x + MOVE_X[m], y2 = y + MOVE_Y[m];
+            if (x2 < 0 || x2 >= nx_ || y2 < 0 || y2 >= ny_)
+                continue;
+            int n = y2 * nx_ + x2;
+            if (settled_[n] || (blocked(costs[n]) && n != start))
+                continue;
+            float d = distances_[top.second] + step[m];
+            if (distances_[n] < 0) {
+                touched_.push_back(n);
+            } else if (d >= distances_[n]) {
+                continue;
+            }
+            distances_[n] = d;
+            queue.push(QueueEntry(d + hypot(x2 - start_x, y2 - start_y) * resolution, n));
+        }
+    }
+}
+
+float LatticeSearch::heuristic(int x, int y, int heading) const {
+    float h;
+    if (settled_[y * nx_ + x]) {
+        h = distances_[y * nx_ + x];
+    } else {
+        double resolution = primitives_.getResolution();
+        h = std::max(horizon_ - hypot(x - start_x_, y - start_y_) * resolution,
+                     (hypot(x - goal_x_, y - goal_y_) - tolerance_) * resolution);
+    }
+    if (use_table_)
+        h = std::max(h, getTableCost(heading, goal_x_ - x, goal_y_ - y, goal_heading_));
+    return h;
+}
+
+float LatticeSearch::primitiveCost(const unsigned char* costs, int x, int y, const MotionPrimitive& primitive) const {
+    if (x + primitive.min_dx < 0 || x + primitive.max_dx >= nx_ || y + primitive.min_dy < 0
+            || y + primitive.max_dy >= ny_)
+        return -1.0f;
+
+    const unsigned char* center = costs + y * nx_ + x;
+    unsigned char max_cost = 0;
+    for (unsigned int i = 0; i < primitive.trace_dx.size(); i++) {
+        unsigned char cost = center[primitive.trace_dy[i] * nx_ + primitive.trace_dx[i]];
+        if (cost == costmap_2d::NO_INFORMATION) {
+            if (!unknown_)
+                return -1.0f;
+            continue;
+        }
+        if (cost == costmap_2d::LETHAL_OBSTACLE
+                || (cost == costmap_2d::INSCRIBED_INFLATED_OBSTACLE && !primitives_.hasFootprint()))
+            return -1.0f;
+        max_cost = std::max(max_cost, cost);
+    }
+
+    if (primitives_.hasFootprint() && max_cost >= mask_threshold_) {
+        for (unsigned int i = 0; i < primitive.mask_dx.size(); i++) {
+            unsigned char cost = center[primitive.mask_dy[i] * nx_ + primitive.mask_dx[i]];
+            if (cost == costmap_2d::LETHAL_OBSTACLE || (cost == costmap_2d::NO_INFORMATION && !unknown_))
+                return -1.0f;
+        }
+    }
+
+    max_cost = std::min(max_cost, (unsigned char) (costmap_2d::INSCRIBED_INFLATED_OBSTACLE - 1));
+    return primitive.length * penalty(primitive)
+            * (1.0 + cost_factor_ * max_cost / (costmap_2d::INSCRIBED_INFLATED_OBSTACLE - 1));
+}
+
+bool LatticeSearch::search(const unsigned char* costs, int nx, int ny, int start_x, int start_y, int start_heading,
+                           int goal_x, int goal_y, int goal_heading, double tolerance,
+                           std::vector<LatticeStep>& path) {
+    path.clear();
+    expansions_ = 0;
+    cost_ = 0.0;
+    nx_ = nx;
+    ny_ = ny;
+    goal_x_ = goal_x;
+    goal_y_ = goal_y;
+    goal_heading_ = goal_heading;
+    start_x_ = start_x;
+    start_y_ = start_y;
+    tolerance_ = tolerance;
+    // the table only bounds the cost to the goal state itself
+    use_table_ = !table_.empty() && tolerance < 1.0;
+
+    // if not even the center of the robot can get to the goal, there is no path
+    computeDistances(costs, start_x, start_y, goal_x, goal_y, tolerance);
+    if (!settled_[start_y * nx + start_x])
+        return false;
+
+    nodes_.clear();
+    index_.clear();
+    Queue open;
+
+    Node start;
+    start.state = (start_y * nx + start_x) * NUM_HEADINGS + start_heading;
+    start.g = 0.0f;
+    start.parent = start.primitive = -1;
+    start.closed = false;
+    nodes_.push_back(start);
+    index_[start.state] = 0;
+    open.push(QueueEntry(epsilon_ * heuristic(start_x, start_y, start_heading), 0));
+
+    double tolerance_sq = std::max(tolerance * tolerance, 0.0);
+    while (!open.empty()) {
+        int current = open.top().second;
+        open.pop();
+        if (nodes_[current].closed)
+            continue;
+        nodes_[current].closed = true;
+
+        unsigned int state = nodes_[current].state;
+        int heading = state % NUM_HEADINGS, cell = state / NUM_HEADINGS;
+        int x = cell % nx, y = cell / nx;
+
+        if (heading == goal_heading && (x - goal_x) * (x - goal_x) + (y - goal_y) * (y - goal_y) <= tolerance_sq) {
+            cost_ = nodes_[current].g;
+            for (int n = current; nodes_[n].parent >= 0; n = nodes_[n].parent) {
+                const Node& parent = nodes_[nodes_[n].parent];
+                LatticeStep step;
+                step.x = (parent.state / NUM_HEADINGS) % nx;
+                step.y = (parent.state / NUM_HEADINGS) / nx;
+                step.primitive = &primitives_.getPrimitives(parent.state % NUM_HEADINGS)[nodes_[n].primitive];
+                path.push_back(step);
+            }
+            std::reverse(path.begin(), path.end());
+            return true;
+        }
+
+        if (max_expansions_ > 0 && expansions_ >= max_expansions_)
+            return false;
+        expansions_++;
+
+        const std::vector<MotionPrimitive>& p = primitives_.getPrimitives(heading);
+        for (unsigned int k = 0; k < p.size(); k++) {
+            float cost = primitiveCost(costs, x, y, p[k]);
+            if (cost < 0)
+                continue;
+            float g = nodes_[current].g + cost;
+            int x2 = x + p[k].dx, y2 = y + p[k].dy;
+            unsigned int next = (y2 * nx + x2) * NUM_HEADINGS + p[k].end_heading;
+
+            boost::unordered_map<unsigned int, int>::iterator it = index_.find(next);
+            int n;
+            if (it == index_.end()) {
+                Node node;
+                node.state = next;
+                node.closed = false;
+                n = nodes_.size();
+                nodes_.push_back(node);
+                index_[next] = n;
+            } else {
+                n = it->second;
+                if (nodes_[n].closed || g >= nodes_[n].g)
+                    continue;
+            }
+            nodes_[n].g = g;
+            nodes_[n].parent = current;
+            nodes_[n].primitive = k;
+            open.push(QueueEntry(g + epsilon_ * heuristic(x2, y2, p[k].end_heading), n));
+        }
+    }
+    return false;
+}
+
+} //end namespace global_planner
@@ -0,0 +1,233 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/lpastar.h>
+#include <algorithm>
+
+namespace global_planner {
+
+LPAStarExpansion::LPAStarExpansion(PotentialCalculator* p_calc, int nx, int ny) :
+        Expander(p_calc, nx, ny), needs_reset_(true), start_i_(-1) {
+    setSize(nx, ny);
+}
+
+void LPAStarExpansion::setSize(int nx, int ny) {
+    // the planner sets the size before every plan, only a real change invalidates the search
+    if (nx == nx_ && ny == ny_ && (int) g_.size() == nx * ny)
+        return;
+
+    Expander::setSize(nx, ny);
+    g_.assign(ns_, POT_HIGH);
+    rhs_.assign(ns_, POT_HIGH);
+    last_costs_.assign(ns_, 0);
+    heap_pos_.assign(ns_, -1);
+    heap_.clear();
+    needs_reset_ = true;
+}
+
+void LPAStarExpansion::restart(unsigned char* costs, int start_i) {
+    std::fill(g_.begin(), g_.end(), POT_HIGH);
+    std::fill(rhs_.begin(), rhs_.end(), POT_HIGH);
+    for (unsigned int i = 0; i < heap_.size(); i++)
+        heap_pos_[heap_[i]] = -1;
+    heap_.clear();
+    std::copy(costs, costs + ns_, last_costs_.begin());
+
+    start_i_ = start_i;
+    rhs_[start_i] = 0;
+    heapUpdate(start_i);
+
+    last_lethal_cost_ = lethal_cost_;
+    last_neutral_cost_ = neutral_cost_;
+    last_factor_ = factor_;
+    last_unknown_ = unknown_;
+    needs_reset_ = false;
+}
+
+bool LPAStarExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y,
+                                          int cycles, float* potential) {
+    cells_visited_ = 0;
+    int start_i = toIndex(start_x, start_y);
+    int end_i = toIndex(end_x, end_y);
+
+    if (needs_reset_ || start_i != start_i_ || lethal_cost_ != last_lethal_cost_ || neutral_cost_ != last_neutral_cost_
+            || factor_ != last_factor_ || unknown_ != last_unknown_) {
+        restart(costs, start_i);
+    } else {
+        std::vector<int> changed;
+        for (int n = 0; n < ns_; n++) {
+            if (costs[n] != last_costs_[n])
+                changed.push_back(n);
+        }
+
+        // repairing a large part of the map costs more than expanding it again
+        if ((int) changed.size() > ns_ / 4) {
+            restart(costs, start_i);
+        } else {
+            for (unsigned int i = 0; i < changed.size(); i++) {
+                last_costs_[changed[i]] = costs[changed[i]];
+                updateCell(costs, changed[i]);
+            }
+        }
+    }
+
+    // keep going until the end cell and all of its neighbors are consistent, the traceback
+    // looks at the neighbors of the end cell
+    int cycle = 0;
+    while (!heap_.empty() && cycle < cycles) {
+        float end_key = key(end_i);
+        if (end_key < POT_HIGH && g_[end_i] == rhs_[end_i] && key(heap_[0]) > end_key + lethal_cost_)
+            break;
+
+        int n = heapPop();
+        if (g_[n] > rhs_[n]) {
+            g_[n] = rhs_[n];
+        } else {
+            g_[n] = POT_HIGH;
+            updateCell(costs, n);
+        }
+
+        if (n - 1 >= 0)
+            updateCell(costs, n - 1);
+        if (n + 1 < ns_)
+            updateCell(costs, n + 1);
+        if (n - nx_ >= 0)
+            updateCell(costs, n - nx_);
+        if (n + nx_ < ns_)
+            updateCell(costs, n + nx_);
+
+        cells_visited_++;
+        cycle++;
+    }
+
+    // the whole buffer is written, every cell belongs to this search
+    resetPotential();
+    std::copy(g_.begin(), g_.end(), potential);
+    stamps_.setAll();
+    return g_[end_i] < POT_HIGH && g_[end_i] == rhs_[end_i];
+}
+
+//
+// Recompute the one-step lookahead of a cell from the potentials of its
+// neighbors and queue it if it became inconsistent
+//
+void LPAStarExpansion::updateCell(unsigned char* costs, int n) {
+    if (n != start_i_) {
+        float c = getCost(costs, n);
+        if (c >= lethal_cost_) {
+            rhs_[n] = POT_HIGH;
+        } else {
+            float pot = p_calc_->calculatePotential(&g_[0], c, n);
+            rhs_[n] = std::min(pot, (float) POT_HIGH);
+        }
+    }
+
+    if (g_[n] != rhs_[n])
+        heapUpdate(n);
+    else
+        heapRemove(n);
+}
+
+void LPAStarExpansion::heapUpdate(int n) {
+    if (heap_pos_[n] < 0) {
+        heap_pos_[n] = heap_.size();
+        heap_.push_back(n);
+        heapSiftUp(heap_pos_[n]);
+    } else {
+        heapSiftUp(heap_pos_[n]);
+        heapSiftDown(heap_pos_[n]);
+    }
+}
+
+void LPAStarExpansion::heapRemove(int n) {
+    int pos = heap_pos_[n];
+    if (pos < 0)
+        return;
+
+    heap_pos_[n] = -1;
+    int last = heap_.back();
+    heap_.pop_back();
+    if (pos < (int) heap_.size()) {
+        heap_[pos] = last;
+        heap_pos_[last] = pos;
+        heapSiftUp(pos);
+        heapSiftDown(heap_pos_[last]);
+    }
+}
+
+int LPAStarExpansion::heapPop() {
+    int top = heap_[0];
+    heapRemove(top);
+    return top;
+}
+
+void LPAStarExpansion::heapSiftUp(int pos) {
+    int n = heap_[pos];
+    float k = key(n);
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (key(heap_[parent]) <= k)
+            break;
+        heap_[pos] = heap_[parent];
+        heap_pos_[heap_[pos]] = pos;
+        pos = parent;
+    }
+    heap_[pos] = n;
+    heap_pos_[n] = pos;
+}
+
+void LPAStarExpansion::heapSiftDown(int pos) {
+    int size = heap_.size();
+    int n = heap_[pos];
+    float k = key(n);
+    while (true) {
+        int child = 2 * pos + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size && key(heap_[child + 1]) < key(heap_[child]))
+            child++;
+        if (key(heap_[child]) >= k)
+            break;
+        heap_[pos] = heap_[child];
+        heap_pos_[heap_[pos]] = pos;
+        pos = child;
+    }
+    heap_[pos] = n;
+    heap_pos_[n] = pos;
+}
+
+} //end namespace global_planner
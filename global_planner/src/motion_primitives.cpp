@@ -0,0 +1,243 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/motion_primitives.h>
+#include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/footprint.h>
+#include <algorithm>
+#include <set>
+#include <utility>
+#include <math.h>
+
+namespace global_planner {
+
+// the cell vector each heading points along, counterclockwise from the x axis
+static const int HEADING_X[MotionPrimitives::NUM_HEADINGS] = {1, 2, 1, 1, 0, -1, -1, -2, -1, -2, -1, -1, 0, 1, 1, 2};
+static const int HEADING_Y[MotionPrimitives::NUM_HEADINGS] = {0, 1, 1, 2, 1, 2, 1, 1, 0, -1, -1, -2, -1, -2, -1, -1};
+
+MotionPrimitives::MotionPrimitives() :
+        primitives_(NUM_HEADINGS), resolution_(0.0), has_footprint_(false) {
+}
+
+double MotionPrimitives::getHeadingAngle(int heading) {
+    return atan2((double) HEADING_Y[heading], (double) HEADING_X[heading]);
+}
+
+int MotionPrimitives::getHeading(double theta) {
+    int best = 0;
+    double best_diff = 2 * M_PI;
+    for (int i = 0; i < NUM_HEADINGS; i++) {
+        double diff = fabs(remainder(theta - getHeadingAngle(i), 2 * M_PI));
+        if (diff < best_diff) {
+            best = i;
+            best_diff = diff;
+        }
+    }
+    return best;
+}
+
+void MotionPrimitives::generate(double resolution, double turning_radius, double step_length, bool allow_reverse,
+                                const std::vector<geometry_msgs::Point>& footprint) {
+    resolution_ = resolution;
+    has_footprint_ = footprint.size() >= 3;
+    for (int i = 0; i < NUM_HEADINGS; i++)
+        primitives_[i].clear();
+
+    // the headings in the first quadrant, the others are rotated by multiples of 90 degrees so that
+    // the lattice is exactly symmetric, which the heuristic table relies on
+    double radius = turning_radius / resolution;
+    for (int i = 0; i < NUM_HEADINGS / 4; i++) {
+        double length = hypot(HEADING_X[i], HEADING_Y[i]);
+        addPrimitive(i, i, HEADING_X[i], HEADING_Y[i], false, false);
+
+        int steps = (int) floor(step_length / (length * resolution) + 0.5);
+        if (steps > 1)
+            addPrimitive(i, i, steps * HEADING_X[i], steps * HEADING_Y[i], false, false);
+
+        // arcs to the neighboring headings, ending on the closest cell
+        for (int side = -1; side <= 1; side += 2) {
+            int j = (i + side + NUM_HEADINGS) % NUM_HEADINGS;
+            double ti = getHeadingAngle(i), tj = getHeadingAngle(j);
+            int dx = (int) floor(side * radius * (sin(tj) - sin(ti)) + 0.5);
+            int dy = (int) floor(side * radius * (cos(ti) - cos(tj)) + 0.5);
+            if (dx == 0 && dy == 0) {
+                dx = HEADING_X[j];
+                dy = HEADING_Y[j];
+            }
+            addPrimitive(i, j, dx, dy, true, false);
+        }
+
+        if (allow_reverse)
+            addPrimitive(i, i, -HEADING_X[i], -HEADING_Y[i], false, true);
+    }
+
+    for (int i = NUM_HEADINGS / 4; i < NUM_HEADINGS; i++) {
+        const std::vector<MotionPrimitive>& source = primitives_[i - NUM_HEADINGS / 4];
+        for (unsigned int k = 0; k < source.size(); k++) {
+            MotionPrimitive p = source[k];
+            p.start_heading = i;
+            p.end_heading = (p.end_heading + NUM_HEADINGS / 4) % NUM_HEADINGS;
+            int dx = p.dx;
+            p.dx = -p.dy;
+            p.dy = dx;
+            for (unsigned int n = 0; n < p.poses.size(); n++) {
+                double x = p.poses[n].x;
+                p.poses[n].x = -p.poses[n].y;
+                p.poses[n].y = x;
+                p.poses[n].theta += M_PI / 2;
+            }
+            primitives_[i].push_back(p);
+        }
+    }
+
+    rasterize(footprint);
+}
+
+void MotionPrimitives::addPrimitive(int heading, int end_heading, int dx, int dy, bool turn, bool reverse) {
+    MotionPrimitive p;
+    p.start_heading = heading;
+    p.end_heading = end_heading;
+    p.dx = dx;
+    p.dy = dy;
+    p.turn = turn;
+    p.reverse = reverse;
+
+    // a cubic Hermite curve between both states, which is a straight line if the headings are the same
+    double t0 = getHeadingAngle(heading), t1 = getHeadingAngle(end_heading);
+    double chord = hypot(dx, dy);
+    double m0x = chord * cos(t0), m0y = chord * sin(t0);
+    double m1x = chord * cos(t1), m1y = chord * sin(t1);
+    if (reverse) {
+        m0x = m1x = dx;
+        m0y = m1y = dy;
+    }
+
+    // a pose every quarter of a cell
+    int samples = std::max(2, (int) ceil(chord * 4));
+    double length = 0.0;
+    for (int n = 1; n <= samples; n++) {
+        double s = (double) n / samples, s2 = s * s, s3 = s2 * s;
+        double h10 = s3 - 2 * s2 + s, h01 = -2 * s3 + 3 * s2, h11 = s3 - s2;
+        double d10 = 3 * s2 - 4 * s + 1, d01 = -6 * s2 + 6 * s, d11 = 3 * s2 - 2 * s;
+
+        LatticePose pose;
+        pose.x = h10 * m0x + h01 * dx + h11 * m1x;
+        pose.y = h10 * m0y + h01 * dy + h11 * m1y;
+        pose.theta = reverse ? t0 : atan2(d10 * m0y + d01 * dy + d11 * m1y, d10 * m0x + d01 * dx + d11 * m1x);
+
+        double px = p.poses.empty() ? 0.0 : p.poses.back().x, py = p.poses.empty() ? 0.0 : p.poses.back().y;
+        length += hypot(pose.x - px, pose.y - py);
+        p.poses.push_back(pose);
+    }
+    p.poses.back().x = dx;
+    p.poses.back().y = dy;
+    p.poses.back().theta = t1;
+    p.length = length * resolution_;
+
+    primitives_[heading].push_back(p);
+}
+
+void MotionPrimitives::rasterize(const std::vector<geometry_msgs::Point>& footprint) {
+    // a scratch map with the start cell in its middle, big enough for every primitive
+    double reach = 0.0;
+    for (int i = 0; i < NUM_HEADINGS; i++)
+        for (unsigned int k = 0; k < primitives_[i].size(); k++)
+            reach = std::max(reach, hypot(primitives_[i][k].dx, primitives_[i][k].dy));
+    double footprint_radius = 0.0;
+    for (unsigned int i = 0; i < footprint.size(); i++)
+        footprint_radius = std::max(footprint_radius, hypot(footprint[i].x, footprint[i].y) / resolution_);
+    int extent = (int) ceil(reach + footprint_radius) + 2;
+    costmap_2d::Costmap2D scratch(2 * extent + 1, 2 * extent + 1, resolution_, -(extent + 0.5) * resolution_,
+                                  -(extent + 0.5) * resolution_);
+
+    std::vector<geometry_msgs::Point> oriented;
+    std::vector<costmap_2d::MapLocation> polygon, cells;
+    for (int i = 0; i < NUM_HEADINGS; i++) {
+        for (unsigned int k = 0; k < primitives_[i].size(); k++) {
+            MotionPrimitive& p = primitives_[i][k];
+            std::set<std::pair<int, int> > mask;
+            p.trace_dx.clear();
+            p.trace_dy.clear();
+
+            for (unsigned int n = 0; n < p.poses.size(); n++) {
+                const LatticePose& pose = p.poses[n];
+                int cx = (int) floor(pose.x + 0.5), cy = (int) floor(pose.y + 0.5);
+                bool seen = false;
+                for (unsigned int t = 0; t < p.trace_dx.size(); t++)
+                    seen = seen || (p.trace_dx[t] == cx && p.trace_dy[t] == cy);
+                if (!seen && (cx != 0 || cy != 0)) {
+                    p.trace_dx.push_back(cx);
+                    p.trace_dy.push_back(cy);
+                }
+
+                if (!has_footprint_)
+                    continue;
+                costmap_2d::transformFootprint(pose.x * resolution_, pose.y * resolution_, pose.theta, footprint,
+                                               oriented);
+                polygon.resize(oriented.size());
+                for (unsigned int v = 0; v < oriented.size(); v++)
+                    scratch.worldToMap(oriented[v].x, oriented[v].y, polygon[v].x, polygon[v].y);
+                cells.clear();
+                scratch.convexFillCells(polygon, cells);
+                for (unsigned int c = 0; c < cells.size(); c++)
+                    mask.insert(std::make_pair((int) cells[c].x - extent, (int) cells[c].y - extent));
+            }
+
+            p.mask_dx.clear();
+            p.mask_dy.clear();
+            p.min_dx = p.max_dx = p.min_dy = p.max_dy = 0;
+            for (std::set<std::pair<int, int> >::const_iterator it = mask.begin(); it != mask.end(); ++it) {
+                p.mask_dx.push_back(it->first);
+                p.mask_dy.push_back(it->second);
+            }
+            for (unsigned int c = 0; c < p.mask_dx.size(); c++) {
+                p.min_dx = std::min(p.min_dx, p.mask_dx[c]);
+                p.max_dx = std::max(p.max_dx, p.mask_dx[c]);
+                p.min_dy = std::min(p.min_dy, p.mask_dy[c]);
+                p.max_dy = std::max(p.max_dy, p.mask_dy[c]);
+            }
+            for (unsigned int c = 0; c < p.trace_dx.size(); c++) {
+                p.min_dx = std::min(p.min_dx, p.trace_dx[c]);
+                p.max_dx = std::max(p.max_dx, p.trace_dx[c]);
+                p.min_dy = std::min(p.min_dy, p.trace_dy[c]);
+                p.max_dy = std::max(p.max_dy, p.trace_dy[c]);
+            }
+        }
+    }
+}
+
+} //end namespace global_planner
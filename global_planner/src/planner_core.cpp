@@ -40,18 +40,45 @@
 #include <tf/transform_listener.h>
 #include <costmap_2d/cost_values.h>
 #include <costmap_2d/costmap_2d.h>
+#include <costmap_2d/costmap_layer.h>
+#include <algorithm>
+#include <math.h>
 
 #include <global_planner/dijkstra.h>
+#include <global_planner/compact_dijkstra.h>
 #include <global_planner/astar.h>
+#include <global_planner/arastar.h>
+#include <global_planner/lpastar.h>
+#include <global_planner/hpastar.h>
+#include <global_planner/bidirectional.h>
+#include <global_planner/thetastar.h>
+#include <global_planner/landmark_heuristic.h>
+#include <global_planner/potential_publisher.h>
 #include <global_planner/grid_path.h>
 #include <global_planner/gradient_path.h>
+#include <global_planner/thetastar_path.h>
 #include <global_planner/quadratic_calculator.h>
+#include <navfn/navfn.h>
 
 //register this planner as a BaseGlobalPlanner plugin
 PLUGINLIB_EXPORT_CLASS(global_planner::GlobalPlanner, nav_core::BaseGlobalPlanner)
 
 namespace global_planner {
 
+/**
+ * @brief  Reads a float potential through the expander that computed it, which knows the cells left from earlier plans
+ */
+struct ExpandedPotential {
+    ExpandedPotential(const Expander* expander, const float* potential) :
+            expander(expander), potential(potential) {
+    }
+    float operator[](int n) const {
+        return expander->getPotential(potential, n);
+    }
+    const Expander* expander;
+    const float* potential;
+};
+
 void GlobalPlanner::outlineMap(unsigned char* costarr, int nx, int ny, unsigned char value) {
     unsigned char* pc = costarr;
     for (int i = 0; i < nx; i++)
@@ -67,29 +94,86 @@ void GlobalPlanner::outlineMap(unsigned char* costarr, int nx, int ny, unsigned
         *pc = value;
 }
 
+void GlobalPlanner::resizePotentialArray(int size) {
+    // the expanders stamp the cells of each plan, so the buffer is never filled
+    if (potential_array_size_ == size)
+        return;
+    delete[] potential_array_;
+    potential_array_ = new float[size];
+    potential_array_size_ = size;
+}
+
+void GlobalPlanner::cellsAroundGoal(int goal_i, int nx, int ny, std::vector<int>& cells) {
+    int x = goal_i % nx, y = goal_i / nx;
+    cells.clear();
+    for (int j = std::max(y - 2, 0); j <= std::min(y + 2, ny - 1); j++)
+        for (int i = std::max(x - 2, 0); i <= std::min(x + 2, nx - 1); i++)
+            cells.push_back(i + j * nx);
+}
+
 GlobalPlanner::GlobalPlanner() :
-        costmap_(NULL), initialized_(false), allow_unknown_(true) {
+        costmap_(NULL), initialized_(false), allow_unknown_(true), hierarchical_(false), anytime_planner_(NULL),
+        hierarchical_planner_(NULL), layered_costmap_(NULL), compact_planner_(NULL),
+        compact_potential_(NULL), batch_planner_(NULL),
+        batch_path_maker_(NULL), use_grid_path_(false), lethal_cost_(253), neutral_cost_(50), cost_factor_(3.0),
+        landmarks_(NULL), landmark_map_(NULL), potential_publisher_(NULL), potential_array_(NULL),
+        potential_array_size_(0) {
 }
 
 GlobalPlanner::GlobalPlanner(std::string name, costmap_2d::Costmap2D* costmap, std::string frame_id) :
-        costmap_(NULL), initialized_(false), allow_unknown_(true) {
+        costmap_(NULL), initialized_(false), allow_unknown_(true), hierarchical_(false), anytime_planner_(NULL),
+        hierarchical_planner_(NULL), layered_costmap_(NULL), compact_planner_(NULL),
+        compact_potential_(NULL), batch_planner_(NULL),
+        batch_path_maker_(NULL), use_grid_path_(false), lethal_cost_(253), neutral_cost_(50), cost_factor_(3.0),
+        landmarks_(NULL), landmark_map_(NULL), potential_publisher_(NULL), potential_array_(NULL),
+        potential_array_size_(0) {
     //initialize the planner
     initialize(name, costmap, frame_id);
 }
 
 GlobalPlanner::~GlobalPlanner() {
+    // the batch queries may share the expansion of the single goal plans
+    if (batch_planner_ && batch_planner_ != planner_)
+        delete batch_planner_;
+    if (batch_path_maker_ && batch_path_maker_ != path_maker_)
+        delete batch_path_maker_;
     if (p_calc_)
         delete p_calc_;
     if (planner_)
         delete planner_;
     if (path_maker_)
         delete path_maker_;
+    if (landmarks_)
+        delete landmarks_;
     if (dsrv_)
         delete dsrv_;
+    if (potential_publisher_)
+        delete potential_publisher_;
+    if (potential_array_)
+        delete[] potential_array_;
+    if (compact_potential_)
+        delete compact_potential_;
 }
 
 void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros) {
     initialize(name, costmap_ros->getCostmap(), costmap_ros->getGlobalFrameID());
+    layered_costmap_ = costmap_ros->getLayeredCostmap();
+
+    if (landmarks_ && !landmark_map_) {
+        // the landmarks are only refreshed when the lethal cells of this layer change
+        ros::NodeHandle private_nh("~/" + name);
+        std::string landmark_layer;
+        private_nh.param("landmark_layer", landmark_layer, std::string("static_layer"));
+        std::vector<boost::shared_ptr<costmap_2d::Layer> >* plugins = costmap_ros->getLayeredCostmap()->getPlugins();
+        for (unsigned int i = 0; i < plugins->size(); i++) {
+            std::string layer_name = (*plugins)[i]->getName();
+            if (layer_name.size() >= landmark_layer.size()
+                    && layer_name.compare(layer_name.size() - landmark_layer.size(), landmark_layer.size(), landmark_layer) == 0)
+                landmark_map_ = dynamic_cast<costmap_2d::CostmapLayer*>((*plugins)[i].get());
+        }
+        if (!landmark_map_)
+            ROS_WARN("No layer named %s in the costmap, the landmark heuristic is disabled", landmark_layer.c_str());
+    }
 }
 
 void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap, std::string frame_id) {
@@ -113,9 +197,48 @@ void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
         else
             p_calc_ = new PotentialCalculator(cx, cy);
 
-        bool use_dijkstra;
+        bool use_dijkstra, use_incremental, use_bidirectional, use_any_angle, use_anytime, use_compact_potential;
         private_nh.param("use_dijkstra", use_dijkstra, true);
-        if (use_dijkstra)
+        private_nh.param("use_compact_potential", use_compact_potential, false);
+        private_nh.param("use_incremental", use_incremental, false);
+        private_nh.param("use_bidirectional", use_bidirectional, false);
+        private_nh.param("use_any_angle", use_any_angle, false);
+        private_nh.param("use_anytime", use_anytime, false);
+        ThetaStarExpansion* theta_star = NULL;
+        // the incremental expansion keeps its search rooted at the goal and repairs it when the robot moves
+        root_at_goal_ = use_incremental;
+        if (use_incremental)
+            planner_ = new LPAStarExpansion(p_calc_, cx, cy);
+        else if (use_any_angle)
+            planner_ = theta_star = new ThetaStarExpansion(p_calc_, cx, cy);
+        else if (use_anytime)
+        {
+            // the first plan is at most initial_epsilon times as expensive as the best one, and improves until the budget runs out
+            double planning_time_budget, initial_epsilon, epsilon_step;
+            private_nh.param("planning_time_budget", planning_time_budget, 0.5);
+            private_nh.param("initial_epsilon", initial_epsilon, 3.0);
+            private_nh.param("epsilon_step", epsilon_step, 0.5);
+            anytime_planner_ = new ARAStarExpansion(p_calc_, cx, cy);
+            anytime_planner_->setTimeBudget(planning_time_budget);
+            anytime_planner_->setEpsilon(initial_epsilon, epsilon_step);
+            planner_ = anytime_planner_;
+        }
+        else if (use_bidirectional)
+        {
+            BidirectionalExpansion* be = new BidirectionalExpansion(p_calc_, cx, cy);
+            be->setUseHeuristic(!use_dijkstra);
+            planner_ = be;
+        }
+        else if (use_dijkstra && use_compact_potential)
+        {
+            // 3 bytes per cell instead of 8, at the price of a quantized potential that is traced on the grid
+            compact_planner_ = new CompactDijkstraExpansion(p_calc_, cx, cy);
+            if(!old_navfn_behavior_)
+                compact_planner_->setPreciseStart(true);
+            compact_potential_ = new CompactPotential();
+            planner_ = compact_planner_;
+        }
+        else if (use_dijkstra)
         {
             DijkstraExpansion* de = new DijkstraExpansion(p_calc_, cx, cy);
             if(!old_navfn_behavior_)
@@ -123,19 +246,53 @@ void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
             planner_ = de;
         }
         else
-            planner_ = new AStarExpansion(p_calc_, cx, cy);
+        {
+            AStarExpansion* ae = new AStarExpansion(p_calc_, cx, cy);
+            bool use_bucket_queue;
+            private_nh.param("use_bucket_queue", use_bucket_queue, false);
+            ae->setUseBucketQueue(use_bucket_queue);
+            // every landmark takes 2 bytes per cell of the costmap
+            int num_landmarks;
+            private_nh.param("num_landmarks", num_landmarks, 0);
+            if (num_landmarks > 0) {
+                landmarks_ = new LandmarkHeuristic(num_landmarks);
+                ae->setLandmarks(landmarks_);
+            }
+            planner_ = ae;
+        }
 
-        bool use_grid_path;
-        private_nh.param("use_grid_path", use_grid_path, false);
-        if (use_grid_path)
+        if (hierarchical_)
+        {
+            int cluster_size, corridor_margin;
+            private_nh.param("cluster_size", cluster_size, 64);
+            private_nh.param("corridor_margin", corridor_margin, 1);
+            planner_ = hierarchical_planner_ = new HPAStarExpansion(p_calc_, planner_, cx, cy, cluster_size,
+                                                                    corridor_margin);
+            // the intermediate potentials only cover a corridor, the plans are not reported on the way
+            anytime_planner_ = NULL;
+            // the cluster graph hands float potentials to the planner it wraps
+            compact_planner_ = NULL;
+        }
+
+        private_nh.param("use_grid_path", use_grid_path_, false);
+        if (theta_star)
+        {
+            // the any-angle path only has points at turns, the local planners need some on long straight segments
+            double waypoint_spacing;
+            private_nh.param("waypoint_spacing", waypoint_spacing, 1.0);
+            ThetaStarPath* tp = new ThetaStarPath(p_calc_, theta_star);
+            tp->setMaxStep(waypoint_spacing / costmap->getResolution());
+            path_maker_ = tp;
+        }
+        else if (use_grid_path_ || compact_planner_)
             path_maker_ = new GridPath(p_calc_);
         else
             path_maker_ = new GradientPath(p_calc_);
-            
+
         orientation_filter_ = new OrientationFilter();
 
         plan_pub_ = private_nh.advertise<nav_msgs::Path>("plan", 1);
-        potential_pub_ = private_nh.advertise<nav_msgs::OccupancyGrid>("potential", 1);
+        potential_publisher_ = new PotentialPublisher(private_nh, "potential");
 
         private_nh.param("allow_unknown", allow_unknown_, true);
         planner_->setHasUnknown(allow_unknown_);
@@ -143,6 +300,13 @@ void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
         private_nh.param("planner_window_y", planner_window_y_, 0.0);
         private_nh.param("default_tolerance", default_tolerance_, 0.0);
         private_nh.param("publish_scale", publish_scale_, 100);
+        private_nh.param("potential_downsample", potential_downsample_, 1);
+        private_nh.param("potential_crop_margin", potential_crop_margin_, 0.0);
+        private_nh.param("corridor_width", corridor_width_, 0.0);
+        if (corridor_width_ > 0 && root_at_goal_)
+            ROS_WARN("The incremental planner already repairs its last search, corridor_width is ignored");
+        else if (corridor_width_ > 0 && hierarchical_)
+            ROS_WARN("The hierarchical planner already searches a corridor of clusters, corridor_width is ignored");
 
         double costmap_pub_freq;
         private_nh.param("planner_costmap_publish_frequency", costmap_pub_freq, 0.0);
@@ -152,6 +316,7 @@ void GlobalPlanner::initialize(std::string name, costmap_2d::Costmap2D* costmap,
         tf_prefix_ = tf::getPrefixParam(prefix_nh);
 
         make_plan_srv_ = private_nh.advertiseService("make_plan", &GlobalPlanner::makePlanService, this);
+        make_plans_srv_ = private_nh.advertiseService("make_plans", &GlobalPlanner::makePlansService, this);
 
         dsrv_ = new dynamic_reconfigure::Server<global_planner::GlobalPlannerConfig>(ros::NodeHandle("~/" + name));
         dynamic_reconfigure::Server<global_planner::GlobalPlannerConfig>::CallbackType cb = boost::bind(
@@ -169,6 +334,15 @@ void GlobalPlanner::reconfigureCB(global_planner::GlobalPlannerConfig& config, u
     path_maker_->setLethalCost(config.lethal_cost);
     planner_->setNeutralCost(config.neutral_cost);
     planner_->setFactor(config.cost_factor);
+    lethal_cost_ = config.lethal_cost;
+    neutral_cost_ = config.neutral_cost;
+    cost_factor_ = config.cost_factor;
+    if (batch_planner_) {
+        batch_planner_->setLethalCost(config.lethal_cost);
+        batch_path_maker_->setLethalCost(config.lethal_cost);
+        batch_planner_->setNeutralCost(config.neutral_cost);
+        batch_planner_->setFactor(config.cost_factor);
+    }
     publish_potential_ = config.publish_potential;
     orientation_filter_->setMode(config.orientation_mode);
 }
@@ -182,6 +356,8 @@ void GlobalPlanner::clearRobotCell(const tf::Stamped<tf::Pose>& global_pose, uns
 
     //set the associated costs in the cost map to be free
     costmap_->setCost(mx, my, costmap_2d::FREE_SPACE);
+    if (hierarchical_planner_)
+        hierarchical_planner_->markChanged(mx, my, mx + 1, my + 1);
 }
 
 bool GlobalPlanner::makePlanService(nav_msgs::GetPlan::Request& req, nav_msgs::GetPlan::Response& resp) {
@@ -193,6 +369,24 @@ bool GlobalPlanner::makePlanService(nav_msgs::GetPlan::Request& req, nav_msgs::G
     return true;
 }
 
+bool GlobalPlanner::makePlansService(navfn::MakeNavPlans::Request& req, navfn::MakeNavPlans::Response& resp) {
+    std::vector<std::vector<geometry_msgs::PoseStamped> > plans;
+    makePlans(req.start, req.goals, resp.costs, req.return_paths ? &plans : NULL);
+
+    resp.plan_found.resize(resp.costs.size());
+    for (unsigned int i = 0; i < resp.costs.size(); i++)
+        resp.plan_found[i] = resp.costs[i] < POT_HIGH;
+
+    resp.paths.resize(plans.size());
+    for (unsigned int i = 0; i < plans.size(); i++) {
+        resp.paths[i].header.stamp = ros::Time::now();
+        resp.paths[i].header.frame_id = frame_id_;
+        resp.paths[i].poses = plans[i];
+    }
+
+    return true;
+}
+
 void GlobalPlanner::mapToWorld(double mx, double my, double& wx, double& wy) {
     wx = costmap_->getOriginX() + (mx+convert_offset_) * costmap_->getResolution();
     wy = costmap_->getOriginY() + (my+convert_offset_) * costmap_->getResolution();
@@ -219,6 +413,14 @@ bool GlobalPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geom
     return makePlan(start, goal, default_tolerance_, plan);
 }
 
+bool GlobalPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
+                           std::vector<geometry_msgs::PoseStamped>& plan, const PlanCallback& callback) {
+    plan_callback_ = callback;
+    bool got_plan = makePlan(start, goal, default_tolerance_, plan);
+    plan_callback_.clear();
+    return got_plan;
+}
+
 bool GlobalPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal,
                            double tolerance, std::vector<geometry_msgs::PoseStamped>& plan) {
     boost::mutex::scoped_lock lock(mutex_);
@@ -291,21 +493,63 @@ bool GlobalPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geom
     p_calc_->setSize(nx, ny);
     planner_->setSize(nx, ny);
     path_maker_->setSize(nx, ny);
-    potential_array_ = new float[nx * ny];
+    if (!compact_planner_)
+        resizePotentialArray(nx * ny);
+
+    // the cluster graph is only rebuilt where the costmap changed since the last plan. A bare costmap does not tell,
+    // so the whole graph is rebuilt
+    if (hierarchical_planner_) {
+        if (layered_costmap_) {
+            unsigned int x0, xn, y0, yn;
+            layered_costmap_->takeChangedArea(&x0, &xn, &y0, &yn);
+            hierarchical_planner_->markChanged(x0, y0, xn, yn);
+        } else
+            hierarchical_planner_->reset();
+    }
 
     outlineMap(costmap_->getCharMap(), nx, ny, costmap_2d::LETHAL_OBSTACLE);
 
-    bool found_legal = planner_->calculatePotentials(costmap_->getCharMap(), start_x, start_y, goal_x, goal_y,
-                                                    nx * ny * 2, potential_array_);
-
-    if(!old_navfn_behavior_)
-        planner_->clearEndpoint(costmap_->getCharMap(), potential_array_, goal_x_i, goal_y_i, 2);
-    if(publish_potential_)
-        publishPotential(potential_array_);
+    if (landmark_map_ && landmark_map_->getSizeInCellsX() == (unsigned int) nx
+            && landmark_map_->getSizeInCellsY() == (unsigned int) ny
+            && landmarks_->update(landmark_map_->getCharMap(), nx, ny))
+        ROS_INFO("Computed the tables of %d landmarks", (int) landmarks_->getLandmarks().size());
+
+    if (anytime_planner_)
+        anytime_planner_->setImprovedCallback(boost::bind(&GlobalPlanner::improvedPotential, this, _1, start_x, start_y,
+                                                          goal_x, goal_y, boost::cref(start), boost::cref(goal)));
+
+    // a refresh of the last plan only searches the corridor around it, and the whole map only if that fails
+    bool in_corridor = closeCorridor(start_x_i, start_y_i, goal_x_i, goal_y_i);
+    bool found_legal = in_corridor && calculatePotentials(costmap_->getCharMap(), start_x, start_y, goal_x, goal_y,
+                                                          start_x_i, start_y_i, goal_x_i, goal_y_i);
+    if (in_corridor) {
+        openCorridor();
+        if (!found_legal)
+            ROS_DEBUG("No path inside the corridor around the last plan, planning on the whole map");
+    }
+    if (!found_legal)
+        found_legal = calculatePotentials(costmap_->getCharMap(), start_x, start_y, goal_x, goal_y, start_x_i,
+                                          start_y_i, goal_x_i, goal_y_i);
+    if (anytime_planner_) {
+        anytime_planner_->setImprovedCallback(ARAStarExpansion::ImprovedCallback());
+        ROS_DEBUG("Anytime planner stopped at epsilon %.2f", anytime_planner_->getEpsilon());
+    }
 
     if (found_legal) {
         //extract the plan
-        if (getPlanFromPotential(start_x, start_y, goal_x, goal_y, goal, plan)) {
+        bool got_plan;
+        if (root_at_goal_) {
+            // the potential descends towards the goal, so the path is traced from the robot and reversed
+            got_plan = getPlanFromPotential(goal_x, goal_y, start_x, start_y, goal, plan);
+            if (got_plan && old_navfn_behavior_)
+                plan.pop_back();
+            std::reverse(plan.begin(), plan.end());
+            if (got_plan && old_navfn_behavior_)
+                plan.push_back(goal);
+        } else
+            got_plan = getPlanFromPotential(start_x, start_y, goal_x, goal_y, goal, plan);
+
+        if (got_plan) {
             //make sure the goal we push on has the same timestamp as the rest of the plan
             geometry_msgs::PoseStamped goal_copy = goal;
             goal_copy.header.stamp = ros::Time::now();
@@ -314,18 +558,304 @@ bool GlobalPlanner::makePlan(const geometry_msgs::PoseStamped& start, const geom
             ROS_ERROR("Failed to get a plan from potential when a legal potential was found. This shouldn't happen.");
         }
     }else{
+        if (compact_planner_ && compact_potential_->isSaturated())
+            ROS_WARN("The compact potential only reaches up to %.0f, use_compact_potential is too coarse for this map",
+                     compact_potential_->getMaxPotential());
         ROS_ERROR("Failed to get a plan.");
     }
+    if (corridor_width_ > 0) {
+        last_plan_ = plan;
+        last_goal_ = goal.pose.position;
+    }
+
+    if(publish_potential_) {
+        if (compact_planner_)
+            publishPotential(*compact_potential_, plan);
+        else
+            publishPotential(ExpandedPotential(planner_, potential_array_), plan);
+    }
 
     // add orientations if needed
     orientation_filter_->processPath(start, plan);
     
     //publish the plan for visualization purposes
     publishPlan(plan);
-    delete potential_array_;
     return !plan.empty();
 }
 
+bool GlobalPlanner::calculatePotentials(unsigned char* costs, double start_x, double start_y, double goal_x,
+                                        double goal_y, unsigned int start_x_i, unsigned int start_y_i,
+                                        unsigned int goal_x_i, unsigned int goal_y_i) {
+    int nx = costmap_->getSizeInCellsX(), ny = costmap_->getSizeInCellsY();
+    bool found_legal;
+    if (compact_planner_)
+        found_legal = compact_planner_->calculatePotentials(costs, start_x, start_y, goal_x, goal_y, nx * ny * 2,
+                                                            *compact_potential_);
+    else if (root_at_goal_)
+        found_legal = planner_->calculatePotentials(costs, goal_x, goal_y, start_x, start_y, nx * ny * 2,
+                                                    potential_array_);
+    else
+        found_legal = planner_->calculatePotentials(costs, start_x, start_y, goal_x, goal_y, nx * ny * 2,
+                                                    potential_array_);
+    ROS_DEBUG("Expanded %d cells", planner_->getCellsVisited());
+
+    if(!old_navfn_behavior_) {
+        if (compact_planner_)
+            compact_planner_->clearEndpoint(costs, *compact_potential_, goal_x_i, goal_y_i, 2);
+        else if (root_at_goal_)
+            planner_->clearEndpoint(costs, potential_array_, start_x_i, start_y_i, 2);
+        else
+            planner_->clearEndpoint(costs, potential_array_, goal_x_i, goal_y_i, 2);
+    }
+    return found_legal;
+}
+
+bool GlobalPlanner::closeCorridor(unsigned int start_x, unsigned int start_y, unsigned int goal_x,
+                                  unsigned int goal_y) {
+    if (corridor_width_ <= 0 || root_at_goal_ || hierarchical_ || last_plan_.empty())
+        return false;
+
+    // only a refresh of the last plan can reuse its corridor, and with a tolerance the plan may end anywhere near
+    // the goal it was made for
+    unsigned int last_x, last_y;
+    if (!costmap_->worldToMap(last_goal_.x, last_goal_.y, last_x, last_y) || last_x != goal_x || last_y != goal_y)
+        return false;
+
+    // the corridor is marked in its bounding box, grown by a cell for the border that closes it
+    int nx = costmap_->getSizeInCellsX(), ny = costmap_->getSizeInCellsY();
+    int radius = std::max(1, (int) (corridor_width_ / 2 / costmap_->getResolution()));
+    std::vector<int> path_x(last_plan_.size()), path_y(last_plan_.size());
+    int x0 = nx, y0 = ny, x1 = 0, y1 = 0;
+    for (unsigned int i = 0; i < last_plan_.size(); i++) {
+        costmap_->worldToMapEnforceBounds(last_plan_[i].pose.position.x, last_plan_[i].pose.position.y, path_x[i],
+                                          path_y[i]);
+        x0 = std::min(x0, path_x[i]);
+        y0 = std::min(y0, path_y[i]);
+        x1 = std::max(x1, path_x[i]);
+        y1 = std::max(y1, path_y[i]);
+    }
+    x0 = std::max(0, x0 - radius - 1);
+    y0 = std::max(0, y0 - radius - 1);
+    int bx = std::min(nx - 1, x1 + radius + 1) - x0 + 1, by = std::min(ny - 1, y1 + radius + 1) - y0 + 1;
+    for (unsigned int i = 0; i < last_plan_.size(); i++) {
+        path_x[i] -= x0;
+        path_y[i] -= y0;
+    }
+    corridor_mask_.assign(bx * by, 0);
+    corridor_cells_.clear();
+    navfn::markCorridor(path_x, path_y, radius, bx, by, corridor_mask_, corridor_cells_);
+
+    int sx = (int) start_x - x0, sy = (int) start_y - y0;
+    if (sx < 0 || sy < 0 || sx >= bx || sy >= by || !corridor_mask_[sy * bx + sx]) {
+        ROS_DEBUG("The robot left the corridor around the last plan");
+        return false;
+    }
+
+    // the any-angle expansion steps diagonally, so the border is closed on all 8 sides of the corridor
+    unsigned char* costs = costmap_->getCharMap();
+    corridor_border_.clear();
+    corridor_border_costs_.clear();
+    for (unsigned int i = 0; i < corridor_cells_.size(); i++) {
+        int cx = corridor_cells_[i] % bx, cy = corridor_cells_[i] / bx;
+        for (int y = std::max(0, cy - 1); y <= std::min(by - 1, cy + 1); y++)
+            for (int x = std::max(0, cx - 1); x <= std::min(bx - 1, cx + 1); x++) {
+                if (corridor_mask_[y * bx + x])
+                    continue;
+                corridor_mask_[y * bx + x] = 2;
+                int n = (y + y0) * nx + x + x0;
+                corridor_border_.push_back(n);
+                corridor_border_costs_.push_back(costs[n]);
+                costs[n] = costmap_2d::LETHAL_OBSTACLE;
+            }
+    }
+    return true;
+}
+
+void GlobalPlanner::openCorridor() {
+    unsigned char* costs = costmap_->getCharMap();
+    for (unsigned int i = 0; i < corridor_border_.size(); i++)
+        costs[corridor_border_[i]] = corridor_border_costs_[i];
+    corridor_border_.clear();
+    corridor_border_costs_.clear();
+}
+
+bool GlobalPlanner::makePlans(const geometry_msgs::PoseStamped& start,
+                              const std::vector<geometry_msgs::PoseStamped>& goals, std::vector<double>& costs,
+                              std::vector<std::vector<geometry_msgs::PoseStamped> >* plans) {
+    boost::mutex::scoped_lock lock(mutex_);
+    costs.assign(goals.size(), POT_HIGH);
+    if (plans)
+        plans->assign(goals.size(), std::vector<geometry_msgs::PoseStamped>());
+
+    if (!initialized_) {
+        ROS_ERROR(
+                "This planner has not been initialized yet, but it is being used, please call initialize() before use");
+        return false;
+    }
+
+    std::string global_frame = frame_id_;
+    if (tf::resolve(tf_prefix_, start.header.frame_id) != tf::resolve(tf_prefix_, global_frame)) {
+        ROS_ERROR(
+                "The start pose passed to this planner must be in the %s frame.  It is instead in the %s frame.", tf::resolve(tf_prefix_, global_frame).c_str(), tf::resolve(tf_prefix_, start.header.frame_id).c_str());
+        return false;
+    }
+
+    double wx = start.pose.position.x;
+    double wy = start.pose.position.y;
+
+    unsigned int start_x_i, start_y_i;
+    double start_x, start_y;
+    if (!costmap_->worldToMap(wx, wy, start_x_i, start_y_i)) {
+        ROS_WARN(
+                "The robot's start position is off the global costmap. Planning will always fail, are you sure the robot has been properly localized?");
+        return false;
+    }
+    if(old_navfn_behavior_){
+        start_x = start_x_i;
+        start_y = start_y_i;
+    }else{
+        worldToMap(wx, wy, start_x, start_y);
+    }
+
+    int nx = costmap_->getSizeInCellsX(), ny = costmap_->getSizeInCellsY();
+
+    //the goals that are in another frame or off the map are left unreachable
+    std::vector<std::pair<double, double> > goal_points(goals.size());
+    std::vector<int> goal_cells(goals.size(), -1);
+    std::vector<int> targets;
+    for (unsigned int i = 0; i < goals.size(); i++) {
+        if (tf::resolve(tf_prefix_, goals[i].header.frame_id) != tf::resolve(tf_prefix_, global_frame)) {
+            ROS_ERROR(
+                    "The goal poses passed to this planner must be in the %s frame.  Goal %u is in the %s frame.", tf::resolve(tf_prefix_, global_frame).c_str(), i, tf::resolve(tf_prefix_, goals[i].header.frame_id).c_str());
+            continue;
+        }
+        unsigned int goal_x_i, goal_y_i;
+        wx = goals[i].pose.position.x;
+        wy = goals[i].pose.position.y;
+        if (!costmap_->worldToMap(wx, wy, goal_x_i, goal_y_i)) {
+            ROS_WARN_THROTTLE(1.0,
+                    "Goal %u sent to the global planner is off the global costmap. Planning will always fail to this goal.", i);
+            continue;
+        }
+        if(old_navfn_behavior_)
+            goal_points[i] = std::make_pair((double) goal_x_i, (double) goal_y_i);
+        else
+            worldToMap(wx, wy, goal_points[i].first, goal_points[i].second);
+        goal_cells[i] = goal_y_i * nx + goal_x_i;
+        targets.push_back(goal_cells[i]);
+    }
+
+    if (targets.empty())
+        return false;
+
+    //clear the starting cell within the costmap because we know it can't be an obstacle
+    tf::Stamped<tf::Pose> start_pose;
+    tf::poseStampedMsgToTF(start, start_pose);
+    clearRobotCell(start_pose, start_x_i, start_y_i);
+
+    //the batch queries run on the Dijkstra expansion of the single goal plans, other planners get one on first use
+    if (!batch_planner_) {
+        batch_planner_ = dynamic_cast<DijkstraExpansion*>(planner_);
+        if (batch_planner_) {
+            batch_path_maker_ = path_maker_;
+        } else {
+            batch_planner_ = new DijkstraExpansion(p_calc_, nx, ny);
+            batch_planner_->setPreciseStart(!old_navfn_behavior_);
+            batch_planner_->setHasUnknown(allow_unknown_);
+            batch_planner_->setLethalCost(lethal_cost_);
+            batch_planner_->setNeutralCost(neutral_cost_);
+            batch_planner_->setFactor(cost_factor_);
+            if (use_grid_path_)
+                batch_path_maker_ = new GridPath(p_calc_);
+            else
+                batch_path_maker_ = new GradientPath(p_calc_);
+            batch_path_maker_->setLethalCost(lethal_cost_);
+        }
+    }
+
+    p_calc_->setSize(nx, ny);
+    batch_planner_->setSize(nx, ny);
+    batch_path_maker_->setSize(nx, ny);
+    resizePotentialArray(nx * ny);
+
+    outlineMap(costmap_->getCharMap(), nx, ny, costmap_2d::LETHAL_OBSTACLE);
+
+    //one expansion from the robot, which only stops once it has settled every goal
+    batch_planner_->setTargets(targets);
+    batch_planner_->calculatePotentials(costmap_->getCharMap(), start_x, start_y, targets[0] % nx, targets[0] / nx,
+                                        nx * ny * 2, potential_array_);
+    batch_planner_->setTargets(std::vector<int>());
+    ROS_DEBUG("Expanded %d cells for %d goals", batch_planner_->getCellsVisited(), (int) targets.size());
+
+    bool found_legal = false;
+    std::vector<int> around_cells;
+    for (unsigned int i = 0; i < goals.size(); i++) {
+        if (goal_cells[i] < 0 || batch_planner_->getPotential(potential_array_, goal_cells[i]) >= POT_HIGH)
+            continue;
+        costs[i] = potential_array_[goal_cells[i]];
+        found_legal = true;
+        if (!plans)
+            continue;
+
+        //the cells around each goal are cleared like the single goal planner does, and put back for the next goal
+        std::vector<geometry_msgs::PoseStamped>& plan = (*plans)[i];
+        float around_goal[25];
+        cellsAroundGoal(goal_cells[i], nx, ny, around_cells);
+        for (unsigned int j = 0; j < around_cells.size(); j++)
+            around_goal[j] = batch_planner_->getPotential(potential_array_, around_cells[j]);
+        if(!old_navfn_behavior_)
+            batch_planner_->clearEndpoint(costmap_->getCharMap(), potential_array_, goal_cells[i] % nx,
+                                          goal_cells[i] / nx, 2);
+        getPlanFromPotential(batch_path_maker_, potential_array_, start_x, start_y, goal_points[i].first,
+                             goal_points[i].second, goals[i], plan);
+        for (unsigned int j = 0; j < around_cells.size(); j++)
+            potential_array_[around_cells[j]] = around_goal[j];
+
+        if (!plan.empty()) {
+            //make sure the goal we push on has the same timestamp as the rest of the plan
+            geometry_msgs::PoseStamped goal_copy = goals[i];
+            goal_copy.header.stamp = ros::Time::now();
+            plan.push_back(goal_copy);
+        }
+        orientation_filter_->processPath(start, plan);
+    }
+
+    return found_legal;
+}
+
+void GlobalPlanner::improvedPotential(float* potential, double start_x, double start_y, double goal_x, double goal_y,
+                                      const geometry_msgs::PoseStamped& start, const geometry_msgs::PoseStamped& goal) {
+    std::vector<geometry_msgs::PoseStamped> plan;
+    if(!old_navfn_behavior_) {
+        // the cells around the goal are put back, so that the search can go on with them
+        unsigned int goal_x_i, goal_y_i;
+        costmap_->worldToMap(goal.pose.position.x, goal.pose.position.y, goal_x_i, goal_y_i);
+        int nx = costmap_->getSizeInCellsX(), ny = costmap_->getSizeInCellsY();
+        std::vector<int> around_cells;
+        cellsAroundGoal(goal_y_i * nx + goal_x_i, nx, ny, around_cells);
+        float around_goal[25];
+        for (unsigned int j = 0; j < around_cells.size(); j++)
+            around_goal[j] = planner_->getPotential(potential, around_cells[j]);
+        planner_->clearEndpoint(costmap_->getCharMap(), potential, goal_x_i, goal_y_i, 2);
+        getPlanFromPotential(path_maker_, potential, start_x, start_y, goal_x, goal_y, goal, plan);
+        for (unsigned int j = 0; j < around_cells.size(); j++)
+            potential[around_cells[j]] = around_goal[j];
+    } else
+        getPlanFromPotential(path_maker_, potential, start_x, start_y, goal_x, goal_y, goal, plan);
+    if (plan.empty())
+        return;
+
+    geometry_msgs::PoseStamped goal_copy = goal;
+    goal_copy.header.stamp = ros::Time::now();
+    plan.push_back(goal_copy);
+    orientation_filter_->processPath(start, plan);
+
+    ROS_DEBUG("Anytime planner improved the plan at epsilon %.2f", anytime_planner_->getEpsilon());
+    publishPlan(plan);
+    if (plan_callback_)
+        plan_callback_(plan);
+}
+
 void GlobalPlanner::publishPlan(const std::vector<geometry_msgs::PoseStamped>& path) {
     if (!initialized_) {
         ROS_ERROR(
@@ -351,24 +881,43 @@ void GlobalPlanner::publishPlan(const std::vector<geometry_msgs::PoseStamped>& p
 bool GlobalPlanner::getPlanFromPotential(double start_x, double start_y, double goal_x, double goal_y,
                                       const geometry_msgs::PoseStamped& goal,
                                        std::vector<geometry_msgs::PoseStamped>& plan) {
+    if (!compact_planner_)
+        return getPlanFromPotential(path_maker_, potential_array_, start_x, start_y, goal_x, goal_y, goal, plan);
+
+    plan.clear();
+    std::vector<std::pair<float, float> > path;
+    if (!static_cast<GridPath*>(path_maker_)->getPath(*compact_potential_, start_x, start_y, goal_x, goal_y, path)) {
+        ROS_ERROR("NO PATH!");
+        return false;
+    }
+    return getPlanFromPath(path, goal, plan);
+}
+
+bool GlobalPlanner::getPlanFromPotential(Traceback* path_maker, float* potential, double start_x, double start_y,
+                                         double goal_x, double goal_y, const geometry_msgs::PoseStamped& goal,
+                                         std::vector<geometry_msgs::PoseStamped>& plan) {
     if (!initialized_) {
         ROS_ERROR(
                 "This planner has not been initialized yet, but it is being used, please call initialize() before use");
         return false;
     }
 
-    std::string global_frame = frame_id_;
-
     //clear the plan, just in case
     plan.clear();
 
     std::vector<std::pair<float, float> > path;
 
-    if (!path_maker_->getPath(potential_array_, start_x, start_y, goal_x, goal_y, path)) {
+    if (!path_maker->getPath(potential, start_x, start_y, goal_x, goal_y, path)) {
         ROS_ERROR("NO PATH!");
         return false;
     }
+    return getPlanFromPath(path, goal, plan);
+}
 
+bool GlobalPlanner::getPlanFromPath(const std::vector<std::pair<float, float> >& path,
+                                    const geometry_msgs::PoseStamped& goal,
+                                    std::vector<geometry_msgs::PoseStamped>& plan) {
+    std::string global_frame = frame_id_;
     ros::Time plan_time = ros::Time::now();
     for (int i = path.size() -1; i>=0; i--) {
         std::pair<float, float> point = path[i];
@@ -394,19 +943,20 @@ bool GlobalPlanner::getPlanFromPotential(double start_x, double start_y, double
     return !plan.empty();
 }
 
-void GlobalPlanner::publishPotential(float* potential)
+template<typename Potential>
+void GlobalPlanner::publishPotential(const Potential& potential, const std::vector<geometry_msgs::PoseStamped>& plan)
 {
+    // nothing is copied for nobody
+    if (!potential_publisher_->hasSubscribers())
+        return;
+
     int nx = costmap_->getSizeInCellsX(), ny = costmap_->getSizeInCellsY();
     double resolution = costmap_->getResolution();
     nav_msgs::OccupancyGrid grid;
-    // Publish Whole Grid
     grid.header.frame_id = frame_id_;
     grid.header.stamp = ros::Time::now();
     grid.info.resolution = resolution;
 
-    grid.info.width = nx;
-    grid.info.height = ny;
-
     double wx, wy;
     costmap_->mapToWorld(0, 0, wx, wy);
     grid.info.origin.position.x = wx - resolution / 2;
@@ -414,25 +964,28 @@ void GlobalPlanner::publishPotential(float* potential)
     grid.info.origin.position.z = 0.0;
     grid.info.origin.orientation.w = 1.0;
 
-    grid.data.resize(nx * ny);
-
-    float max = 0.0;
-    for (unsigned int i = 0; i < grid.data.size(); i++) {
-        float potential = potential_array_[i];
-        if (potential < POT_HIGH) {
-            if (potential > max) {
-                max = potential;
-            }
+    // the whole map, or the box around the plan grown by the margin
+    int x0 = 0, y0 = 0, x1 = nx, y1 = ny;
+    if (potential_crop_margin_ > 0 && !plan.empty()) {
+        x0 = nx;
+        y0 = ny;
+        x1 = y1 = 0;
+        int margin = potential_crop_margin_ / resolution;
+        for (unsigned int i = 0; i < plan.size(); i++) {
+            int mx, my;
+            costmap_->worldToMapEnforceBounds(plan[i].pose.position.x, plan[i].pose.position.y, mx, my);
+            x0 = std::min(x0, mx - margin);
+            y0 = std::min(y0, my - margin);
+            x1 = std::max(x1, mx + margin + 1);
+            y1 = std::max(y1, my + margin + 1);
         }
+        x0 = std::max(0, x0);
+        y0 = std::max(0, y0);
+        x1 = std::min(nx, x1);
+        y1 = std::min(ny, y1);
     }
 
-    for (unsigned int i = 0; i < grid.data.size(); i++) {
-        if (potential_array_[i] >= POT_HIGH) {
-            grid.data[i] = -1;
-        } else
-            grid.data[i] = potential_array_[i] * publish_scale_ / max;
-    }
-    potential_pub_.publish(grid);
+    potential_publisher_->publish(potential, nx, x0, y0, x1, y1, potential_downsample_, grid, publish_scale_);
 }
 
 } //end namespace global_planner
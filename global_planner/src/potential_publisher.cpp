@@ -0,0 +1,87 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/potential_publisher.h>
+
+namespace global_planner {
+
+PotentialPublisher::PotentialPublisher(ros::NodeHandle& nh, const std::string& topic) :
+        pending_(false), stop_(false), max_(0.0), scale_(100) {
+    publisher_ = nh.advertise<nav_msgs::OccupancyGrid>(topic, 1);
+    thread_ = new boost::thread(boost::bind(&PotentialPublisher::publishThread, this));
+}
+
+PotentialPublisher::~PotentialPublisher() {
+    {
+        boost::mutex::scoped_lock lock(mutex_);
+        stop_ = true;
+        condition_.notify_one();
+    }
+    thread_->join();
+    delete thread_;
+}
+
+void PotentialPublisher::publishThread() {
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    while (true) {
+        while (!pending_ && !stop_)
+            condition_.wait(lock);
+        if (stop_)
+            return;
+
+        nav_msgs::OccupancyGrid grid = grid_;
+        std::vector<float> values;
+        values.swap(values_);
+        float max = max_;
+        int scale = scale_;
+        pending_ = false;
+        lock.unlock();
+
+        grid.data.resize(values.size());
+        for (unsigned int i = 0; i < values.size(); i++) {
+            if (values[i] >= POT_HIGH)
+                grid.data[i] = -1;
+            else
+                grid.data[i] = max > 0 ? values[i] * scale / max : 0;
+        }
+        publisher_.publish(grid);
+
+        lock.lock();
+    }
+}
+
+} //end namespace global_planner
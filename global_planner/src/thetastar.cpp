@@ -0,0 +1,171 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/thetastar.h>
+#include <math.h>
+#include <stdlib.h>
+
+namespace global_planner {
+
+ThetaStarExpansion::ThetaStarExpansion(PotentialCalculator* p_calc, int nx, int ny) :
+        Expander(p_calc, nx, ny), epoch_(0) {
+    setSize(nx, ny);
+}
+
+void ThetaStarExpansion::setSize(int nx, int ny) {
+    Expander::setSize(nx, ny);
+    if ((int) parent_.size() != ns_) {
+        parent_.assign(ns_, -1);
+        closed_.assign(ns_, 0);
+        epoch_ = 0;
+    }
+}
+
+float ThetaStarExpansion::lineCost(unsigned char* costs, int a, int b) {
+    int x = a % nx_, y = a / nx_;
+    int x1 = b % nx_, y1 = b / nx_;
+    int dx = abs(x1 - x), dy = abs(y1 - y);
+    int sx = x1 > x ? 1 : -1, sy = y1 > y ? 1 : -1;
+
+    // bresenham, as in Costmap2D::raytraceLine, except that a diagonal step needs
+    // both cells beside it to be free, since the line passes through one of them
+    float sum = 0;
+    int cells = 0, error = dx - dy;
+    while (true) {
+        int n = toIndex(x, y);
+        if (!traversable(costs, n))
+            return POT_HIGH;
+        sum += costs[n] + neutral_cost_;
+        cells++;
+        if (x == x1 && y == y1)
+            break;
+        int e2 = 2 * error;
+        bool step_x = e2 > -dy, step_y = e2 < dx;
+        if (step_x && step_y && (!traversable(costs, n + sx) || !traversable(costs, n + sy * nx_)))
+            return POT_HIGH;
+        if (step_x) {
+            error -= dy;
+            x += sx;
+        }
+        if (step_y) {
+            error += dx;
+            y += sy;
+        }
+    }
+    return sqrt(dx * dx + dy * dy) * sum / cells;
+}
+
+bool ThetaStarExpansion::calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x,
+                                             double end_y, int cycles, float* potential) {
+    resetPotential();
+    if (++epoch_ == 0) {
+        std::fill(closed_.begin(), closed_.end(), 0);
+        epoch_ = 1;
+    }
+    queue_.clear();
+    cells_visited_ = 0;
+
+    int start_i = toIndex(start_x, start_y), goal_i = toIndex(end_x, end_y);
+    int gx = end_x, gy = end_y;
+    setPotential(potential, start_i, 0);
+    parent_[start_i] = start_i;
+    queue_.push_back(Index(start_i, 0));
+
+    int offsets[8] = { -1, 1, -nx_, nx_, -nx_ - 1, -nx_ + 1, nx_ - 1, nx_ + 1 };
+
+    int cycle = 0;
+    while (queue_.size() > 0 && cycle < cycles) {
+        Index top = queue_[0];
+        std::pop_heap(queue_.begin(), queue_.end(), greater1());
+        queue_.pop_back();
+        int i = top.i;
+        if (closed_[i] == epoch_)
+            continue;
+
+        // the line to the parent was assumed free when the cell was reached, check it now
+        int parent = parent_[i];
+        float line = parent == i ? 0 : lineCost(costs, parent, i);
+        if (line < POT_HIGH)
+            setPotential(potential, i, potential[parent] + line);
+        else {
+            float best = POT_HIGH;
+            parent_[i] = -1;
+            for (int k = 0; k < 8; k++) {
+                int n = i + offsets[k];
+                if (n < 0 || n >= ns_ || closed_[n] != epoch_)
+                    continue;
+                float g = potential[n] + lineCost(costs, n, i);
+                if (g < best) {
+                    best = g;
+                    parent_[i] = n;
+                }
+            }
+            setPotential(potential, i, best);
+            // squeezed diagonally between two obstacles, wait until a neighbor reaches it straight
+            if (best >= POT_HIGH)
+                continue;
+        }
+
+        closed_[i] = epoch_;
+        cells_visited_++;
+        cycle++;
+        if (i == goal_i)
+            return true;
+
+        parent = parent_[i];
+        for (int k = 0; k < 8; k++) {
+            int n = i + offsets[k];
+            if (n < 0 || n >= ns_ || closed_[n] == epoch_ || !traversable(costs, n))
+                continue;
+
+            // lazily assume the parent of the expanded cell sees the neighbor
+            int px = parent % nx_ - n % nx_, py = parent / nx_ - n / nx_;
+            float g = potential[parent] + sqrt(px * px + py * py) * (costs[parent] + costs[n] + 2 * neutral_cost_) / 2;
+            if (g < potential[n]) {
+                setPotential(potential, n, g);
+                parent_[n] = parent;
+                int hx = n % nx_ - gx, hy = n / nx_ - gy;
+                queue_.push_back(Index(n, g + sqrt(hx * hx + hy * hy) * neutral_cost_));
+                std::push_heap(queue_.begin(), queue_.end(), greater1());
+            }
+        }
+    }
+
+    return false;
+}
+
+} //end namespace global_planner
@@ -0,0 +1,72 @@
+/*********************************************************************
+ *
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2008, 2013, Willow Garage, Inc.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Willow Garage, Inc. nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ * Author: Eitan Marder-Eppstein
+ *         David V. Lu!!
+ *********************************************************************/
+#include <global_planner/thetastar_path.h>
+#include <math.h>
+
+namespace global_planner {
+
+bool ThetaStarPath::getPath(float* potential, double start_x, double start_y, double end_x, double end_y,
+                            std::vector<std::pair<float, float> >& path) {
+    int start_index = getIndex(start_x, start_y);
+    int index = getIndex(end_x, end_y);
+    if (expansion_->getParent(index) < 0)
+        return false;
+
+    path.push_back(std::make_pair(end_x, end_y));
+    int ns = xs_ * ys_;
+    for (int c = 0; index != start_index; c++) {
+        int parent = expansion_->getParent(index);
+        if (parent < 0 || c > ns)
+            return false;
+
+        std::pair<float, float> from = path.back();
+        float x = parent % xs_, y = parent / xs_;
+        float length = hypot(x - from.first, y - from.second);
+        if (max_step_ > 0) {
+            int steps = ceil(length / max_step_);
+            for (int i = 1; i < steps; i++)
+                path.push_back(std::make_pair(from.first + (x - from.first) * i / steps,
+                                              from.second + (y - from.second) * i / steps));
+        }
+        path.push_back(std::make_pair(x, y));
+        index = parent;
+    }
+    return true;
+}
+
+} //end namespace global_planner
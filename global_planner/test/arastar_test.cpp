@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <boost/bind.hpp>
+#include <vector>
+
+#include <costmap_2d/cost_values.h>
+#include <global_planner/arastar.h>
+#include <global_planner/dijkstra.h>
+#include <global_planner/quadratic_calculator.h>
+#include "test_utils.h"
+
+using namespace global_planner;
+
+struct Improvements
+{
+  Improvements(int goal) : goal(goal) {}
+  void add(float* potential)
+  {
+    goal_potentials.push_back(potential[goal]);
+  }
+  int goal;
+  std::vector<float> goal_potentials;
+};
+
+// every reached cell but the start has a neighbor with a lower potential
+bool descends(const std::vector<float>& potential, int nx, int start)
+{
+  for (int n = nx; n < (int) potential.size() - nx; n++)
+  {
+    if (n == start || potential[n] >= POT_HIGH)
+      continue;
+    float lowest = std::min(std::min(potential[n - 1], potential[n + 1]), std::min(potential[n - nx], potential[n + nx]));
+    if (lowest >= potential[n])
+      return false;
+  }
+  return true;
+}
+
+TEST(ARAStarExpansion, improves_until_epsilon_one)
+{
+  int nx = 150, ny = 120;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 11, 60);
+  QuadraticCalculator p_calc(nx, ny);
+  ARAStarExpansion ara(&p_calc, nx, ny);
+  DijkstraExpansion dijkstra(&p_calc, nx, ny);
+  ara.setSize(nx, ny);
+  dijkstra.setSize(nx, ny);
+  ara.setEpsilon(5.0, 1.0);
+
+  int gx = nx - 6, gy = ny - 6, goal = gx + gy * nx;
+  Improvements improvements(goal);
+  ara.setImprovedCallback(boost::bind(&Improvements::add, &improvements, _1));
+
+  std::vector<float> p1(nx * ny), p2(nx * ny);
+  EXPECT_TRUE(ara.calculatePotentials(&costs[0], 5, 5, gx, gy, nx * ny * 2, &p1[0]));
+  EXPECT_EQ(1.0, ara.getEpsilon());
+  EXPECT_TRUE(descends(reachedPotential(ara, p1), nx, 5 + 5 * nx));
+
+  // one callback per search before the last, each with a plan that is no worse than the one before
+  ASSERT_EQ(4u, improvements.goal_potentials.size());
+  for (unsigned int i = 1; i < improvements.goal_potentials.size(); i++)
+    EXPECT_LE(improvements.goal_potentials[i], improvements.goal_potentials[i - 1]);
+  EXPECT_LE(p1[goal], improvements.goal_potentials.back());
+
+  EXPECT_TRUE(dijkstra.calculatePotentials(&costs[0], 5, 5, gx, gy, nx * ny * 2, &p2[0]));
+  EXPECT_LE(improvements.goal_potentials[0], 5.0 * p2[goal]);
+}
+
+TEST(ARAStarExpansion, each_plan_is_within_epsilon_of_the_optimal_one)
+{
+  // a costly band across the straight line to the goal, which is cheaper to go around
+  int nx = 60, ny = 40;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 0, 0);
+  for (int y = 1; y < 16; y++)
+    for (int x = 25; x < 35; x++)
+      costs[y * nx + x] = 200;
+  PotentialCalculator p_calc(nx, ny);
+  ARAStarExpansion ara(&p_calc, nx, ny);
+  ara.setSize(nx, ny);
+  ara.setEpsilon(5.0, 1.0);
+
+  int goal = 50 + 5 * nx;
+  Improvements improvements(goal);
+  ara.setImprovedCallback(boost::bind(&Improvements::add, &improvements, _1));
+  std::vector<float> potential(nx * ny);
+  ASSERT_TRUE(ara.calculatePotentials(&costs[0], 10, 5, 50, 5, nx * ny * 2, &potential[0]));
+
+  // the searches with epsilon 5, 4, 3 and 2, and the last one is optimal
+  float optimal = gridPotential(costs, nx, 10 + 5 * nx, goal);
+  ASSERT_EQ(4u, improvements.goal_potentials.size());
+  for (unsigned int i = 0; i < improvements.goal_potentials.size(); i++)
+  {
+    EXPECT_GE(improvements.goal_potentials[i], optimal);
+    EXPECT_LE(improvements.goal_potentials[i], (5.0 - i) * optimal);
+  }
+  // the first plan takes the band, the last one goes around it
+  EXPECT_GT(improvements.goal_potentials[0], optimal);
+  EXPECT_EQ(optimal, potential[goal]);
+}
+
+TEST(ARAStarExpansion, budget_keeps_a_valid_potential)
+{
+  int nx = 150, ny = 120;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 11, 60);
+  QuadraticCalculator p_calc(nx, ny);
+  ARAStarExpansion ara(&p_calc, nx, ny);
+  ara.setSize(nx, ny);
+  ara.setEpsilon(5.0, 0.01);
+  ara.setTimeBudget(1e-9);
+
+  std::vector<float> potential(nx * ny);
+  ara.calculatePotentials(&costs[0], 5, 5, nx - 6, ny - 6, nx * ny * 2, &potential[0]);
+  EXPECT_GT(ara.getEpsilon(), 1.0);
+  EXPECT_TRUE(descends(reachedPotential(ara, potential), nx, 5 + 5 * nx));
+
+  // running out of cycles stops the search the same way
+  ara.setTimeBudget(0.0);
+  EXPECT_FALSE(ara.calculatePotentials(&costs[0], 5, 5, nx - 6, ny - 6, 10, &potential[0]));
+  EXPECT_TRUE(descends(reachedPotential(ara, potential), nx, 5 + 5 * nx));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
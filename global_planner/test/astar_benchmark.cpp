@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * Compares the binary heap and the bucket queue open lists of AStarExpansion
+ * on the willow garage costmap used by the navfn tests.
+ *
+ * usage: astar_benchmark [costmap.pgm] [number of plans]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <ros/package.h>
+#include <ros/time.h>
+#include <costmap_2d/cost_values.h>
+#include <global_planner/astar.h>
+#include <global_planner/quadratic_calculator.h>
+#include "benchmark_utils.h"
+
+using namespace global_planner;
+
+int main(int argc, char** argv)
+{
+  ros::Time::init();
+
+  std::string path = argc > 1 ? argv[1] : ros::package::getPath("navfn") + "/test/willow_costmap.pgm";
+  int plans = argc > 2 ? atoi(argv[2]) : 50;
+
+  std::vector<unsigned char> costs;
+  int nx, ny;
+  if (!readCostmap(path, costs, nx, ny))
+  {
+    fprintf(stderr, "Could not read costmap %s\n", path.c_str());
+    return 1;
+  }
+  fromNavfnCosts(costs);
+
+  outlineMap(costs, nx, ny);
+
+  std::vector<int> free_cells;
+  for (int i = 0; i < nx * ny; i++)
+    if (costs[i] == costmap_2d::FREE_SPACE)
+      free_cells.push_back(i);
+
+  QuadraticCalculator p_calc(nx, ny);
+  AStarExpansion heap(&p_calc, nx, ny), buckets(&p_calc, nx, ny);
+  buckets.setUseBucketQueue(true);
+  std::vector<float> heap_potential(nx * ny), bucket_potential(nx * ny);
+
+  srand(0);
+  double heap_time = 0.0, bucket_time = 0.0, max_difference = 0.0;
+  int found = 0, mismatched = 0;
+  for (int p = 0; p < plans; p++)
+  {
+    int start = free_cells[rand() % free_cells.size()], goal = free_cells[rand() % free_cells.size()];
+    int sx = start % nx, sy = start / nx, gx = goal % nx, gy = goal / nx;
+
+    ros::WallTime t0 = ros::WallTime::now();
+    bool heap_found = heap.calculatePotentials(&costs[0], sx, sy, gx, gy, nx * ny * 2, &heap_potential[0]);
+    ros::WallTime t1 = ros::WallTime::now();
+    bool bucket_found = buckets.calculatePotentials(&costs[0], sx, sy, gx, gy, nx * ny * 2, &bucket_potential[0]);
+    ros::WallTime t2 = ros::WallTime::now();
+
+    heap_time += (t1 - t0).toSec();
+    bucket_time += (t2 - t1).toSec();
+    if (heap_found != bucket_found)
+      mismatched++;
+    else if (heap_found)
+    {
+      found++;
+      max_difference = std::max(max_difference, fabs(heap_potential[goal] - bucket_potential[goal])
+                                                / std::max(1.0f, heap_potential[goal]));
+    }
+  }
+
+  printf("%s: %d x %d, %d plans, %d found, %d mismatched\n", path.c_str(), nx, ny, plans, found, mismatched);
+  printf("binary heap:  %8.3f ms per plan\n", heap_time * 1e3 / plans);
+  printf("bucket queue: %8.3f ms per plan\n", bucket_time * 1e3 / plans);
+  printf("speedup %.2f, largest relative difference of the goal potential %.4f\n", heap_time / bucket_time,
+         max_difference);
+  return 0;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _GLOBAL_PLANNER_BENCHMARK_UTILS_H
+#define _GLOBAL_PLANNER_BENCHMARK_UTILS_H
+
+#include <cstdio>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <costmap_2d/cost_values.h>
+#include "test_utils.h"
+
+namespace global_planner {
+
+/**
+ * Reads a binary (P5) pgm file holding navfn costs, like the raw maps of read_pgm_costmap.
+ */
+inline bool readCostmap(const std::string& path, std::vector<unsigned char>& costs, int& nx, int& ny)
+{
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+
+  int maxval;
+  bool ok = fscanf(file, "P5 %d %d %d", &nx, &ny, &maxval) == 3 && maxval < 256;
+  fgetc(file);
+
+  if (ok)
+  {
+    costs.resize(nx * ny);
+    ok = fread(&costs[0], 1, costs.size(), file) == costs.size();
+  }
+  fclose(file);
+  return ok;
+}
+
+/**
+ * Converts navfn costs back to costmap values, navfn adds a neutral cost of 50 to every traversable cell
+ */
+inline void fromNavfnCosts(std::vector<unsigned char>& costs)
+{
+  for (unsigned int i = 0; i < costs.size(); i++)
+    if (costs[i] < costmap_2d::INSCRIBED_INFLATED_OBSTACLE)
+      costs[i] = std::max(0, costs[i] - 50);
+}
+
+/**
+ * Makes the border of the map lethal, like the planner does before expanding
+ */
+inline void outlineMap(std::vector<unsigned char>& costs, int nx, int ny)
+{
+  for (int x = 0; x < nx; x++)
+    costs[x] = costs[(ny - 1) * nx + x] = costmap_2d::LETHAL_OBSTACLE;
+  for (int y = 0; y < ny; y++)
+    costs[y * nx] = costs[y * nx + nx - 1] = costmap_2d::LETHAL_OBSTACLE;
+}
+
+}  // namespace global_planner
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <vector>
+
+#include <costmap_2d/cost_values.h>
+#include <global_planner/bidirectional.h>
+#include <global_planner/dijkstra.h>
+#include <global_planner/quadratic_calculator.h>
+#include "test_utils.h"
+
+using namespace global_planner;
+
+// plans between random free cells, some of them walled in
+void expectDijkstraCosts(PotentialCalculator* p_calc, bool use_heuristic, float tolerance)
+{
+  int nx = 160, ny = 120;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 23, 120);
+  for (int y = 60; y < 67; y++)
+    for (int x = 100; x < 107; x++)
+      costs[y * nx + x] = y == 60 || y == 66 || x == 100 || x == 106 ? costmap_2d::LETHAL_OBSTACLE : 0;
+
+  DijkstraExpansion dijkstra(p_calc, nx, ny);
+  BidirectionalExpansion bidirectional(p_calc, nx, ny);
+  dijkstra.setSize(nx, ny);
+  bidirectional.setUseHeuristic(use_heuristic);
+  // the same cost of a cell as the bidirectional search, which does not scale it
+  dijkstra.setFactor(1.0);
+
+  std::vector<float> expected(nx * ny), potential(nx * ny);
+  srand(3);
+  int found = 0, blocked = 0;
+  for (int i = 0; i < 40; i++)
+  {
+    int sx = 1 + rand() % (nx - 2), sy = 1 + rand() % (ny - 2);
+    int ex = i % 4 ? 1 + rand() % (nx - 2) : 103, ey = i % 4 ? 1 + rand() % (ny - 2) : 63;
+    if (costs[sx + sy * nx] >= costmap_2d::INSCRIBED_INFLATED_OBSTACLE ||
+        costs[ex + ey * nx] >= costmap_2d::INSCRIBED_INFLATED_OBSTACLE)
+      continue;
+
+    int end = ex + ey * nx;
+    bool reached = dijkstra.calculatePotentials(&costs[0], sx, sy, ex, ey, nx * ny * 2, &expected[0]);
+    ASSERT_EQ(reached, bidirectional.calculatePotentials(&costs[0], sx, sy, ex, ey, nx * ny * 2, &potential[0]))
+        << "from " << sx << ", " << sy << " to " << ex << ", " << ey;
+    if (reached)
+    {
+      EXPECT_NEAR(expected[end], potential[end], expected[end] * tolerance)
+          << "from " << sx << ", " << sy << " to " << ex << ", " << ey;
+      found++;
+    }
+    else
+      blocked++;
+  }
+  EXPECT_GT(found, 10);
+  EXPECT_GT(blocked, 0);
+}
+
+TEST(BidirectionalExpansion, matches_dijkstra)
+{
+  // exact up to the priority blocks of DijkstraExpansion
+  PotentialCalculator p_calc(160, 120);
+  expectDijkstraCosts(&p_calc, false, 3e-2);
+}
+
+TEST(BidirectionalExpansion, heuristic_matches_dijkstra)
+{
+  // like AStarExpansion, a cell keeps the potential of the first neighbor it was reached from
+  PotentialCalculator p_calc(160, 120);
+  expectDijkstraCosts(&p_calc, true, 8e-2);
+}
+
+TEST(BidirectionalExpansion, quadratic_matches_dijkstra)
+{
+  // the interpolation only sees the neighbors that the search reached, which are fewer with the heuristic
+  QuadraticCalculator p_calc(160, 120);
+  expectDijkstraCosts(&p_calc, false, 6e-2);
+  expectDijkstraCosts(&p_calc, true, 2e-1);
+}
+
+TEST(BidirectionalExpansion, meets_on_the_cheapest_path)
+{
+  // a wall with a gap at each end, the one at the bottom through cells of a higher cost
+  int nx = 100, ny = 100;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 0, 0);
+  for (int y = 10; y < 80; y++)
+    costs[y * nx + 50] = costmap_2d::LETHAL_OBSTACLE;
+  for (int y = 1; y < 10; y++)
+    for (int x = 45; x < 56; x++)
+      costs[y * nx + x] = 150;
+  PotentialCalculator p_calc(nx, ny);
+  BidirectionalExpansion bidirectional(&p_calc, nx, ny);
+  bidirectional.setUseHeuristic(false);
+
+  // the cheapest path takes the costly gap over the long way around, from either side
+  std::vector<float> potential(nx * ny);
+  ASSERT_TRUE(bidirectional.calculatePotentials(&costs[0], 20, 30, 80, 30, nx * ny * 2, &potential[0]));
+  float optimal = gridPotential(costs, nx, 20 + 30 * nx, 80 + 30 * nx);
+  EXPECT_EQ(optimal, potential[80 + 30 * nx]);
+  ASSERT_TRUE(bidirectional.calculatePotentials(&costs[0], 80, 30, 20, 30, nx * ny * 2, &potential[0]));
+  EXPECT_EQ(optimal, potential[20 + 30 * nx]);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
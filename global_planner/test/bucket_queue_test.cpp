@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include <global_planner/bucket_queue.h>
+
+using namespace global_planner;
+
+TEST(BucketQueue, pops_in_order_of_buckets)
+{
+  BucketQueue queue;
+  queue.clear(8);
+  EXPECT_TRUE(queue.empty());
+
+  std::vector<float> priorities;
+  priorities.push_back(0.5);
+  priorities.push_back(7.9);
+  priorities.push_back(3.7);
+  priorities.push_back(3.2);
+  priorities.push_back(8.0);
+  for (unsigned int i = 0; i < priorities.size(); i++)
+    queue.push(i, priorities[i]);
+
+  // 3.2 and 3.7 share a bucket, and may come out in either order
+  EXPECT_FALSE(queue.empty());
+  int last = -1;
+  for (unsigned int i = 0; i < priorities.size(); i++)
+  {
+    int bucket = priorities[queue.pop()];
+    EXPECT_LE(last, bucket);
+    last = bucket;
+  }
+  EXPECT_EQ(8, last);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(BucketQueue, wraps_around_the_ring)
+{
+  // an expansion that pushes priorities up to 20 above the one it popped goes many times around 32 buckets
+  BucketQueue queue;
+  queue.clear(20);
+  std::vector<float> priorities;
+  std::multiset<int> pending;
+  // the first push, like the start of a search, has the smallest priority
+  priorities.push_back(100.0);
+  queue.push(0, 100.0);
+  pending.insert(100);
+  srand(5);
+  for (int i = 1; i < 10; i++)
+  {
+    priorities.push_back(100 + (rand() % 2000) / 100.0);
+    queue.push(i, priorities[i]);
+    pending.insert(priorities[i]);
+  }
+
+  int popped = 0;
+  while (!queue.empty())
+  {
+    int i = queue.pop();
+    int bucket = priorities[i];
+    ASSERT_EQ(*pending.begin(), bucket) << "pop " << popped;
+    pending.erase(pending.begin());
+    if (++popped < 2000)
+    {
+      float priority = priorities[i] + (rand() % 2000) / 100.0;
+      queue.push(priorities.size(), priority);
+      priorities.push_back(priority);
+      pending.insert(priority);
+    }
+  }
+  EXPECT_TRUE(pending.empty());
+  EXPECT_GT(priorities.back(), 100 + 32 * 10);
+}
+
+TEST(BucketQueue, clamps_priorities_to_the_ring)
+{
+  BucketQueue queue;
+  queue.clear(4);
+  queue.push(0, 10.0);
+  queue.push(1, 30.0);
+  queue.push(2, 12.0);
+  // 30 is beyond the ring and goes into the last bucket, 17, which is still after 12
+  EXPECT_EQ(0, queue.pop());
+  EXPECT_EQ(2, queue.pop());
+  // a priority below the current bucket goes into the current one
+  queue.push(3, 5.0);
+  EXPECT_EQ(3, queue.pop());
+  EXPECT_EQ(1, queue.pop());
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(BucketQueue, clear_starts_a_new_search)
+{
+  BucketQueue queue;
+  queue.clear(16);
+  queue.push(0, 50.0);
+  queue.push(1, 60.0);
+  queue.push(2, 55.0);
+  EXPECT_EQ(0, queue.pop());
+
+  // the cells left from the last search are dropped, and the new one starts at its own first priority
+  queue.clear(4);
+  EXPECT_TRUE(queue.empty());
+  queue.push(3, 1.0);
+  queue.push(4, 3.5);
+  queue.push(5, 2.0);
+  EXPECT_EQ(3, queue.pop());
+  EXPECT_EQ(5, queue.pop());
+  EXPECT_EQ(4, queue.pop());
+  EXPECT_TRUE(queue.empty());
+
+  // clearing an empty queue keeps it empty
+  queue.clear(4);
+  EXPECT_TRUE(queue.empty());
+  queue.push(6, 7.0);
+  EXPECT_EQ(6, queue.pop());
+  EXPECT_TRUE(queue.empty());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
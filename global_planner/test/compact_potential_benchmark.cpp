@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * Compares DijkstraExpansion on a float potential with CompactDijkstraExpansion on a
+ * CompactPotential, in memory, time and the plans that are traced on the grid from them.
+ * The map can be scaled up, every cell becoming scale x scale cells, to get close to the
+ * sizes the compact potential is meant for.
+ *
+ * usage: compact_potential_benchmark [costmap.pgm] [number of plans] [scale]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <ros/package.h>
+#include <ros/time.h>
+#include <costmap_2d/cost_values.h>
+#include <global_planner/compact_dijkstra.h>
+#include <global_planner/dijkstra.h>
+#include <global_planner/grid_path.h>
+#include <global_planner/quadratic_calculator.h>
+#include "benchmark_utils.h"
+
+using namespace global_planner;
+
+int main(int argc, char** argv)
+{
+  ros::Time::init();
+
+  std::string path = argc > 1 ? argv[1] : ros::package::getPath("navfn") + "/test/willow_costmap.pgm";
+  int plans = argc > 2 ? atoi(argv[2]) : 20;
+  int scale = argc > 3 ? std::max(1, atoi(argv[3])) : 1;
+
+  std::vector<unsigned char> map;
+  int mx, my;
+  if (!readCostmap(path, map, mx, my))
+  {
+    fprintf(stderr, "Could not read costmap %s\n", path.c_str());
+    return 1;
+  }
+  fromNavfnCosts(map);
+
+  int nx = mx * scale, ny = my * scale;
+  std::vector<unsigned char> costs(nx * ny);
+  for (int y = 0; y < ny; y++)
+    for (int x = 0; x < nx; x++)
+      costs[y * nx + x] = map[(y / scale) * mx + x / scale];
+
+  outlineMap(costs, nx, ny);
+
+  std::vector<int> free_cells;
+  for (int i = 0; i < nx * ny; i++)
+    if (costs[i] == costmap_2d::FREE_SPACE)
+      free_cells.push_back(i);
+
+  QuadraticCalculator p_calc(nx, ny);
+  DijkstraExpansion dijkstra(&p_calc, nx, ny);
+  CompactDijkstraExpansion compact(&p_calc, nx, ny);
+  dijkstra.setSize(nx, ny);
+  compact.setSize(nx, ny);
+  dijkstra.setPreciseStart(true);
+  compact.setPreciseStart(true);
+  GridPath path_maker(&p_calc);
+  path_maker.setSize(nx, ny);
+
+  std::vector<float> float_potential(nx * ny);
+  CompactPotential compact_potential;
+
+  srand(0);
+  double float_time = 0.0, compact_time = 0.0, max_difference = 0.0, length_difference = 0.0;
+  int found = 0, mismatched = 0, saturated = 0;
+  for (int p = 0; p < plans; p++)
+  {
+    int start = free_cells[rand() % free_cells.size()], goal = free_cells[rand() % free_cells.size()];
+    double sx = start % nx + 0.5, sy = start / nx + 0.5;
+    int gx = goal % nx, gy = goal / nx;
+    std::vector<std::pair<float, float> > float_path, compact_path;
+
+    ros::WallTime t0 = ros::WallTime::now();
+    bool float_found = dijkstra.calculatePotentials(&costs[0], sx, sy, gx, gy, nx * ny * 2, &float_potential[0])
+                       && path_maker.getPath(&float_potential[0], sx, sy, gx, gy, float_path);
+    ros::WallTime t1 = ros::WallTime::now();
+    bool compact_found = compact.calculatePotentials(&costs[0], sx, sy, gx, gy, nx * ny * 2, compact_potential)
+                         && path_maker.getPath(compact_potential, sx, sy, gx, gy, compact_path);
+    ros::WallTime t2 = ros::WallTime::now();
+
+    float_time += (t1 - t0).toSec();
+    compact_time += (t2 - t1).toSec();
+    if (compact_potential.isSaturated())
+      saturated++;
+    if (float_found != compact_found)
+      mismatched++;
+    else if (float_found)
+    {
+      found++;
+      max_difference = std::max(max_difference, (double) fabs(float_potential[goal] - compact_potential[goal])
+                                                / std::max(1.0f, float_potential[goal]));
+      length_difference += pathLength(compact_path) / std::max(1.0, pathLength(float_path)) - 1.0;
+    }
+  }
+
+  // the potential and the pending flags of the expanders, the costmap is shared
+  double float_bytes = nx * ny * (sizeof(float) + sizeof(unsigned int));
+  double compact_bytes = compact_potential.getMemoryUsage() + nx * ny * sizeof(unsigned char);
+
+  printf("%s x %d: %d x %d, %d plans, %d found, %d mismatched, %d saturated\n", path.c_str(), scale, nx, ny, plans,
+         found, mismatched, saturated);
+  printf("float:   %8.3f ms per plan, %8.1f MB\n", float_time * 1e3 / plans, float_bytes / (1 << 20));
+  printf("compact: %8.3f ms per plan, %8.1f MB, quantum %.3f\n", compact_time * 1e3 / plans,
+         compact_bytes / (1 << 20), compact_potential.getQuantum());
+  printf("largest relative difference of the goal potential %.4f, mean relative difference of the path length %.4f\n",
+         max_difference, found ? length_difference / found : 0.0);
+  return 0;
+}
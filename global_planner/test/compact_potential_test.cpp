@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2014, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <stdlib.h>
+#include <vector>
+
+#include <costmap_2d/cost_values.h>
+#include <global_planner/compact_dijkstra.h>
+#include <global_planner/dijkstra.h>
+#include <global_planner/grid_path.h>
+#include <global_planner/quadratic_calculator.h>
+#include "test_utils.h"
+
+using namespace global_planner;
+
+TEST(CompactPotential, quantum_grows)
+{
+  CompactPotential potential;
+  potential.reset(4, 0.5, 4.0);
+  EXPECT_EQ(POT_HIGH, potential[0]);
+
+  ASSERT_TRUE(potential.set(0, 10.2));
+  EXPECT_FLOAT_EQ(10.0, potential[0]);
+
+  // does not fit with a quantum of 0.5, so it grows to 1.0
+  ASSERT_TRUE(potential.set(1, 40000.0));
+  EXPECT_FLOAT_EQ(1.0, potential.getQuantum());
+  EXPECT_FLOAT_EQ(40000.0, potential[1]);
+  EXPECT_NEAR(10.2, potential[0], 1.0);
+  EXPECT_EQ(POT_HIGH, potential[2]);
+  EXPECT_FALSE(potential.isSaturated());
+
+  ASSERT_TRUE(potential.set(2, 200000.0));
+  EXPECT_FLOAT_EQ(4.0, potential.getQuantum());
+  EXPECT_FALSE(potential.set(3, 300000.0));
+  EXPECT_TRUE(potential.isSaturated());
+  EXPECT_EQ(POT_HIGH, potential[3]);
+}
+
+TEST(CompactDijkstraExpansion, matches_float_potential)
+{
+  int nx = 300, ny = 300;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 5, nx * ny / 150);
+  QuadraticCalculator p_calc(nx, ny);
+  DijkstraExpansion dijkstra(&p_calc, nx, ny);
+  CompactDijkstraExpansion compact(&p_calc, nx, ny);
+  dijkstra.setSize(nx, ny);
+  compact.setSize(nx, ny);
+  dijkstra.setPreciseStart(true);
+  compact.setPreciseStart(true);
+
+  std::vector<float> expected(nx * ny), decoded(nx * ny);
+  CompactPotential potential;
+  ASSERT_TRUE(dijkstra.calculatePotentials(&costs[0], 5.3, 5.6, nx - 6, ny - 6, nx * ny * 2, &expected[0]));
+  ASSERT_TRUE(compact.calculatePotentials(&costs[0], 5.3, 5.6, nx - 6, ny - 6, nx * ny * 2, potential));
+  ASSERT_TRUE(compact.calculatePotentials(&costs[0], 5.3, 5.6, nx - 6, ny - 6, nx * ny * 2, &decoded[0]));
+  EXPECT_GT(potential.getQuantum(), 50.0 / 256);
+
+  int goal = (nx - 6) + (ny - 6) * nx;
+  // the priority blocks are sensitive to the order of near ties, which the rounding changes
+  EXPECT_NEAR(expected[goal], potential[goal], expected[goal] * 1e-2);
+  EXPECT_FLOAT_EQ(potential[goal], decoded[goal]);
+
+  GridPath float_path(&p_calc), compact_path(&p_calc);
+  float_path.setSize(nx, ny);
+  compact_path.setSize(nx, ny);
+  std::vector<std::pair<float, float> > path, expected_path;
+  ASSERT_TRUE(float_path.getPath(&expected[0], 5.3, 5.6, nx - 6, ny - 6, expected_path));
+  ASSERT_TRUE(compact_path.getPath(potential, 5.3, 5.6, nx - 6, ny - 6, path));
+  EXPECT_NEAR(pathLength(expected_path), pathLength(path), pathLength(expected_path) * 0.03);
+}
+
+TEST(CompactDijkstraExpansion, uses_potential_calculator)
+{
+  int nx = 300, ny = 300;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 5, nx * ny / 150);
+  PotentialCalculator p_calc(nx, ny);
+  QuadraticCalculator q_calc(nx, ny);
+  DijkstraExpansion dijkstra(&p_calc, nx, ny);
+  CompactDijkstraExpansion compact(&p_calc, nx, ny), quadratic(&q_calc, nx, ny);
+  dijkstra.setSize(nx, ny);
+  compact.setSize(nx, ny);
+  quadratic.setSize(nx, ny);
+
+  std::vector<float> expected(nx * ny);
+  CompactPotential potential, quadratic_potential;
+  ASSERT_TRUE(dijkstra.calculatePotentials(&costs[0], 5, 5, nx - 6, ny - 6, nx * ny * 2, &expected[0]));
+  ASSERT_TRUE(compact.calculatePotentials(&costs[0], 5, 5, nx - 6, ny - 6, nx * ny * 2, potential));
+  ASSERT_TRUE(quadratic.calculatePotentials(&costs[0], 5, 5, nx - 6, ny - 6, nx * ny * 2, quadratic_potential));
+
+  // the plain calculator gives 4-connected distances, which are longer than the quadratic ones
+  int goal = (nx - 6) + (ny - 6) * nx;
+  EXPECT_NEAR(expected[goal], potential[goal], expected[goal] * 1e-2);
+  EXPECT_GT(potential[goal], quadratic_potential[goal] * 1.1);
+}
+
+TEST(CompactDijkstraExpansion, rounds_to_the_quantum)
+{
+  // a costly room split into lanes between free ones, so that the potential sums costs other than the neutral one
+  int nx = 120, ny = 60;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 0, 0);
+  for (int y = 1; y < ny - 1; y++)
+    for (int x = 40; x < 80; x++)
+      costs[y * nx + x] = y % 10 ? 120 : costmap_2d::LETHAL_OBSTACLE;
+  PotentialCalculator p_calc(nx, ny);
+  CompactDijkstraExpansion compact(&p_calc, nx, ny);
+  compact.setSize(nx, ny);
+  // the cost of a cell as gridPotential sums it
+  compact.setFactor(1.0);
+
+  CompactPotential potential;
+  ASSERT_TRUE(compact.calculatePotentials(&costs[0], 5, 25, 114, 35, nx * ny * 2, potential));
+
+  // each step rounds by less than a quantum, steps over free cells are a multiple of it
+  int end = 114 + 35 * nx;
+  float optimal = gridPotential(costs, nx, 5 + 25 * nx, end);
+  EXPECT_NEAR(optimal, potential[end], potential.getQuantum() * (109 + 10));
+  EXPECT_FLOAT_EQ(50.0 * 3, potential[8 + 25 * nx]);
+}
+
+TEST(CompactDijkstraExpansion, clear_endpoint_stays_inside_the_border)
+{
+  int nx = 20, ny = 20;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 3, 0);
+  costs[1 + 1 * nx] = costmap_2d::LETHAL_OBSTACLE;
+  PotentialCalculator p_calc(nx, ny);
+  CompactDijkstraExpansion compact(&p_calc, nx, ny);
+  compact.setSize(nx, ny);
+
+  CompactPotential potential;
+  EXPECT_FALSE(compact.calculatePotentials(&costs[0], 10, 10, 1, 1, nx * ny * 2, potential));
+  EXPECT_EQ(POT_HIGH, potential[1 + 1 * nx]);
+
+  // an end point in the corner, whose window reaches over the border
+  compact.clearEndpoint(&costs[0], potential, 1, 1, 2);
+  EXPECT_LT(potential[1 + 1 * nx], POT_HIGH);
+  for (int i = 0; i < nx; i++)
+  {
+    EXPECT_EQ(POT_HIGH, potential[i]) << "cell " << i;
+    EXPECT_EQ(POT_HIGH, potential[i * nx]) << "cell " << i * nx;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <costmap_2d/cost_values.h>
+#include <global_planner/dijkstra.h>
+#include <global_planner/grid_path.h>
+#include <global_planner/quadratic_calculator.h>
+#include <navfn/navfn.h>
+
+using namespace global_planner;
+
+// an outlined map with a wall across the middle, with a gap of 10 cells at y = 20 and y = 70
+std::vector<unsigned char> makeWallCostmap(int nx, int ny)
+{
+  std::vector<unsigned char> costs(nx * ny, 0);
+  for (int y = 0; y < ny; y++)
+    if ((y < 20 || y >= 30) && (y < 70 || y >= 80))
+      costs[y * nx + nx / 2] = costmap_2d::LETHAL_OBSTACLE;
+  for (int x = 0; x < nx; x++)
+    costs[x] = costs[(ny - 1) * nx + x] = costmap_2d::LETHAL_OBSTACLE;
+  for (int y = 0; y < ny; y++)
+    costs[y * nx] = costs[y * nx + nx - 1] = costmap_2d::LETHAL_OBSTACLE;
+  return costs;
+}
+
+// the corridor the way GlobalPlanner::closeCorridor marks it in its bounding box, and closes the cells around it
+// in the costmap. mask is the corridor on the whole map, for the checks
+void closeCorridor(std::vector<unsigned char>& costs, const std::vector<std::pair<float, float> >& path, int radius,
+                   int nx, int ny, std::vector<unsigned char>& mask, std::vector<int>& border,
+                   std::vector<unsigned char>& border_costs)
+{
+  std::vector<int> path_x, path_y;
+  int x0 = nx, y0 = ny, x1 = 0, y1 = 0;
+  for (unsigned int i = 0; i < path.size(); i++)
+  {
+    path_x.push_back(path[i].first);
+    path_y.push_back(path[i].second);
+    x0 = std::min(x0, path_x[i]);
+    y0 = std::min(y0, path_y[i]);
+    x1 = std::max(x1, path_x[i]);
+    y1 = std::max(y1, path_y[i]);
+  }
+  x0 = std::max(0, x0 - radius - 1);
+  y0 = std::max(0, y0 - radius - 1);
+  int bx = std::min(nx - 1, x1 + radius + 1) - x0 + 1, by = std::min(ny - 1, y1 + radius + 1) - y0 + 1;
+  for (unsigned int i = 0; i < path.size(); i++)
+  {
+    path_x[i] -= x0;
+    path_y[i] -= y0;
+  }
+  std::vector<unsigned char> box(bx * by, 0);
+  std::vector<int> cells;
+  navfn::markCorridor(path_x, path_y, radius, bx, by, box, cells);
+
+  mask.assign(nx * ny, 0);
+  border.clear();
+  border_costs.clear();
+  for (unsigned int i = 0; i < cells.size(); i++)
+  {
+    int cx = cells[i] % bx, cy = cells[i] / bx;
+    mask[(cy + y0) * nx + cx + x0] = 1;
+    for (int y = std::max(0, cy - 1); y <= std::min(by - 1, cy + 1); y++)
+      for (int x = std::max(0, cx - 1); x <= std::min(bx - 1, cx + 1); x++)
+      {
+        if (box[y * bx + x])
+          continue;
+        box[y * bx + x] = 2;
+        int n = (y + y0) * nx + x + x0;
+        border.push_back(n);
+        border_costs.push_back(costs[n]);
+        costs[n] = costmap_2d::LETHAL_OBSTACLE;
+      }
+  }
+}
+
+void openCorridor(std::vector<unsigned char>& costs, const std::vector<int>& border,
+                  const std::vector<unsigned char>& border_costs)
+{
+  for (unsigned int i = 0; i < border.size(); i++)
+    costs[border[i]] = border_costs[i];
+}
+
+TEST(Corridor, refresh_stays_inside_corridor)
+{
+  int nx = 100, ny = 100;
+  std::vector<unsigned char> costs = makeWallCostmap(nx, ny);
+  QuadraticCalculator p_calc(nx, ny);
+  DijkstraExpansion dijkstra(&p_calc, nx, ny);
+  GridPath grid_path(&p_calc);
+  dijkstra.setSize(nx, ny);
+  grid_path.setSize(nx, ny);
+
+  std::vector<float> potential(nx * ny);
+  std::vector<std::pair<float, float> > path;
+  ASSERT_TRUE(dijkstra.calculatePotentials(&costs[0], 10, 25, 90, 25, nx * ny * 2, &potential[0]));
+  ASSERT_TRUE(grid_path.getPath(&potential[0], 10, 25, 90, 25, path));
+
+  std::vector<unsigned char> original = costs, mask;
+  std::vector<int> border;
+  std::vector<unsigned char> border_costs;
+  closeCorridor(costs, path, 5, nx, ny, mask, border, border_costs);
+  for (int y = 70; y < 80; y++)
+    EXPECT_FALSE(mask[y * nx + nx / 2]);
+  // only the cells next to the corridor are closed
+  for (unsigned int i = 0; i < border.size(); i++)
+    EXPECT_FALSE(mask[border[i]]);
+  EXPECT_LT(border.size(), (unsigned int) std::count(mask.begin(), mask.end(), 1));
+
+  // the robot moved along the plan, the refresh of it only expands the corridor
+  int sx = path[path.size() / 3].first, sy = path[path.size() / 3].second;
+  int visited = dijkstra.getCellsVisited();
+  ASSERT_TRUE(dijkstra.calculatePotentials(&costs[0], sx, sy, 90, 25, nx * ny * 2, &potential[0]));
+  ASSERT_TRUE(grid_path.getPath(&potential[0], sx, sy, 90, 25, path));
+  EXPECT_LE(dijkstra.getCellsVisited(), (int) (std::count(mask.begin(), mask.end(), 1) + border.size()));
+  EXPECT_LT(dijkstra.getCellsVisited(), visited);
+  for (unsigned int i = 0; i < path.size(); i++)
+    EXPECT_TRUE(mask[(int) path[i].second * nx + (int) path[i].first]) << path[i].first << ", " << path[i].second;
+  for (int n = 0; n < nx * ny; n++)
+    if (!mask[n])
+      EXPECT_EQ(POT_HIGH, dijkstra.getPotential(&potential[0], n)) << "cell " << n % nx << ", " << n / nx;
+
+  // the costmap is left as it was
+  openCorridor(costs, border, border_costs);
+  EXPECT_TRUE(original == costs);
+}
+
+TEST(Corridor, blocked_corridor_falls_back_to_map)
+{
+  int nx = 100, ny = 100;
+  std::vector<unsigned char> costs = makeWallCostmap(nx, ny);
+  QuadraticCalculator p_calc(nx, ny);
+  DijkstraExpansion dijkstra(&p_calc, nx, ny);
+  GridPath grid_path(&p_calc);
+  dijkstra.setSize(nx, ny);
+  grid_path.setSize(nx, ny);
+
+  std::vector<float> potential(nx * ny);
+  std::vector<std::pair<float, float> > path;
+  ASSERT_TRUE(dijkstra.calculatePotentials(&costs[0], 10, 25, 90, 25, nx * ny * 2, &potential[0]));
+  ASSERT_TRUE(grid_path.getPath(&potential[0], 10, 25, 90, 25, path));
+
+  // the gap the plan went through closes
+  for (int y = 20; y < 30; y++)
+    costs[y * nx + nx / 2] = costmap_2d::LETHAL_OBSTACLE;
+  std::vector<unsigned char> mask;
+  std::vector<int> border;
+  std::vector<unsigned char> border_costs;
+  closeCorridor(costs, path, 5, nx, ny, mask, border, border_costs);
+  EXPECT_FALSE(dijkstra.calculatePotentials(&costs[0], 10, 25, 90, 25, nx * ny * 2, &potential[0]));
+  openCorridor(costs, border, border_costs);
+
+  // the whole map still has the other gap
+  path.clear();
+  ASSERT_TRUE(dijkstra.calculatePotentials(&costs[0], 10, 25, 90, 25, nx * ny * 2, &potential[0]));
+  ASSERT_TRUE(grid_path.getPath(&potential[0], 10, 25, 90, 25, path));
+  bool lower_gap = false;
+  for (unsigned int i = 0; i < path.size(); i++)
+    if ((int) path[i].first == nx / 2)
+      lower_gap = lower_gap || (path[i].second >= 70 && path[i].second < 80);
+  EXPECT_TRUE(lower_gap);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
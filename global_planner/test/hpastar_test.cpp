@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <costmap_2d/cost_values.h>
+#include <global_planner/dijkstra.h>
+#include <global_planner/hpastar.h>
+#include <global_planner/quadratic_calculator.h>
+#include "test_utils.h"
+
+using namespace global_planner;
+
+// A DijkstraExpansion that fails its first calls, and remembers the costs it was given
+class FailingRefiner : public DijkstraExpansion
+{
+public:
+  FailingRefiner(PotentialCalculator* p_calc, int nx, int ny, int failures) :
+      DijkstraExpansion(p_calc, nx, ny), failures(failures)
+  {
+  }
+  bool calculatePotentials(unsigned char* costs, double start_x, double start_y, double end_x, double end_y, int cycles,
+                           float* potential)
+  {
+    calls.push_back(costs);
+    bool found = DijkstraExpansion::calculatePotentials(costs, start_x, start_y, end_x, end_y, cycles, potential);
+    return failures-- > 0 ? false : found;
+  }
+  int failures;
+  std::vector<unsigned char*> calls;
+};
+
+int reachedCells(const std::vector<float>& potential)
+{
+  int reached = 0;
+  for (unsigned int n = 0; n < potential.size(); n++)
+    reached += potential[n] < POT_HIGH;
+  return reached;
+}
+
+TEST(HPAStarExpansion, abstract_path_restricts_the_refinement)
+{
+  int nx = 200, ny = 200;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 7, 150);
+  QuadraticCalculator p_calc(nx, ny);
+  DijkstraExpansion dijkstra(&p_calc, nx, ny);
+  HPAStarExpansion hpa(&p_calc, new DijkstraExpansion(&p_calc, nx, ny), nx, ny, 20, 1);
+  dijkstra.setSize(nx, ny);
+
+  // towards a corner, so that the corridor leaves out a good part of the map
+  int ex = nx - 6, ey = 5, end = ex + ey * nx;
+  costs[end] = 0;
+  std::vector<float> expected(nx * ny), potential(nx * ny);
+  ASSERT_TRUE(dijkstra.calculatePotentials(&costs[0], 5, 5, ex, ey, nx * ny * 2, &expected[0]));
+  ASSERT_TRUE(hpa.calculatePotentials(&costs[0], 5, 5, ex, ey, nx * ny * 2, &potential[0]));
+
+  EXPECT_GE(potential[end], expected[end]);
+  EXPECT_NEAR(expected[end], potential[end], expected[end] * 5e-2);
+  EXPECT_LT(reachedCells(reachedPotential(hpa, potential)), reachedCells(reachedPotential(dijkstra, expected)) / 2);
+}
+
+TEST(HPAStarExpansion, falls_back_to_the_whole_map)
+{
+  int nx = 200, ny = 200;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 7, 150);
+  QuadraticCalculator p_calc(nx, ny);
+  DijkstraExpansion dijkstra(&p_calc, nx, ny);
+  FailingRefiner* refiner = new FailingRefiner(&p_calc, nx, ny, 1);
+  HPAStarExpansion hpa(&p_calc, refiner, nx, ny, 20, 1);
+  dijkstra.setSize(nx, ny);
+
+  int ex = nx - 6, ey = 5, end = ex + ey * nx;
+  costs[end] = 0;
+  std::vector<float> expected(nx * ny), potential(nx * ny);
+  ASSERT_TRUE(dijkstra.calculatePotentials(&costs[0], 5, 5, ex, ey, nx * ny * 2, &expected[0]));
+  ASSERT_TRUE(hpa.calculatePotentials(&costs[0], 5, 5, ex, ey, nx * ny * 2, &potential[0]));
+
+  // the corridor first, then the costmap itself
+  ASSERT_EQ(2u, refiner->calls.size());
+  EXPECT_NE(&costs[0], refiner->calls[0]);
+  EXPECT_EQ(&costs[0], refiner->calls[1]);
+  EXPECT_EQ(expected[end], potential[end]);
+}
+
+TEST(HPAStarExpansion, incremental_updates_match_a_rebuild)
+{
+  int nx = 200, ny = 200;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 7, 150);
+  QuadraticCalculator p_calc(nx, ny);
+  HPAStarExpansion hpa(&p_calc, new DijkstraExpansion(&p_calc, nx, ny), nx, ny, 20, 1);
+
+  int ex = nx - 6, ey = 5, end = ex + ey * nx;
+  costs[end] = 0;
+  std::vector<float> potential(nx * ny), rebuilt(nx * ny);
+  ASSERT_TRUE(hpa.calculatePotentials(&costs[0], 5, 5, ex, ey, nx * ny * 2, &potential[0]));
+  float before = potential[end];
+
+  // a wall up from the bottom border across the straight line, the path has to go around it
+  for (int y = 1; y < 150; y++)
+    for (int x = 98; x < 102; x++)
+      costs[y * nx + x] = costmap_2d::LETHAL_OBSTACLE;
+  for (int i = 0; i < 2; i++)
+  {
+    hpa.markChanged(98, 1, 102, 150);
+    HPAStarExpansion fresh(&p_calc, new DijkstraExpansion(&p_calc, nx, ny), nx, ny, 20, 1);
+    ASSERT_TRUE(hpa.calculatePotentials(&costs[0], 5, 5, ex, ey, nx * ny * 2, &potential[0]));
+    ASSERT_TRUE(fresh.calculatePotentials(&costs[0], 5, 5, ex, ey, nx * ny * 2, &rebuilt[0]));
+    std::vector<float> incremental = reachedPotential(hpa, potential);
+    rebuilt = reachedPotential(fresh, rebuilt);
+    for (int n = 0; n < nx * ny; n++)
+      ASSERT_EQ(rebuilt[n], incremental[n]) << "cell " << n;
+
+    // and removing it again brings back the first plan
+    if (i == 0)
+      EXPECT_GT(potential[end], before);
+    else
+      EXPECT_EQ(before, potential[end]);
+    for (int y = 1; y < 150; y++)
+      for (int x = 98; x < 102; x++)
+        costs[y * nx + x] = 0;
+  }
+}
+
+TEST(HPAStarExpansion, abstract_graph_finds_the_door)
+{
+  // two rooms split by a wall, far from where the straight line to the end crosses it
+  int nx = 100, ny = 100;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 0, 0);
+  for (int y = 1; y < ny - 1; y++)
+    costs[y * nx + 50] = costmap_2d::LETHAL_OBSTACLE;
+  PotentialCalculator p_calc(nx, ny);
+  HPAStarExpansion hpa(&p_calc, new DijkstraExpansion(&p_calc, nx, ny), nx, ny, 20, 0);
+
+  // without a door there is no entrance between the rooms, which the abstract search sees without the refiner
+  std::vector<float> potential(nx * ny);
+  EXPECT_FALSE(hpa.calculatePotentials(&costs[0], 10, 10, 90, 10, nx * ny * 2, &potential[0]));
+  EXPECT_EQ(0, hpa.getCellsVisited());
+
+  costs[90 * nx + 50] = costs[91 * nx + 50] = 0;
+  hpa.markChanged(50, 90, 51, 92);
+  ASSERT_TRUE(hpa.calculatePotentials(&costs[0], 10, 10, 90, 10, nx * ny * 2, &potential[0]));
+  int end = 90 + 10 * nx;
+  float optimal = gridPotential(costs, nx, 10 + 10 * nx, end);
+  EXPECT_GE(potential[end], optimal);
+  EXPECT_NEAR(optimal, potential[end], optimal * 5e-2);
+
+  // only the clusters on the way through the door are refined
+  EXPECT_LT(reachedCells(reachedPotential(hpa, potential)), nx * ny / 2);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
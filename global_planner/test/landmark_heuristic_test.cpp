@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+#include <vector>
+
+#include <costmap_2d/cost_values.h>
+#include <global_planner/astar.h>
+#include <global_planner/landmark_heuristic.h>
+#include <global_planner/quadratic_calculator.h>
+
+using namespace global_planner;
+
+// A free map with a lethal border and aisles, which are only open at alternating ends
+std::vector<unsigned char> makeAisles(int nx, int ny)
+{
+  std::vector<unsigned char> costs(nx * ny, costmap_2d::FREE_SPACE);
+  for (int x = 0; x < nx; x++)
+    costs[x] = costs[(ny - 1) * nx + x] = costmap_2d::LETHAL_OBSTACLE;
+  for (int y = 0; y < ny; y++)
+    costs[y * nx] = costs[y * nx + nx - 1] = costmap_2d::LETHAL_OBSTACLE;
+  for (int x = 10, k = 0; x < nx - 10; x += 10, k++)
+    for (int y = k % 2 ? 5 : 1; y < (k % 2 ? ny - 1 : ny - 5); y++)
+      costs[y * nx + x] = costmap_2d::LETHAL_OBSTACLE;
+  return costs;
+}
+
+std::vector<int> bfs(const std::vector<unsigned char>& costs, int nx, int ny, int from)
+{
+  std::vector<int> distance(nx * ny, -1), queue(1, from);
+  distance[from] = 0;
+  for (unsigned int head = 0; head < queue.size(); head++)
+  {
+    int i = queue[head];
+    int neighbors[4] = { i - 1, i + 1, i - nx, i + nx };
+    for (int k = 0; k < 4; k++)
+    {
+      int n = neighbors[k];
+      if (n < 0 || n >= nx * ny || costs[n] == costmap_2d::LETHAL_OBSTACLE || distance[n] >= 0)
+        continue;
+      distance[n] = distance[i] + 1;
+      queue.push_back(n);
+    }
+  }
+  return distance;
+}
+
+TEST(LandmarkHeuristic, lower_bound_on_distance)
+{
+  int nx = 101, ny = 60;
+  std::vector<unsigned char> costs = makeAisles(nx, ny);
+  LandmarkHeuristic landmarks(4);
+  EXPECT_TRUE(landmarks.update(&costs[0], nx, ny));
+  EXPECT_TRUE(landmarks.isValid(nx, ny));
+  EXPECT_EQ(4u, landmarks.getLandmarks().size());
+  EXPECT_FALSE(landmarks.update(&costs[0], nx, ny));
+
+  srand(3);
+  int tight = 0;
+  for (int p = 0; p < 50; p++)
+  {
+    int goal = rand() % (nx * ny);
+    if (costs[goal] == costmap_2d::LETHAL_OBSTACLE)
+      continue;
+    std::vector<int> distance = bfs(costs, nx, ny, goal);
+    landmarks.setGoal(goal);
+    for (int n = 0; n < nx * ny; n++)
+    {
+      if (distance[n] < 0)
+        continue;
+      EXPECT_LE(landmarks.getDistance(n), distance[n]) << "cell " << n << " goal " << goal;
+      tight += landmarks.getDistance(n) == distance[n];
+    }
+  }
+  EXPECT_GT(tight, 0);
+
+  // only changes of the lethal cells refresh the tables
+  costs[nx + 1] = 100;
+  EXPECT_FALSE(landmarks.update(&costs[0], nx, ny));
+  costs[nx + 1] = costmap_2d::FREE_SPACE;
+  costs[20 * nx + 10] = costmap_2d::FREE_SPACE;
+  EXPECT_TRUE(landmarks.update(&costs[0], nx, ny));
+}
+
+TEST(LandmarkHeuristic, astar_expands_less)
+{
+  int nx = 101, ny = 60;
+  std::vector<unsigned char> costs = makeAisles(nx, ny);
+  LandmarkHeuristic landmarks(4);
+  landmarks.update(&costs[0], nx, ny);
+
+  QuadraticCalculator p_calc(nx, ny);
+  AStarExpansion manhattan(&p_calc, nx, ny), alt(&p_calc, nx, ny);
+  manhattan.setSize(nx, ny);
+  alt.setSize(nx, ny);
+  alt.setLandmarks(&landmarks);
+
+  std::vector<float> p1(nx * ny), p2(nx * ny);
+  EXPECT_TRUE(manhattan.calculatePotentials(&costs[0], 5, 30, 95, 30, nx * ny * 2, &p1[0]));
+  EXPECT_TRUE(alt.calculatePotentials(&costs[0], 5, 30, 95, 30, nx * ny * 2, &p2[0]));
+  EXPECT_LT(alt.getCellsVisited(), manhattan.getCellsVisited());
+  EXPECT_LT(p2[30 * nx + 95], POT_HIGH);
+
+  // tables for another map size are not used
+  AStarExpansion other(&p_calc, nx, ny - 1);
+  other.setSize(nx, ny - 1);
+  other.setLandmarks(&landmarks);
+  EXPECT_TRUE(other.calculatePotentials(&costs[0], 5, 30, 95, 30, nx * (ny - 1) * 2, &p2[0]));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
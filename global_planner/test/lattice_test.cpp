@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <vector>
+
+#include <costmap_2d/cost_values.h>
+#include <global_planner/lattice_search.h>
+#include <global_planner/motion_primitives.h>
+
+using namespace global_planner;
+
+std::vector<geometry_msgs::Point> rectangle(double length, double width)
+{
+  std::vector<geometry_msgs::Point> footprint(4);
+  footprint[0].x = footprint[1].x = length / 2;
+  footprint[2].x = footprint[3].x = -length / 2;
+  footprint[0].y = footprint[3].y = width / 2;
+  footprint[1].y = footprint[2].y = -width / 2;
+  return footprint;
+}
+
+TEST(MotionPrimitives, end_on_the_lattice)
+{
+  MotionPrimitives primitives;
+  primitives.generate(0.05, 1.0, 0.4, true, rectangle(0.6, 0.4));
+  EXPECT_TRUE(primitives.hasFootprint());
+
+  for (int h = 0; h < MotionPrimitives::NUM_HEADINGS; h++)
+  {
+    EXPECT_EQ(h, MotionPrimitives::getHeading(MotionPrimitives::getHeadingAngle(h)));
+    const std::vector<MotionPrimitive>& p = primitives.getPrimitives(h);
+    ASSERT_EQ(5u, p.size());
+    for (unsigned int k = 0; k < p.size(); k++)
+    {
+      EXPECT_EQ(h, p[k].start_heading);
+      EXPECT_NE(0, p[k].dx * p[k].dx + p[k].dy * p[k].dy);
+      EXPECT_DOUBLE_EQ(p[k].dx, p[k].poses.back().x);
+      EXPECT_DOUBLE_EQ(p[k].dy, p[k].poses.back().y);
+      EXPECT_NEAR(0.0, remainder(p[k].poses.back().theta - MotionPrimitives::getHeadingAngle(p[k].end_heading),
+                                 2 * M_PI), 1e-9);
+      EXPECT_GE(p[k].length + 1e-9, hypot(p[k].dx, p[k].dy) * 0.05);
+      EXPECT_GT(p[k].mask_dx.size(), p[k].trace_dx.size());
+
+      // the lattice is symmetric under rotations by 90 degrees
+      const MotionPrimitive& r = primitives.getPrimitives((h + 4) % 16)[k];
+      EXPECT_EQ(-p[k].dy, r.dx);
+      EXPECT_EQ(p[k].dx, r.dy);
+      EXPECT_EQ(p[k].length, r.length);
+    }
+  }
+}
+
+TEST(LatticeSearch, turns_around_without_rotating_in_place)
+{
+  int nx = 200, ny = 200;
+  std::vector<unsigned char> costs(nx * ny, costmap_2d::FREE_SPACE);
+  MotionPrimitives primitives;
+  primitives.generate(0.05, 1.0, 0.4, false, rectangle(0.6, 0.4));
+  LatticeSearch search(primitives);
+  search.setPenalties(1.5, 1.0, 3.0);
+  search.computeHeuristicTable(2.5);
+
+  // straight back from where the robot is facing
+  std::vector<LatticeStep> path;
+  ASSERT_TRUE(search.search(&costs[0], nx, ny, 100, 100, 0, 60, 100, 8, 0.0, path));
+  ASSERT_FALSE(path.empty());
+  EXPECT_EQ(100, path[0].x);
+  EXPECT_EQ(100, path[0].y);
+  EXPECT_EQ(0, path[0].primitive->start_heading);
+  for (unsigned int i = 0; i + 1 < path.size(); i++)
+  {
+    EXPECT_EQ(path[i].x + path[i].primitive->dx, path[i + 1].x);
+    EXPECT_EQ(path[i].y + path[i].primitive->dy, path[i + 1].y);
+    EXPECT_EQ(path[i].primitive->end_heading, path[i + 1].primitive->start_heading);
+  }
+  EXPECT_EQ(60, path.back().x + path.back().primitive->dx);
+  EXPECT_EQ(100, path.back().y + path.back().primitive->dy);
+  EXPECT_EQ(8, path.back().primitive->end_heading);
+  // a U-turn with a radius of 20 cells, and no shorter
+  EXPECT_GT(search.getCost(), 0.05 * (M_PI * 20 + 40));
+
+  // the free space costs are a lower bound
+  float table = search.getTableCost(0, -40, 0, path.back().primitive->end_heading);
+  EXPECT_GT(table, 0.0f);
+  EXPECT_LE(table, search.getCost() + 1e-4);
+  EXPECT_FLOAT_EQ(table, search.getTableCost(4, 0, -40, (path.back().primitive->end_heading + 4) % 16));
+}
+
+TEST(LatticeSearch, keeps_the_footprint_off_obstacles)
+{
+  int nx = 200, ny = 100;
+  std::vector<unsigned char> costs(nx * ny, costmap_2d::FREE_SPACE);
+  // a wall across the map with a gap of 16 cells
+  for (int y = 0; y < ny; y++)
+    if (y < 42 || y >= 58)
+      costs[y * nx + 100] = costmap_2d::LETHAL_OBSTACLE;
+
+  MotionPrimitives primitives;
+  primitives.generate(0.05, 1.0, 0.4, false, rectangle(0.6, 0.4));
+  LatticeSearch search(primitives);
+  search.setPenalties(1.5, 1.0, 3.0);
+  search.computeHeuristicTable(1.0);
+
+  std::vector<LatticeStep> path;
+  ASSERT_TRUE(search.search(&costs[0], nx, ny, 30, 20, 0, 170, 80, 0, 0.0, path));
+  for (unsigned int i = 0; i < path.size(); i++)
+  {
+    const MotionPrimitive& p = *path[i].primitive;
+    for (unsigned int c = 0; c < p.mask_dx.size(); c++)
+      EXPECT_NE(costmap_2d::LETHAL_OBSTACLE, costs[(path[i].y + p.mask_dy[c]) * nx + path[i].x + p.mask_dx[c]]);
+  }
+
+  // the robot is 8 cells wide, a gap of 7 is too narrow even though its center fits
+  for (int y = 42; y < 51; y++)
+    costs[y * nx + 100] = costmap_2d::LETHAL_OBSTACLE;
+  EXPECT_FALSE(search.search(&costs[0], nx, ny, 30, 20, 0, 170, 80, 0, 0.0, path));
+  EXPECT_GT(search.getExpansions(), 0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
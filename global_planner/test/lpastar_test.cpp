@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <costmap_2d/cost_values.h>
+#include <global_planner/dijkstra.h>
+#include <global_planner/lpastar.h>
+#include <global_planner/quadratic_calculator.h>
+#include "test_utils.h"
+
+using namespace global_planner;
+
+// the potential of the end cell after the repair matches a fresh expansion of the same map
+void expectFreshPotential(LPAStarExpansion& lpa, std::vector<unsigned char>& costs, int nx, int ny, int sx, int sy,
+                          int ex, int ey)
+{
+  QuadraticCalculator p_calc(nx, ny);
+  DijkstraExpansion dijkstra(&p_calc, nx, ny);
+  LPAStarExpansion fresh(&p_calc, nx, ny);
+  dijkstra.setSize(nx, ny);
+
+  std::vector<float> repaired(nx * ny), expected(nx * ny), restarted(nx * ny);
+  ASSERT_TRUE(lpa.calculatePotentials(&costs[0], sx, sy, ex, ey, nx * ny * 2, &repaired[0]));
+  ASSERT_TRUE(dijkstra.calculatePotentials(&costs[0], sx, sy, ex, ey, nx * ny * 2, &expected[0]));
+  ASSERT_TRUE(fresh.calculatePotentials(&costs[0], sx, sy, ex, ey, nx * ny * 2, &restarted[0]));
+
+  int end = ex + ey * nx;
+  EXPECT_NEAR(restarted[end], repaired[end], restarted[end] * 1e-4);
+  // the priority blocks of DijkstraExpansion only settle cells approximately in order
+  EXPECT_NEAR(expected[end], repaired[end], expected[end] * 2e-2);
+}
+
+TEST(LPAStarExpansion, repairs_match_fresh_expansions)
+{
+  int nx = 150, ny = 120;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 11, 60);
+  QuadraticCalculator p_calc(nx, ny);
+  LPAStarExpansion lpa(&p_calc, nx, ny);
+  lpa.setSize(nx, ny);
+
+  int ex = nx - 6, ey = ny - 6;
+  expectFreshPotential(lpa, costs, nx, ny, 5, 5, ex, ey);
+  int first = lpa.getCellsVisited();
+
+  // raise and lower costs around the middle of the map, the repair touches far fewer cells
+  for (int y = 40; y < 80; y++)
+    for (int x = 60; x < 64; x++)
+      costs[y * nx + x] = costmap_2d::LETHAL_OBSTACLE;
+  for (int y = 20; y < 30; y++)
+    for (int x = 20; x < 30; x++)
+      costs[y * nx + x] = 0;
+  expectFreshPotential(lpa, costs, nx, ny, 5, 5, ex, ey);
+  EXPECT_LT(lpa.getCellsVisited(), first);
+
+  for (int y = 40; y < 80; y++)
+    for (int x = 60; x < 64; x++)
+      costs[y * nx + x] = 100;
+  expectFreshPotential(lpa, costs, nx, ny, 5, 5, ex, ey);
+
+  // a new start cell restarts the search
+  costs[10 + 8 * nx] = 0;
+  expectFreshPotential(lpa, costs, nx, ny, 10, 8, ex, ey);
+
+  // and so does a new map size, the planner resizes the calculator along with the expander
+  nx = 130, ny = 140;
+  costs = makeCostmap(nx, ny, 3, 50);
+  p_calc.setSize(nx, ny);
+  lpa.setSize(nx, ny);
+  expectFreshPotential(lpa, costs, nx, ny, 5, 5, nx - 6, ny - 6);
+}
+
+TEST(LPAStarExpansion, repairs_only_around_the_change)
+{
+  int nx = 100, ny = 100;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 0, 0);
+  PotentialCalculator p_calc(nx, ny);
+  LPAStarExpansion lpa(&p_calc, nx, ny);
+  lpa.setSize(nx, ny);
+
+  int start = 5 + 5 * nx, end = 94 + 94 * nx;
+  std::vector<float> potential(nx * ny);
+  ASSERT_TRUE(lpa.calculatePotentials(&costs[0], 5, 5, 94, 94, nx * ny * 2, &potential[0]));
+  EXPECT_EQ(gridPotential(costs, nx, start, end), potential[end]);
+  int first = lpa.getCellsVisited();
+  EXPECT_GT(first, nx * ny / 2);
+
+  // a blocked cell that no other cell needs to pass, none of the potentials change
+  costs[90 + 10 * nx] = costmap_2d::LETHAL_OBSTACLE;
+  ASSERT_TRUE(lpa.calculatePotentials(&costs[0], 5, 5, 94, 94, nx * ny * 2, &potential[0]));
+  EXPECT_EQ(gridPotential(costs, nx, start, end), potential[end]);
+  EXPECT_LT(lpa.getCellsVisited(), 10);
+
+  // a wall around the end changes the potential of the cells inside it and no others
+  for (int i = 90; i < 99; i++)
+    costs[i + 90 * nx] = costs[90 + i * nx] = costmap_2d::LETHAL_OBSTACLE;
+  costs[90 + 95 * nx] = 0;
+  ASSERT_TRUE(lpa.calculatePotentials(&costs[0], 5, 5, 94, 94, nx * ny * 2, &potential[0]));
+  EXPECT_EQ(gridPotential(costs, nx, start, end), potential[end]);
+  EXPECT_LT(lpa.getCellsVisited(), 8 * 8 * 3);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,284 @@
+/*
+ * Copyright (c) 2012, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * Runs random start/goal queries through navfn and the expanders and tracebacks of the
+ * global planner on a set of costmaps, and reports latency, expanded cells and path
+ * quality per planner. The summary goes to stdout, one csv line per map and planner is
+ * written to the results file so that runs can be compared by scripts.
+ *
+ * Latencies include the traceback, the length ratio is the length of the path over the
+ * straight line between start and goal. navfn does not count its expansions, the cells
+ * it assigned a potential to are reported instead.
+ *
+ * usage: planner_benchmark [number of queries] [results.csv] [costmap.pgm ...]
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <ros/package.h>
+#include <ros/time.h>
+#include <costmap_2d/cost_values.h>
+#include <navfn/navfn.h>
+#include <global_planner/astar.h>
+#include <global_planner/dijkstra.h>
+#include <global_planner/gradient_path.h>
+#include <global_planner/grid_path.h>
+#include <global_planner/quadratic_calculator.h>
+#include "benchmark_utils.h"
+
+using namespace global_planner;
+
+struct Result
+{
+  std::string map, planner, traceback;
+  std::vector<double> times;
+  double expanded, length_ratio;
+  int found;
+
+  Result(const std::string& map, const std::string& planner, const std::string& traceback) :
+      map(map), planner(planner), traceback(traceback), expanded(0.0), length_ratio(0.0), found(0)
+  {
+  }
+
+  void add(double time, int cells, bool success, double length, double distance)
+  {
+    times.push_back(time);
+    expanded += cells;
+    if (success)
+    {
+      found++;
+      length_ratio += length / distance;
+    }
+  }
+
+  double percentile(double p) const
+  {
+    std::vector<double> sorted(times);
+    std::sort(sorted.begin(), sorted.end());
+    return sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+  }
+};
+
+void benchmark(const std::string& path, int queries, std::vector<Result>& results)
+{
+  std::vector<unsigned char> navfn_costs;
+  int nx, ny;
+  if (!readCostmap(path, navfn_costs, nx, ny))
+  {
+    fprintf(stderr, "Could not read costmap %s\n", path.c_str());
+    return;
+  }
+
+  std::vector<unsigned char> costs(navfn_costs);
+  fromNavfnCosts(costs);
+  outlineMap(costs, nx, ny);
+
+  // queries only connect free cells of the same 4-connected region, so that a failed query is a failure of the planner
+  std::vector<int> free_cells, region(nx * ny, -1);
+  std::vector<std::vector<int> > regions;
+  for (int i = 0; i < nx * ny; i++)
+  {
+    if (costs[i] != costmap_2d::FREE_SPACE || region[i] >= 0)
+      continue;
+    regions.push_back(std::vector<int>(1, i));
+    std::vector<int>& cells = regions.back();
+    region[i] = regions.size() - 1;
+    for (unsigned int c = 0; c < cells.size(); c++)
+    {
+      int neighbors[4] = {cells[c] - 1, cells[c] + 1, cells[c] - nx, cells[c] + nx};
+      for (int k = 0; k < 4; k++)
+      {
+        int n = neighbors[k];
+        if (costs[n] < costmap_2d::INSCRIBED_INFLATED_OBSTACLE && region[n] < 0)
+        {
+          region[n] = region[i];
+          cells.push_back(n);
+        }
+      }
+    }
+    if (cells.size() > 1)
+      free_cells.insert(free_cells.end(), cells.begin(), cells.end());
+  }
+  if (free_cells.empty())
+  {
+    fprintf(stderr, "Not enough free space in %s\n", path.c_str());
+    return;
+  }
+
+  navfn::NavFn nav(nx, ny);
+
+  PotentialCalculator simple(nx, ny);
+  QuadraticCalculator quadratic(nx, ny);
+  PotentialCalculator* calculators[2] = {&simple, &quadratic};
+  const char* calculator_names[2] = {"simple", "quadratic"};
+
+  std::vector<Expander*> expanders;
+  std::vector<std::string> expander_names;
+  for (int c = 0; c < 2; c++)
+  {
+    DijkstraExpansion* dijkstra = new DijkstraExpansion(calculators[c], nx, ny);
+    dijkstra->setPreciseStart(true);
+    expanders.push_back(dijkstra);
+    expander_names.push_back(std::string("dijkstra/") + calculator_names[c]);
+    expanders.push_back(new AStarExpansion(calculators[c], nx, ny));
+    expander_names.push_back(std::string("astar/") + calculator_names[c]);
+  }
+
+  std::vector<Traceback*> tracebacks;
+  std::vector<std::string> traceback_names;
+  for (unsigned int e = 0; e < expanders.size(); e++)
+  {
+    PotentialCalculator* p_calc = calculators[e / 2];
+    tracebacks.push_back(new GridPath(p_calc));
+    traceback_names.push_back("grid");
+    tracebacks.push_back(new GradientPath(p_calc));
+    traceback_names.push_back("gradient");
+  }
+  // the constructors cannot reach the buffers of the derived classes
+  for (unsigned int e = 0; e < expanders.size(); e++)
+    expanders[e]->setSize(nx, ny);
+  for (unsigned int t = 0; t < tracebacks.size(); t++)
+    tracebacks[t]->setSize(nx, ny);
+
+  unsigned int first = results.size();
+  results.push_back(Result(path, "navfn", "gradient"));
+  for (unsigned int t = 0; t < tracebacks.size(); t++)
+    results.push_back(Result(path, expander_names[t / 2], traceback_names[t]));
+
+  // the expanders only reset the cells they touched in their own buffer
+  std::vector<std::vector<float> > potentials(expanders.size(), std::vector<float>(nx * ny));
+  std::vector<std::pair<float, float> > plan;
+
+  srand(0);
+  for (int q = 0; q < queries; q++)
+  {
+    int start = free_cells[rand() % free_cells.size()], goal;
+    const std::vector<int>& cells = regions[region[start]];
+    do
+      goal = cells[rand() % cells.size()];
+    while (goal == start);
+    int sx = start % nx, sy = start / nx, gx = goal % nx, gy = goal / nx;
+    double distance = hypot(gx - sx, gy - sy);
+
+    // navfn propagates from the goal and descends from the start
+    int nav_start[2] = {sx, sy}, nav_goal[2] = {gx, gy};
+    memcpy(nav.costarr, &navfn_costs[0], nx * ny);
+    ros::WallTime t0 = ros::WallTime::now();
+    nav.setGoal(nav_goal);
+    nav.setStart(nav_start);
+    bool found = nav.calcNavFnDijkstra(true);
+    double time = (ros::WallTime::now() - t0).toSec();
+
+    int reached = 0;
+    for (int i = 0; i < nx * ny; i++)
+      if (nav.potarr[i] < POT_HIGH)
+        reached++;
+    plan.clear();
+    for (int i = 0; found && i < nav.getPathLen(); i++)
+      plan.push_back(std::make_pair(nav.getPathX()[i], nav.getPathY()[i]));
+    results[first].add(time, reached, found, pathLength(plan), distance);
+
+    for (unsigned int e = 0; e < expanders.size(); e++)
+    {
+      float* potential = &potentials[e][0];
+      t0 = ros::WallTime::now();
+      found = expanders[e]->calculatePotentials(&costs[0], sx, sy, gx, gy, nx * ny * 2, potential);
+      if (found)
+        expanders[e]->clearEndpoint(&costs[0], potential, gx, gy, 2);
+      ros::WallTime t1 = ros::WallTime::now();
+
+      for (unsigned int t = 2 * e; t < 2 * e + 2; t++)
+      {
+        ros::WallTime t2 = ros::WallTime::now();
+        plan.clear();
+        bool traced = found && tracebacks[t]->getPath(potential, sx, sy, gx, gy, plan);
+        time = (t1 - t0).toSec() + (ros::WallTime::now() - t2).toSec();
+        results[first + 1 + t].add(time, expanders[e]->getCellsVisited(), traced, pathLength(plan), distance);
+      }
+    }
+  }
+
+  for (unsigned int e = 0; e < expanders.size(); e++)
+    delete expanders[e];
+  for (unsigned int t = 0; t < tracebacks.size(); t++)
+    delete tracebacks[t];
+}
+
+int main(int argc, char** argv)
+{
+  ros::Time::init();
+
+  int queries = argc > 1 ? atoi(argv[1]) : 1000;
+  std::string output = argc > 2 ? argv[2] : "planner_benchmark.csv";
+  std::vector<std::string> maps(argv + std::min(argc, 3), argv + argc);
+  if (maps.empty())
+    maps.push_back(ros::package::getPath("navfn") + "/test/willow_costmap.pgm");
+  if (queries <= 0)
+  {
+    fprintf(stderr, "The number of queries has to be positive\n");
+    return 1;
+  }
+
+  std::vector<Result> results;
+  for (unsigned int m = 0; m < maps.size(); m++)
+    benchmark(maps[m], queries, results);
+
+  FILE* csv = fopen(output.c_str(), "w");
+  if (!csv)
+  {
+    fprintf(stderr, "Could not write %s\n", output.c_str());
+    return 1;
+  }
+  fprintf(csv, "map,planner,traceback,queries,found,p50_ms,p99_ms,mean_expanded,mean_length_ratio\n");
+  for (unsigned int r = 0; r < results.size(); r++)
+  {
+    const Result& result = results[r];
+    if (r == 0 || result.map != results[r - 1].map)
+      printf("%s\n%-20s %-10s %7s %7s %9s %9s %12s %12s\n", result.map.c_str(), "planner", "traceback", "queries",
+             "found", "p50 ms", "p99 ms", "expanded", "length ratio");
+
+    int n = result.times.size();
+    double p50 = result.percentile(0.5) * 1e3, p99 = result.percentile(0.99) * 1e3;
+    double expanded = result.expanded / n, ratio = result.found ? result.length_ratio / result.found : 0.0;
+    fprintf(csv, "%s,%s,%s,%d,%d,%.4f,%.4f,%.1f,%.4f\n", result.map.c_str(), result.planner.c_str(),
+            result.traceback.c_str(), n, result.found, p50, p99, expanded, ratio);
+    printf("%-20s %-10s %7d %7d %9.3f %9.3f %12.1f %12.4f\n", result.planner.c_str(), result.traceback.c_str(), n,
+           result.found, p50, p99, expanded, ratio);
+  }
+  fclose(csv);
+  printf("results written to %s\n", output.c_str());
+  return 0;
+}
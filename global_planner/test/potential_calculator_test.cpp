@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <global_planner/dijkstra.h>
+#include <global_planner/gradient_path.h>
+#include <global_planner/quadratic_calculator.h>
+#include "test_utils.h"
+
+using namespace global_planner;
+
+TEST(DijkstraExpansion, targets_extend_expansion)
+{
+  int nx = 200, ny = 150;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 42, 40, 8);
+  QuadraticCalculator p_calc(nx, ny);
+  DijkstraExpansion single(&p_calc, nx, ny), batch(&p_calc, nx, ny);
+  single.setSize(nx, ny);
+  batch.setSize(nx, ny);
+
+  // the far corner is only reached when the expansion has to settle it too
+  int far = (ny - 3) * nx + nx - 3;
+  costs[far] = 0;
+  std::vector<int> targets(1, far);
+  batch.setTargets(targets);
+
+  std::vector<float> p1(nx * ny), p2(nx * ny);
+  EXPECT_TRUE(single.calculatePotentials(&costs[0], nx / 2, ny / 2, nx / 2 + 3, ny / 2, nx * ny * 2, &p1[0]));
+  EXPECT_TRUE(batch.calculatePotentials(&costs[0], nx / 2, ny / 2, nx / 2 + 3, ny / 2, nx * ny * 2, &p2[0]));
+  EXPECT_EQ(POT_HIGH, single.getPotential(&p1[0], far));
+  EXPECT_LT(batch.getPotential(&p2[0], far), POT_HIGH);
+  EXPECT_GT(batch.getCellsVisited(), single.getCellsVisited());
+  EXPECT_EQ(p1[nx / 2 + 3 + ny / 2 * nx], p2[nx / 2 + 3 + ny / 2 * nx]);
+}
+
+TEST(DijkstraExpansion, reused_buffer_matches_a_fresh_one)
+{
+  int nx = 100, ny = 80;
+  QuadraticCalculator p_calc(nx, ny);
+  DijkstraExpansion reused(&p_calc, nx, ny);
+  reused.setSize(nx, ny);
+  GradientPath path_maker(&p_calc);
+  path_maker.setSize(nx, ny);
+  std::vector<float> potential(nx * ny);
+
+  // more plans than the generations of the stamps, alternating between short ones and long ones
+  // that leave a lot of cells behind in the buffer
+  for (int i = 0; i < 300; i++)
+  {
+    std::vector<unsigned char> costs = makeCostmap(nx, ny, i, 30, 8);
+    int ex = i % 2 ? nx - 6 : nx / 2, ey = i % 2 ? ny - 6 : ny / 2;
+    DijkstraExpansion fresh(&p_calc, nx, ny);
+    fresh.setSize(nx, ny);
+    std::vector<float> expected(nx * ny);
+    bool found = fresh.calculatePotentials(&costs[0], 5, 5, ex, ey, nx * ny * 2, &expected[0]);
+    ASSERT_EQ(found, reused.calculatePotentials(&costs[0], 5, 5, ex, ey, nx * ny * 2, &potential[0])) << "plan " << i;
+    ASSERT_TRUE(reachedPotential(fresh, expected) == reachedPotential(reused, potential)) << "plan " << i;
+    if (!found)
+      continue;
+
+    std::vector<std::pair<float, float> > expected_path, path;
+    ASSERT_EQ(path_maker.getPath(&expected[0], 5, 5, ex, ey, expected_path),
+              path_maker.getPath(&potential[0], 5, 5, ex, ey, path)) << "plan " << i;
+    EXPECT_TRUE(expected_path == path) << "plan " << i;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
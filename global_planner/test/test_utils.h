@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _GLOBAL_PLANNER_TEST_UTILS_H
+#define _GLOBAL_PLANNER_TEST_UTILS_H
+
+#include <cmath>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include <costmap_2d/cost_values.h>
+#include <global_planner/expander.h>
+
+namespace global_planner {
+
+/**
+ * A map with a lethal border and random blocks of inflation-like costs and obstacles. The
+ * cells (5, 5), (nx - 6, ny - 6) and the center are always free.
+ */
+inline std::vector<unsigned char> makeCostmap(int nx, int ny, unsigned int seed, int blocks, int max_size = 12)
+{
+  std::vector<unsigned char> costs(nx * ny, 0);
+  srand(seed);
+  for (int i = 0; i < blocks; i++)
+  {
+    int x0 = rand() % nx, y0 = rand() % ny, size = 2 + rand() % max_size;
+    unsigned char cost = rand() % 3 ? rand() % 200 : costmap_2d::LETHAL_OBSTACLE;
+    for (int y = y0; y < std::min(ny, y0 + size); y++)
+      for (int x = x0; x < std::min(nx, x0 + size); x++)
+        costs[y * nx + x] = cost;
+  }
+  for (int x = 0; x < nx; x++)
+    costs[x] = costs[(ny - 1) * nx + x] = costmap_2d::LETHAL_OBSTACLE;
+  for (int y = 0; y < ny; y++)
+    costs[y * nx] = costs[y * nx + nx - 1] = costmap_2d::LETHAL_OBSTACLE;
+  costs[5 + 5 * nx] = costs[(nx - 6) + (ny - 6) * nx] = costs[nx / 2 + ny / 2 * nx] = 0;
+  return costs;
+}
+
+/**
+ * The potential of the last search of an expander, with POT_HIGH for the cells it did not reach. The
+ * buffer itself only holds that around the reached cells.
+ */
+inline std::vector<float> reachedPotential(const Expander& expander, const std::vector<float>& potential)
+{
+  std::vector<float> reached(potential.size());
+  for (unsigned int n = 0; n < potential.size(); n++)
+    reached[n] = expander.getPotential(&potential[0], n);
+  return reached;
+}
+
+/**
+ * The cheapest sum of cost plus neutral cost over the cells from start to goal, moving between 4-connected
+ * cells below the lethal cost, or POT_HIGH if the goal cannot be reached. This is the exact potential of the
+ * plain PotentialCalculator with the default costs of an Expander.
+ */
+inline float gridPotential(const std::vector<unsigned char>& costs, int nx, int start, int goal)
+{
+  std::vector<float> potential(costs.size(), POT_HIGH);
+  std::priority_queue<std::pair<float, int>, std::vector<std::pair<float, int> >,
+                      std::greater<std::pair<float, int> > > queue;
+  potential[start] = 0;
+  queue.push(std::make_pair(0.0f, start));
+  while (!queue.empty())
+  {
+    float pot = queue.top().first;
+    int n = queue.top().second;
+    queue.pop();
+    if (pot > potential[n])
+      continue;
+    int neighbors[4] = {n - 1, n + 1, n - nx, n + nx};
+    for (int j = 0; j < 4; j++)
+    {
+      int m = neighbors[j];
+      if (m < 0 || m >= (int) costs.size() || costs[m] >= costmap_2d::INSCRIBED_INFLATED_OBSTACLE)
+        continue;
+      float next = pot + costs[m] + 50;
+      if (next < potential[m])
+      {
+        potential[m] = next;
+        queue.push(std::make_pair(next, m));
+      }
+    }
+  }
+  return potential[goal];
+}
+
+inline double pathLength(const std::vector<std::pair<float, float> >& path)
+{
+  double length = 0.0;
+  for (unsigned int i = 1; i < path.size(); i++)
+    length += hypot(path[i].first - path[i - 1].first, path[i].second - path[i - 1].second);
+  return length;
+}
+
+}  // namespace global_planner
+
+#endif
@@ -0,0 +1,186 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <vector>
+
+#include <costmap_2d/cost_values.h>
+#include <global_planner/dijkstra.h>
+#include <global_planner/grid_path.h>
+#include <global_planner/quadratic_calculator.h>
+#include <global_planner/thetastar.h>
+#include <global_planner/thetastar_path.h>
+#include "test_utils.h"
+
+using namespace global_planner;
+
+// the cells a straight segment passes, one per step along its longer axis
+bool lineOfSight(const std::vector<unsigned char>& costs, int nx, std::pair<float, float> a, std::pair<float, float> b)
+{
+  float dx = b.first - a.first, dy = b.second - a.second;
+  int steps = ceil(std::max(fabs(dx), fabs(dy)));
+  for (int i = 0; i <= steps; i++)
+  {
+    float t = steps ? (float) i / steps : 0.0;
+    int x = floor(a.first + dx * t + 0.5), y = floor(a.second + dy * t + 0.5);
+    if (costs[x + y * nx] >= costmap_2d::LETHAL_OBSTACLE)
+      return false;
+  }
+  return true;
+}
+
+TEST(ThetaStarExpansion, any_angle_path_has_line_of_sight)
+{
+  int nx = 200, ny = 150;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 13, 150);
+  QuadraticCalculator p_calc(nx, ny);
+  ThetaStarExpansion theta(&p_calc, nx, ny);
+  ThetaStarPath theta_path(&p_calc, &theta);
+  DijkstraExpansion dijkstra(&p_calc, nx, ny);
+  GridPath grid_path(&p_calc);
+  theta.setSize(nx, ny);
+  theta_path.setSize(nx, ny);
+  dijkstra.setSize(nx, ny);
+  grid_path.setSize(nx, ny);
+
+  int ex = nx - 6, ey = ny - 6;
+  std::vector<float> potential(nx * ny), expected(nx * ny);
+  ASSERT_TRUE(theta.calculatePotentials(&costs[0], 5, 5, ex, ey, nx * ny * 2, &potential[0]));
+  std::vector<std::pair<float, float> > path, grid;
+  ASSERT_TRUE(theta_path.getPath(&potential[0], 5, 5, ex, ey, path));
+
+  // from the goal back to the start, with a straight free line between the turns
+  ASSERT_GE(path.size(), 2u);
+  EXPECT_EQ(std::make_pair((float) ex, (float) ey), path.front());
+  EXPECT_EQ(std::make_pair(5.0f, 5.0f), path.back());
+  for (unsigned int i = 1; i < path.size(); i++)
+    EXPECT_TRUE(lineOfSight(costs, nx, path[i - 1], path[i]))
+        << "segment " << path[i - 1].first << ", " << path[i - 1].second << " to " << path[i].first << ", "
+        << path[i].second;
+
+  // the turns are far apart, and the path is no longer than the one along the grid
+  EXPECT_LT(path.size(), 20u);
+  ASSERT_TRUE(dijkstra.calculatePotentials(&costs[0], 5, 5, ex, ey, nx * ny * 2, &expected[0]));
+  ASSERT_TRUE(grid_path.getPath(&expected[0], 5, 5, ex, ey, grid));
+  EXPECT_LE(pathLength(path), pathLength(grid));
+}
+
+TEST(ThetaStarExpansion, turns_only_at_corners)
+{
+  int nx = 100, ny = 100;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 0, 0);
+  PotentialCalculator p_calc(nx, ny);
+  ThetaStarExpansion theta(&p_calc, nx, ny);
+  ThetaStarPath theta_path(&p_calc, &theta);
+  theta.setSize(nx, ny);
+  theta_path.setSize(nx, ny);
+
+  // on free cells the path is the straight segment, and its potential its length times the neutral cost
+  std::vector<float> potential(nx * ny);
+  std::vector<std::pair<float, float> > path;
+  ASSERT_TRUE(theta.calculatePotentials(&costs[0], 20, 45, 80, 55, nx * ny * 2, &potential[0]));
+  ASSERT_TRUE(theta_path.getPath(&potential[0], 20, 45, 80, 55, path));
+  ASSERT_EQ(2u, path.size());
+  EXPECT_NEAR(hypot(60, 10) * 50, potential[80 + 55 * nx], 1e-2);
+
+  // a pillar across that segment, the path only bends at the two corners it has to pass
+  for (int y = 40; y < 60; y++)
+    for (int x = 45; x < 55; x++)
+      costs[y * nx + x] = costmap_2d::LETHAL_OBSTACLE;
+  std::vector<std::pair<float, float> > bent;
+  ASSERT_TRUE(theta.calculatePotentials(&costs[0], 20, 45, 80, 55, nx * ny * 2, &potential[0]));
+  ASSERT_TRUE(theta_path.getPath(&potential[0], 20, 45, 80, 55, bent));
+  ASSERT_EQ(4u, bent.size());
+  EXPECT_EQ(std::make_pair(55.0f, 60.0f), bent[1]);
+  EXPECT_EQ(std::make_pair(44.0f, 60.0f), bent[2]);
+  for (unsigned int i = 1; i < bent.size(); i++)
+    EXPECT_TRUE(lineOfSight(costs, nx, bent[i - 1], bent[i]));
+  EXPECT_NEAR(pathLength(bent) * 50, potential[80 + 55 * nx], 1e-2);
+}
+
+TEST(ThetaStarPath, max_step_spaces_the_waypoints)
+{
+  int nx = 200, ny = 150;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 13, 150);
+  QuadraticCalculator p_calc(nx, ny);
+  ThetaStarExpansion theta(&p_calc, nx, ny);
+  ThetaStarPath theta_path(&p_calc, &theta);
+  theta.setSize(nx, ny);
+  theta_path.setSize(nx, ny);
+
+  std::vector<float> potential(nx * ny);
+  ASSERT_TRUE(theta.calculatePotentials(&costs[0], 5, 5, nx - 6, ny - 6, nx * ny * 2, &potential[0]));
+  std::vector<std::pair<float, float> > turns, path;
+  ASSERT_TRUE(theta_path.getPath(&potential[0], 5, 5, nx - 6, ny - 6, turns));
+  theta_path.setMaxStep(2.5);
+  ASSERT_TRUE(theta_path.getPath(&potential[0], 5, 5, nx - 6, ny - 6, path));
+
+  // the same turns, with points in between that are at most max_step apart
+  EXPECT_GT(path.size(), turns.size());
+  EXPECT_NEAR(pathLength(turns), pathLength(path), 1e-2);
+  unsigned int turn = 0;
+  for (unsigned int i = 0; i < path.size(); i++)
+  {
+    if (i > 0)
+    {
+      double step = hypot(path[i].first - path[i - 1].first, path[i].second - path[i - 1].second);
+      EXPECT_LE(step, 2.5 + 1e-4);
+    }
+    if (turn < turns.size() && path[i] == turns[turn])
+      turn++;
+  }
+  EXPECT_EQ(turns.size(), turn);
+}
+
+TEST(ThetaStarExpansion, no_path_to_a_walled_in_goal)
+{
+  int nx = 100, ny = 100;
+  std::vector<unsigned char> costs = makeCostmap(nx, ny, 13, 40);
+  for (int y = 60; y < 67; y++)
+    for (int x = 60; x < 67; x++)
+      costs[y * nx + x] = y == 60 || y == 66 || x == 60 || x == 66 ? costmap_2d::LETHAL_OBSTACLE : 0;
+  QuadraticCalculator p_calc(nx, ny);
+  ThetaStarExpansion theta(&p_calc, nx, ny);
+  ThetaStarPath theta_path(&p_calc, &theta);
+  theta.setSize(nx, ny);
+  theta_path.setSize(nx, ny);
+
+  std::vector<float> potential(nx * ny);
+  std::vector<std::pair<float, float> > path;
+  EXPECT_FALSE(theta.calculatePotentials(&costs[0], 5, 5, 63, 63, nx * ny * 2, &potential[0]));
+  EXPECT_FALSE(theta_path.getPath(&potential[0], 5, 5, 63, 63, path));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -47,11 +47,14 @@
 
 #include <nav_core/base_local_planner.h>
 #include <nav_core/base_global_planner.h>
+#include <nav_core/anytime_global_planner.h>
+#include <nav_core/tolerant_global_planner.h>
 #include <nav_core/recovery_behavior.h>
 #include <geometry_msgs/PoseStamped.h>
 #include <costmap_2d/costmap_2d_ros.h>
 #include <costmap_2d/costmap_2d.h>
 #include <nav_msgs/GetPlan.h>
+#include <move_base/plan_cache.h>
 
 #include <pluginlib/class_loader.h>
 #include <std_srvs/Empty.h>
@@ -123,9 +126,26 @@ namespace move_base {
        * @brief  Make a new global plan
        * @param  goal The goal to plan to
        * @param  plan Will be filled in with the plan made by the planner
+       * @param  callback Passed on to planners that implement AnytimeGlobalPlanner, none if empty
        * @return  True if planning succeeds, false otherwise
        */
-      bool makePlan(const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan);
+      bool makePlan(const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan,
+          const nav_core::AnytimeGlobalPlanner::PlanCallback& callback = nav_core::AnytimeGlobalPlanner::PlanCallback());
+
+      /**
+       * @brief  Hands an intermediate plan of the global planner to the controller, while the planner improves on it
+       */
+      void improvedPlanCB(const std::vector<geometry_msgs::PoseStamped>& plan);
+
+      /**
+       * @brief  Keeps the last plan while the robot follows it and it is still free, and only replans around the
+       * part of it that became blocked, before falling back to a new plan to the goal
+       * @param  goal The goal to plan to
+       * @param  plan Will be filled in with the repaired or the new plan, unless the last plan is kept
+       * @param  kept Set to true if the last plan is still valid, and plan was left empty
+       * @return  True if there is a valid plan, false otherwise
+       */
+      bool makeCachedPlan(const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan, bool& kept);
 
       /**
        * @brief  Load the recovery behaviors for the navigation stack from the parameter server
@@ -195,6 +215,9 @@ namespace move_base {
       ros::ServiceServer make_plan_srv_, clear_costmaps_srv_;
       bool shutdown_costmaps_, clearing_rotation_allowed_, recovery_behavior_enabled_;
       double oscillation_timeout_, oscillation_distance_;
+      bool use_plan_cache_;
+      double plan_cache_max_age_, plan_cache_tolerance_, plan_repair_margin_;
+      PlanCache plan_cache_;
 
       MoveBaseState state_;
       RecoveryTrigger recovery_trigger_;
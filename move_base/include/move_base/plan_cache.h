@@ -0,0 +1,112 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Eitan Marder-Eppstein
+*********************************************************************/
+#ifndef NAV_MOVE_BASE_PLAN_CACHE_H_
+#define NAV_MOVE_BASE_PLAN_CACHE_H_
+
+#include <vector>
+#include <ros/time.h>
+#include <geometry_msgs/PoseStamped.h>
+#include <costmap_2d/costmap_2d.h>
+
+namespace move_base {
+  /**
+   * @class PlanCache
+   * @brief Keeps the last global plan together with the costmap cells it passes through,
+   * so that the plan can be checked against the costmap without planning again
+   */
+  class PlanCache {
+    public:
+      PlanCache();
+
+      /**
+       * @brief  Stores a plan and rasterizes the cells between its poses
+       * @param costmap The costmap the plan was made on
+       * @param goal The goal the plan was made for
+       * @param plan The plan
+       * @param plan_time When the plan was made, which a repaired plan takes from the plan it was repaired from
+       */
+      void setPlan(const costmap_2d::Costmap2D& costmap, const geometry_msgs::PoseStamped& goal,
+          const std::vector<geometry_msgs::PoseStamped>& plan, const ros::Time& plan_time);
+
+      void clear();
+
+      /**
+       * @brief  Whether the stored plan was made for this goal, on a costmap with the same size and origin
+       */
+      bool matches(const costmap_2d::Costmap2D& costmap, const geometry_msgs::PoseStamped& goal) const;
+
+      /**
+       * @brief  Whether the stored plan was made max_age seconds or more before now
+       */
+      bool expired(const ros::Time& now, double max_age) const;
+
+      /**
+       * @brief  The index of the pose of the plan closest to a position, or -1 if none is within max_distance
+       */
+      int findClosestPose(double x, double y, double max_distance) const;
+
+      /**
+       * @brief  The index of the first pose from begin on whose segment crosses a cell the robot cannot be in, or -1 if there is none
+       */
+      int findBlockedPose(const costmap_2d::Costmap2D& costmap, unsigned int begin) const;
+
+      /**
+       * @brief  The index of the first pose after blocked that is followed by margin meters of free segments,
+       * or -1 if the plan reaches the goal before that
+       */
+      int findRejoinPose(const costmap_2d::Costmap2D& costmap, unsigned int blocked, double margin) const;
+
+      const std::vector<geometry_msgs::PoseStamped>& getPlan() const { return plan_; }
+
+      const ros::Time& getPlanTime() const { return plan_time_; }
+
+    private:
+      bool segmentBlocked(const unsigned char* costs, unsigned int i) const;
+
+      std::vector<geometry_msgs::PoseStamped> plan_;
+      geometry_msgs::PoseStamped goal_;
+      ros::Time plan_time_;
+
+      std::vector<unsigned int> cells_;
+      std::vector<unsigned int> segments_; /**< the cells from segments_[i] to segments_[i + 1] lead from pose i to pose i + 1 */
+      std::vector<double> lengths_; /**< the length of each segment in meters */
+
+      unsigned int size_x_, size_y_;
+      double origin_x_, origin_y_, resolution_;
+  };
+};
+#endif
@@ -76,6 +76,11 @@ namespace move_base {
     private_nh.param("oscillation_timeout", oscillation_timeout_, 0.0);
     private_nh.param("oscillation_distance", oscillation_distance_, 0.5);
 
+    private_nh.param("use_plan_cache", use_plan_cache_, false);
+    private_nh.param("plan_cache_max_age", plan_cache_max_age_, 10.0);
+    private_nh.param("plan_cache_tolerance", plan_cache_tolerance_, 0.5);
+    private_nh.param("plan_repair_margin", plan_repair_margin_, 1.0);
+
     //set up plan triple buffer
     planner_plan_ = new std::vector<geometry_msgs::PoseStamped>();
     latest_plan_ = new std::vector<geometry_msgs::PoseStamped>();
@@ -211,6 +216,11 @@ namespace move_base {
 
     oscillation_timeout_ = config.oscillation_timeout;
     oscillation_distance_ = config.oscillation_distance;
+
+    use_plan_cache_ = config.use_plan_cache;
+    plan_cache_max_age_ = config.plan_cache_max_age;
+    plan_cache_tolerance_ = config.plan_cache_tolerance;
+    plan_repair_margin_ = config.plan_repair_margin;
     if(config.base_global_planner != last_config_.base_global_planner) {
       boost::shared_ptr<nav_core::BaseGlobalPlanner> old_planner = planner_;
       //initialize the global planner
@@ -356,9 +366,19 @@ namespace move_base {
     //update the copy of the costmap the planner uses
     clearCostmapWindows(2 * clearing_radius_, 2 * clearing_radius_);
 
-    //first try to make a plan to the exact desired goal
+    //first try to make a plan to the exact desired goal, planners that can search around it do so in the same pass
     std::vector<geometry_msgs::PoseStamped> global_plan;
-    if(!planner_->makePlan(start, req.goal, global_plan) || global_plan.empty()){
+    float resolution = planner_costmap_ros_->getCostmap()->getResolution();
+    nav_core::TolerantGlobalPlanner* tolerant = dynamic_cast<nav_core::TolerantGlobalPlanner*>(planner_.get());
+    bool got_plan = tolerant ? tolerant->makePlan(start, req.goal, req.tolerance, global_plan)
+                             : planner_->makePlan(start, req.goal, global_plan);
+    if(got_plan && !global_plan.empty()){
+      //the plan may end anywhere within the tolerance, the local planner can still try to get to the original goal
+      const geometry_msgs::Point& end = global_plan.back().pose.position;
+      if(hypot(end.x - req.goal.pose.position.x, end.y - req.goal.pose.position.y) > resolution)
+        global_plan.push_back(req.goal);
+    }
+    else{
       ROS_DEBUG_NAMED("move_base","Failed to find a plan to exact goal of (%.2f, %.2f), searching for a feasible goal within tolerance", 
           req.goal.pose.position.x, req.goal.pose.position.y);
 
@@ -366,7 +386,6 @@ namespace move_base {
       geometry_msgs::PoseStamped p;
       p = req.goal;
       bool found_legal = false;
-      float resolution = planner_costmap_ros_->getCostmap()->getResolution();
       float search_increment = resolution*3.0;
       if(req.tolerance > 0.0 && req.tolerance < search_increment) search_increment = req.tolerance;
       for(float max_offset = search_increment; max_offset <= req.tolerance && !found_legal; max_offset += search_increment) {
@@ -446,7 +465,8 @@ namespace move_base {
     tc_.reset();
   }
 
-  bool MoveBase::makePlan(const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan){
+  bool MoveBase::makePlan(const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan,
+      const nav_core::AnytimeGlobalPlanner::PlanCallback& callback){
     boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(planner_costmap_ros_->getCostmap()->getMutex()));
 
     //make sure to set the plan to be empty initially
@@ -469,7 +489,10 @@ namespace move_base {
     tf::poseStampedTFToMsg(global_pose, start);
 
     //if the planner fails or returns a zero length plan, planning failed
-    if(!planner_->makePlan(start, goal, plan) || plan.empty()){
+    //only planners that implement the optional interface report intermediate plans
+    nav_core::AnytimeGlobalPlanner* anytime = callback ? dynamic_cast<nav_core::AnytimeGlobalPlanner*>(planner_.get()) : NULL;
+    bool got_plan = anytime ? anytime->makePlan(start, goal, plan, callback) : planner_->makePlan(start, goal, plan);
+    if(!got_plan || plan.empty()){
       ROS_DEBUG_NAMED("move_base","Failed to find a  plan to point (%.2f, %.2f)", goal.pose.position.x, goal.pose.position.y);
       return false;
     }
@@ -477,6 +500,59 @@ namespace move_base {
     return true;
   }
 
+  bool MoveBase::makeCachedPlan(const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan, bool& kept){
+    boost::unique_lock<costmap_2d::Costmap2D::mutex_t> lock(*(planner_costmap_ros_->getCostmap()->getMutex()));
+    costmap_2d::Costmap2D* costmap = planner_costmap_ros_->getCostmap();
+    kept = false;
+    plan.clear();
+
+    //only a plan the robot is following is worth keeping, the planning state asks for a new one
+    tf::Stamped<tf::Pose> global_pose;
+    if(state_ == CONTROLLING && plan_cache_.matches(*costmap, goal)
+        && !plan_cache_.expired(ros::Time::now(), plan_cache_max_age_)
+        && planner_costmap_ros_->getRobotPose(global_pose)){
+      int robot = plan_cache_.findClosestPose(global_pose.getOrigin().x(), global_pose.getOrigin().y(), plan_cache_tolerance_);
+      int blocked = robot < 0 ? -1 : plan_cache_.findBlockedPose(*costmap, robot);
+      if(robot >= 0 && blocked < 0){
+        ROS_DEBUG_NAMED("move_base_plan_thread","The last plan is still free, keeping it");
+        kept = true;
+        return true;
+      }
+
+      //plan a detour from the robot to where the plan is free again, and keep the rest
+      int rejoin = robot < 0 ? -1 : plan_cache_.findRejoinPose(*costmap, blocked, plan_repair_margin_);
+      if(rejoin >= 0 && makePlan(plan_cache_.getPlan()[rejoin], plan)){
+        ROS_DEBUG_NAMED("move_base_plan_thread","Repaired the last plan between poses %d and %d", blocked, rejoin);
+        plan.insert(plan.end(), plan_cache_.getPlan().begin() + rejoin + 1, plan_cache_.getPlan().end());
+        plan_cache_.setPlan(*costmap, goal, plan, plan_cache_.getPlanTime());
+        return true;
+      }
+    }
+
+    if(!makePlan(goal, plan, boost::bind(&MoveBase::improvedPlanCB, this, _1))){
+      plan_cache_.clear();
+      return false;
+    }
+    plan_cache_.setPlan(*costmap, goal, plan, ros::Time::now());
+    return true;
+  }
+
+  void MoveBase::improvedPlanCB(const std::vector<geometry_msgs::PoseStamped>& plan){
+    if(plan.empty())
+      return;
+
+    //the controller pulls from latest_plan_, the planner thread keeps filling planner_plan_ in the meantime
+    boost::unique_lock<boost::recursive_mutex> lock(planner_mutex_);
+    *latest_plan_ = plan;
+    last_valid_plan_ = ros::Time::now();
+    new_global_plan_ = true;
+    ROS_DEBUG_NAMED("move_base_plan_thread","Got an intermediate plan with %zu points", plan.size());
+
+    //start moving on it if we still haven't reached the goal
+    if(runPlanner_)
+      state_ = CONTROLLING;
+  }
+
   void MoveBase::publishZeroVelocity(){
     geometry_msgs::Twist cmd_vel;
     cmd_vel.linear.x = 0.0;
@@ -567,9 +643,19 @@ namespace move_base {
 
       //run planner
       planner_plan_->clear();
-      bool gotPlan = n.ok() && makePlan(temp_goal, *planner_plan_);
+      bool keptPlan = false;
+      bool gotPlan = n.ok() && (use_plan_cache_ ? makeCachedPlan(temp_goal, *planner_plan_, keptPlan) :
+          makePlan(temp_goal, *planner_plan_, boost::bind(&MoveBase::improvedPlanCB, this, _1)));
 
-      if(gotPlan){
+      if(keptPlan){
+        //the controller goes on with the plan it has
+        lock.lock();
+        last_valid_plan_ = ros::Time::now();
+        if(planner_frequency_ <= 0)
+          runPlanner_ = false;
+        lock.unlock();
+      }
+      else if(gotPlan){
         ROS_DEBUG_NAMED("move_base_plan_thread","Got Plan with %zu points!", planner_plan_->size());
         //pointer swap the plans under mutex (the controller will pull from latest_plan_)
         std::vector<geometry_msgs::PoseStamped>* temp_plan = planner_plan_;
@@ -0,0 +1,165 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of the Willow Garage nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Eitan Marder-Eppstein
+*********************************************************************/
+#include <move_base/plan_cache.h>
+#include <costmap_2d/cost_values.h>
+#include <cmath>
+#include <cstdlib>
+
+namespace move_base {
+
+  PlanCache::PlanCache() :
+    size_x_(0), size_y_(0), origin_x_(0.0), origin_y_(0.0), resolution_(0.0) {}
+
+  void PlanCache::setPlan(const costmap_2d::Costmap2D& costmap, const geometry_msgs::PoseStamped& goal,
+      const std::vector<geometry_msgs::PoseStamped>& plan, const ros::Time& plan_time){
+    clear();
+    if(plan.empty())
+      return;
+
+    plan_ = plan;
+    goal_ = goal;
+    plan_time_ = plan_time;
+    size_x_ = costmap.getSizeInCellsX();
+    size_y_ = costmap.getSizeInCellsY();
+    origin_x_ = costmap.getOriginX();
+    origin_y_ = costmap.getOriginY();
+    resolution_ = costmap.getResolution();
+
+    std::vector<int> mx(plan.size()), my(plan.size());
+    for(unsigned int i = 0; i < plan.size(); ++i)
+      costmap.worldToMapEnforceBounds(plan[i].pose.position.x, plan[i].pose.position.y, mx[i], my[i]);
+
+    //walk each segment with bresenham, the cell of its end pose belongs to the next segment
+    segments_.reserve(plan.size() + 1);
+    lengths_.reserve(plan.size());
+    for(unsigned int i = 0; i < plan.size(); ++i){
+      segments_.push_back(cells_.size());
+      if(i + 1 == plan.size()){
+        cells_.push_back(costmap.getIndex(mx[i], my[i]));
+        lengths_.push_back(0.0);
+        break;
+      }
+      lengths_.push_back(hypot(plan[i + 1].pose.position.x - plan[i].pose.position.x,
+            plan[i + 1].pose.position.y - plan[i].pose.position.y));
+
+      int x = mx[i], y = my[i];
+      int dx = abs(mx[i + 1] - x), dy = -abs(my[i + 1] - y);
+      int sx = x < mx[i + 1] ? 1 : -1, sy = y < my[i + 1] ? 1 : -1;
+      int error = dx + dy;
+      while(x != mx[i + 1] || y != my[i + 1]){
+        cells_.push_back(costmap.getIndex(x, y));
+        int e2 = 2 * error;
+        if(e2 >= dy){
+          error += dy;
+          x += sx;
+        }
+        if(e2 <= dx){
+          error += dx;
+          y += sy;
+        }
+      }
+    }
+    segments_.push_back(cells_.size());
+  }
+
+  void PlanCache::clear(){
+    plan_.clear();
+    cells_.clear();
+    segments_.clear();
+    lengths_.clear();
+  }
+
+  bool PlanCache::matches(const costmap_2d::Costmap2D& costmap, const geometry_msgs::PoseStamped& goal) const {
+    return !plan_.empty()
+      && goal.header.frame_id == goal_.header.frame_id && goal.header.stamp == goal_.header.stamp
+      && goal.pose.position.x == goal_.pose.position.x && goal.pose.position.y == goal_.pose.position.y
+      && goal.pose.orientation.z == goal_.pose.orientation.z && goal.pose.orientation.w == goal_.pose.orientation.w
+      && costmap.getSizeInCellsX() == size_x_ && costmap.getSizeInCellsY() == size_y_
+      && costmap.getOriginX() == origin_x_ && costmap.getOriginY() == origin_y_
+      && costmap.getResolution() == resolution_;
+  }
+
+  bool PlanCache::expired(const ros::Time& now, double max_age) const {
+    return now >= plan_time_ + ros::Duration(max_age);
+  }
+
+  int PlanCache::findClosestPose(double x, double y, double max_distance) const {
+    int closest = -1;
+    double closest_sq = max_distance * max_distance;
+    for(unsigned int i = 0; i < plan_.size(); ++i){
+      double dx = plan_[i].pose.position.x - x, dy = plan_[i].pose.position.y - y;
+      if(dx * dx + dy * dy <= closest_sq){
+        closest_sq = dx * dx + dy * dy;
+        closest = i;
+      }
+    }
+    return closest;
+  }
+
+  bool PlanCache::segmentBlocked(const unsigned char* costs, unsigned int i) const {
+    for(unsigned int k = segments_[i]; k < segments_[i + 1]; ++k){
+      unsigned char cost = costs[cells_[k]];
+      if(cost >= costmap_2d::INSCRIBED_INFLATED_OBSTACLE && cost != costmap_2d::NO_INFORMATION)
+        return true;
+    }
+    return false;
+  }
+
+  int PlanCache::findBlockedPose(const costmap_2d::Costmap2D& costmap, unsigned int begin) const {
+    const unsigned char* costs = costmap.getCharMap();
+    for(unsigned int i = begin; i < plan_.size(); ++i)
+      if(segmentBlocked(costs, i))
+        return i;
+    return -1;
+  }
+
+  int PlanCache::findRejoinPose(const costmap_2d::Costmap2D& costmap, unsigned int blocked, double margin) const {
+    const unsigned char* costs = costmap.getCharMap();
+    double free_length = 0.0;
+    //the goal itself is never a rejoin pose, the detour to it would be a full plan
+    for(unsigned int i = blocked + 1; i + 2 < plan_.size(); ++i){
+      if(segmentBlocked(costs, i)){
+        free_length = 0.0;
+        continue;
+      }
+      free_length += lengths_[i];
+      if(free_length >= margin)
+        return i + 1;
+    }
+    return -1;
+  }
+};
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2013, Willow Garage, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the Willow Garage, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived from
+ *       this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include <costmap_2d/cost_values.h>
+#include <costmap_2d/costmap_2d.h>
+#include <move_base/plan_cache.h>
+
+using namespace move_base;
+
+geometry_msgs::PoseStamped makePose(double x, double y)
+{
+  geometry_msgs::PoseStamped pose;
+  pose.header.frame_id = "map";
+  pose.pose.position.x = x;
+  pose.pose.position.y = y;
+  pose.pose.orientation.w = 1.0;
+  return pose;
+}
+
+// poses 1m apart, right along y = 1.025 and then diagonally up
+std::vector<geometry_msgs::PoseStamped> makePlan()
+{
+  std::vector<geometry_msgs::PoseStamped> plan;
+  for (int i = 0; i < 6; i++)
+    plan.push_back(makePose(0.525 + i, 1.025));
+  for (int i = 1; i < 3; i++)
+    plan.push_back(makePose(5.525 + i, 1.025 + i));
+  return plan;
+}
+
+class PlanCacheTest : public testing::Test
+{
+protected:
+  PlanCacheTest() :
+      costmap(200, 100, 0.05, 0.0, 0.0), plan(makePlan()), plan_time(100.0)
+  {
+    cache.setPlan(costmap, plan.back(), plan, plan_time);
+  }
+
+  void setCost(double x, double y, unsigned char cost)
+  {
+    unsigned int mx, my;
+    ASSERT_TRUE(costmap.worldToMap(x, y, mx, my));
+    costmap.setCost(mx, my, cost);
+  }
+
+  costmap_2d::Costmap2D costmap;
+  std::vector<geometry_msgs::PoseStamped> plan;
+  ros::Time plan_time;
+  PlanCache cache;
+};
+
+TEST_F(PlanCacheTest, segments_cover_the_cells_between_poses)
+{
+  EXPECT_EQ(-1, cache.findBlockedPose(costmap, 0));
+
+  // halfway between two poses, on a straight and on a diagonal segment
+  setCost(3.025, 1.025, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(2, cache.findBlockedPose(costmap, 0));
+  EXPECT_EQ(-1, cache.findBlockedPose(costmap, 3));
+  setCost(6.025, 1.525, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(5, cache.findBlockedPose(costmap, 3));
+
+  // next to the line is not on it
+  costmap.resetMap(0, 0, costmap.getSizeInCellsX(), costmap.getSizeInCellsY());
+  setCost(3.025, 1.075, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(-1, cache.findBlockedPose(costmap, 0));
+}
+
+TEST_F(PlanCacheTest, inscribed_cells_block_and_unknown_cells_do_not)
+{
+  setCost(1.525, 1.025, costmap_2d::NO_INFORMATION);
+  EXPECT_EQ(-1, cache.findBlockedPose(costmap, 0));
+  setCost(1.525, 1.025, costmap_2d::INSCRIBED_INFLATED_OBSTACLE - 1);
+  EXPECT_EQ(-1, cache.findBlockedPose(costmap, 0));
+  setCost(1.525, 1.025, costmap_2d::INSCRIBED_INFLATED_OBSTACLE);
+  EXPECT_EQ(1, cache.findBlockedPose(costmap, 0));
+
+  // the cell of the last pose belongs to the last segment
+  setCost(7.525, 3.025, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(7, cache.findBlockedPose(costmap, 2));
+}
+
+TEST_F(PlanCacheTest, rejoins_after_margin_of_free_segments)
+{
+  setCost(1.525, 1.025, costmap_2d::LETHAL_OBSTACLE);
+  ASSERT_EQ(1, cache.findBlockedPose(costmap, 0));
+  EXPECT_EQ(3, cache.findRejoinPose(costmap, 1, 1.0));
+  EXPECT_EQ(4, cache.findRejoinPose(costmap, 1, 2.0));
+
+  // a blocked segment on the way restarts the free length
+  setCost(2.525, 1.025, costmap_2d::LETHAL_OBSTACLE);
+  EXPECT_EQ(5, cache.findRejoinPose(costmap, 1, 2.0));
+
+  // the goal is not a rejoin pose
+  EXPECT_EQ(-1, cache.findRejoinPose(costmap, 1, 4.0));
+}
+
+TEST_F(PlanCacheTest, expires_with_age_and_distance)
+{
+  EXPECT_TRUE(cache.matches(costmap, plan.back()));
+  EXPECT_FALSE(cache.matches(costmap, plan.front()));
+  EXPECT_FALSE(cache.expired(plan_time + ros::Duration(9.9), 10.0));
+  EXPECT_TRUE(cache.expired(plan_time + ros::Duration(10.0), 10.0));
+
+  // a plan repaired later keeps the time of the plan it was repaired from
+  cache.setPlan(costmap, plan.back(), plan, cache.getPlanTime());
+  EXPECT_TRUE(cache.expired(plan_time + ros::Duration(10.0), 10.0));
+
+  // the robot is only on the plan within the tolerance
+  EXPECT_EQ(2, cache.findClosestPose(2.525, 1.325, 0.5));
+  EXPECT_EQ(-1, cache.findClosestPose(2.525, 1.625, 0.5));
+  EXPECT_EQ(2, cache.findClosestPose(2.525, 1.625, 0.7));
+
+  // and neither does a costmap with another origin, or a cleared cache
+  costmap_2d::Costmap2D other(200, 100, 0.05, 1.0, 0.0);
+  EXPECT_FALSE(cache.matches(other, plan.back()));
+  cache.clear();
+  EXPECT_FALSE(cache.matches(costmap, plan.back()));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
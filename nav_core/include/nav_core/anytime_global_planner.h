@@ -0,0 +1,77 @@
+/*********************************************************************
+*
+* Software License Agreement (BSD License)
+*
+*  Copyright (c) 2008, Willow Garage, Inc.
+*  All rights reserved.
+*
+*  Redistribution and use in source and binary forms, with or without
+*  modification, are permitted provided that the following conditions
+*  are met:
+*
+*   * Redistributions of source code must retain the above copyright
+*     notice, this list of conditions and the following disclaimer.
+*   * Redistributions in binary form must reproduce the above
+*     copyright notice, this list of conditions and the following
+*     disclaimer in the documentation and/or other materials provided
+*     with the distribution.
+*   * Neither the name of Willow Garage, Inc. nor the names of its
+*     contributors may be used to endorse or promote products derived
+*     from this software without specific prior written permission.
+*
+*  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+*  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+*  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+*  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+*  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+*  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+*  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+*  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+*  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+*  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+*  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+*  POSSIBILITY OF SUCH DAMAGE.
+*
+* Author: Eitan Marder-Eppstein
+*********************************************************************/
+#ifndef NAV_CORE_ANYTIME_GLOBAL_PLANNER_H
+#define NAV_CORE_ANYTIME_GLOBAL_PLANNER_H
+
+#include <geometry_msgs/PoseStamped.h>
+#include <boost/function.hpp>
+#include <vector>
+
+namespace nav_core {
+  /**
+   * @class AnytimeGlobalPlanner
+   * @brief An optional interface for global planners that find valid plans before their final one. A planner
+   * plugin implements it next to BaseGlobalPlanner, and move_base checks for it with a dynamic_cast, so plugins
+   * built without it keep working.
+   */
+  class AnytimeGlobalPlanner{
+    public:
+      typedef boost::function<void(const std::vector<geometry_msgs::PoseStamped>&)> PlanCallback;
+
+      /**
+       * @brief Given a goal pose in the world, compute a plan, reporting the valid plans found before the final one
+       * @param start The start pose 
+       * @param goal The goal pose 
+       * @param plan The plan... filled by the planner
+       * @param callback Called from within makePlan with every intermediate plan
+       * @return True if a valid plan was found, false otherwise
+       */
+      virtual bool makePlan(const geometry_msgs::PoseStamped& start, 
+                            const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan,
+                            const PlanCallback& callback) = 0;
+
+      /**
+       * @brief  Virtual destructor for the interface
+       */
+      virtual ~AnytimeGlobalPlanner(){}
+
+    protected:
+      AnytimeGlobalPlanner(){}
+  };
+};  // namespace nav_core
+
+#endif  // NAV_CORE_ANYTIME_GLOBAL_PLANNER_H
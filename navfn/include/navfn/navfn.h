@@ -45,6 +45,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdio.h>
+#include <vector>
 
 // cost defs
 #define COST_UNKNOWN_ROS 255		// 255 is unknown cost
@@ -77,8 +78,13 @@
 // priority buffers
 #define PRIORITYBUFSIZE 10000
 
+// gradient window, a power of two
+#define GRADWINDOW 16
+
 
 namespace navfn {
+  class PropagationWorkers;
+
   /**
     Navigation function call.
     \param costmap Cost map array, of type COSTTYPE; origin is upper left
@@ -97,6 +103,30 @@ positions at about 1/2 cell resolution; else returns 0.
       int* goal, int* start,
       float *plan, int nplan);
 
+  /**
+   * @brief  Marks the cells within a radius of a path, as the corridor a replan to the same goal is restricted to
+   * @param path_x The x coordinates of the path in cells
+   * @param path_y The y coordinates of the path in cells
+   * @param radius The radius of the corridor in cells
+   * @param nx The x size of the map
+   * @param ny The y size of the map
+   * @param mask Set to 1 for the cells of the corridor, of size nx * ny
+   * @param cells The cells that were not marked before are added here, to clear the mask again
+   */
+  void markCorridor(const std::vector<int>& path_x, const std::vector<int>& path_y, int radius, int nx, int ny,
+      std::vector<unsigned char>& mask, std::vector<int>& cells);
+
+  /**
+   * @brief  Closes the cells around a corridor, which is all a propagation from inside of it needs to stay there
+   * @param mask The corridor, as marked by markCorridor
+   * @param cells The cells of the corridor
+   * @param nx The x size of the map
+   * @param ny The y size of the map
+   * @param costarr The costmap, the 4-neighbors of the corridor that are not part of it are set to COST_OBS
+   */
+  void closeCorridor(const std::vector<unsigned char>& mask, const std::vector<int>& cells, int nx, int ny,
+      COSTTYPE *costarr);
+
 
 
   /**
@@ -142,6 +172,14 @@ positions at about 1/2 cell resolution; else returns 0.
        */
       bool calcNavFnDijkstra(bool atStart = false);	/**< calculates the full navigation function */
 
+      /**
+       * @brief  Calculates the full navigation function using fast sweeping instead of Dijkstra.
+       * Costs more than calcNavFnDijkstra on maps with long winding corridors, but its memory
+       * access is sequential, and it is split between the threads set with setNumThreads.
+       * @return true if a path from the start was found
+       */
+      bool calcNavFnSweep();
+
       /**
        * @brief  Accessor for the x-coordinates of a path
        * @return The x-coordinates of a path
@@ -220,6 +258,13 @@ positions at about 1/2 cell resolution; else returns 0.
        */
       void updateCellAstar(int n);	/**< updates the cell at index <n>, uses A* heuristic */
 
+      /**
+       * @brief  Calculates the potential of a free cell from the potentials of its neighbors
+       * @param n The index of the cell
+       * @param l,r,u,d The potentials of the left, right, upper and lower neighbor
+       */
+      float calcPotential(int n, float l, float r, float u, float d);
+
       void setupNavFn(bool keepit = false); /**< resets all nav fn arrays for propagation */
 
       /**
@@ -229,6 +274,77 @@ positions at about 1/2 cell resolution; else returns 0.
        * @return true if the start point is reached
        */
       bool propNavFnDijkstra(int cycles, bool atStart = false); /**< returns true if start point found or full prop */
+
+      std::vector<int> targets;	/**< cells that have to be reached along with the start before a propagation stops at it */
+      std::vector<int> alternatives;	/**< cells that are as good as the start when the propagation reaches them */
+      float altMargin;		/**< how far the propagation goes on past the first alternative, so that the ones closer to the start are reached too */
+      std::vector<unsigned char> altmask;	/**< marks the alternatives of the current propagation, empty if there are none */
+      float altpot;		/**< the lowest potential of an alternative reached so far */
+
+      /**
+       * @brief  Whether the propagation has reached the start cell, or the margin past one of its alternatives, and all the targets
+       */
+      bool reachedStart();
+
+      /**
+       * @brief  reachedStart for a priority threshold and lowest alternative potential of a propagation thread
+       */
+      bool reachedStart(float thresh, float alt);
+
+      /**
+       * @brief  Sets the number of threads that propNavFnDijkstra uses
+       * @param n The number of threads, including the calling one; 1 propagates on the calling thread only
+       */
+      void setNumThreads(int n);
+      int nthreads;		/**< number of propagation threads */
+      PropagationWorkers *workers; /**< worker threads and their priority buffers, NULL for one thread */
+
+      /**
+       * @brief  Parallel version of propNavFnDijkstra, called by it when more than one thread is set.
+       * Every cell of a priority block is updated from the potentials before the block, and the
+       * cells are split between the threads by blocks of rows, so the result does not depend on
+       * the number of threads or their timing. The order of the updates is not that of the
+       * sequential propagation, which leaves the same cells reached but their potentials a few
+       * percent apart, and the paths within a cell of each other.
+       * @param cycles The maximum number of iterations to run for
+       * @param atStart Whether or not to stop when the start point is reached
+       * @return true if the start point is reached
+       */
+      bool propNavFnDijkstraParallel(int cycles, bool atStart = false);
+
+      /**
+       * @brief  The part of propNavFnDijkstraParallel run by thread <t>
+       */
+      void propNavFnThread(int t);
+
+      /**
+       * @brief  Run fast sweeping propagation over the whole map: Gauss-Seidel sweeps with the update
+       * of updateCell in the four diagonal directions, until a round of four sweeps lowers no
+       * potential. The map is swept in tiles by anti-diagonal wavefronts, which are split between the
+       * threads set with setNumThreads with the same result as on one thread.
+       * @param sweeps The maximum number of rounds of four sweeps
+       * @return true if the potentials converged
+       */
+      bool propNavFnSweep(int sweeps);
+
+      /**
+       * @brief  Sweeps the cells in [x0,x1) x [y0,y1) in direction <dx>,<dy>
+       * @return true if a potential was lowered
+       */
+      bool sweepCells(int x0, int x1, int y0, int y1, int dx, int dy);
+
+      /**
+       * @brief  Sweeps the tiles on anti-diagonal <k> of sweep <step> that belong to thread <t> of <nt>
+       * @return true if a potential was lowered
+       */
+      bool sweepDiagonal(int step, int k, int t, int nt);
+      int ntilex, ntiley;	/**< number of tiles of the fast sweeping */
+      std::vector<int> tileswept, tilechanged; /**< sweep in which each tile was last swept and last changed */
+
+      /**
+       * @brief  The part of propNavFnSweep run by thread <t>
+       */
+      void propNavFnSweepThread(int t);
       /**
        * @brief  Run propagation for <cycles> iterations, or until start is reached using the best-first A* method with Euclidean distance heuristic
        * @param cycles The maximum number of iterations to run for
@@ -237,7 +353,13 @@ positions at about 1/2 cell resolution; else returns 0.
       bool propNavFnAstar(int cycles); /**< returns true if start point found */
 
       /** gradient and paths */
-      float *gradx, *grady;		/**< gradient arrays, size of potential array */
+      float *gradx, *grady;		/**< gradients of the cells in the window around the path point, GRADWINDOW x GRADWINDOW */
+      int *gradcell;		/**< the cell each slot of gradx, grady holds, -1 if none */
+
+      /**
+       * @brief  The slot of cell <n> in gradx, grady; cells closer than GRADWINDOW on both axes never share one
+       */
+      int gradSlot(int n) { return (n%nx & (GRADWINDOW-1)) + (n/nx & (GRADWINDOW-1))*GRADWINDOW; }
       float *pathx, *pathy;		/**< path points, as subpixel cell coordinates */
       int npath;			/**< number of path points */
       int npathbuf;			/**< size of pathx, pathy buffers */
@@ -252,7 +374,7 @@ positions at about 1/2 cell resolution; else returns 0.
        */
       int calcPath(int n, int *st = NULL); /**< calculates path for at most <n> cycles, returns path length, 0 if none */
 
-      float gradCell(int n);	/**< calculates gradient at cell <n>, returns norm */
+      float gradCell(int n);	/**< calculates gradient at cell <n> into its slot, returns norm */
       float pathStep;		/**< step size for following gradient */
 
       /** display callback */
@@ -46,16 +46,19 @@
 #include <tf/transform_datatypes.h>
 #include <vector>
 #include <nav_core/base_global_planner.h>
+#include <nav_core/tolerant_global_planner.h>
 #include <nav_msgs/GetPlan.h>
+#include <navfn/MakeNavPlans.h>
 #include <navfn/potarr_point.h>
 #include <pcl_ros/publisher.h>
+#include <boost/thread.hpp>
 
 namespace navfn {
   /**
    * @class NavfnROS
    * @brief Provides a ROS wrapper for the navfn planner which runs a fast, interpolated navigation function on a costmap.
    */
-  class NavfnROS : public nav_core::BaseGlobalPlanner {
+  class NavfnROS : public nav_core::BaseGlobalPlanner, public nav_core::TolerantGlobalPlanner {
     public:
       /**
        * @brief  Default constructor for the NavFnROS object
@@ -113,6 +116,18 @@ namespace navfn {
       bool makePlan(const geometry_msgs::PoseStamped& start, 
           const geometry_msgs::PoseStamped& goal, double tolerance, std::vector<geometry_msgs::PoseStamped>& plan);
 
+      /**
+       * @brief Given many goal poses in the world, compute their costs and plans with a single propagation,
+       * which stops once it has reached all of the goals
+       * @param start The start pose 
+       * @param goals The goal poses 
+       * @param costs Will be filled with the value of the navigation function at each goal, POT_HIGH for the goals that could not be reached
+       * @param plans If not NULL, will be filled with the plan to each goal, empty for the goals that could not be reached
+       * @return True if at least one goal could be reached, false otherwise
+       */
+      bool makePlans(const geometry_msgs::PoseStamped& start, const std::vector<geometry_msgs::PoseStamped>& goals,
+          std::vector<double>& costs, std::vector<std::vector<geometry_msgs::PoseStamped> >* plans = NULL);
+
       /**
        * @brief  Computes the full navigation function for the map given a point in the world to start from
        * @param world_point The point to use for seeding the navigation function 
@@ -155,10 +170,12 @@ namespace navfn {
        */
       void publishPlan(const std::vector<geometry_msgs::PoseStamped>& path, double r, double g, double b, double a);
 
-      ~NavfnROS(){}
+      ~NavfnROS();
 
       bool makePlanService(nav_msgs::GetPlan::Request& req, nav_msgs::GetPlan::Response& resp);
 
+      bool makePlansService(MakeNavPlans::Request& req, MakeNavPlans::Response& resp);
+
     protected:
 
       /**
@@ -168,7 +185,10 @@ namespace navfn {
       boost::shared_ptr<NavFn> planner_;
       ros::Publisher plan_pub_;
       pcl_ros::Publisher<PotarrPoint> potarr_pub_;
-      bool initialized_, allow_unknown_, visualize_potential_;
+      bool initialized_, allow_unknown_, visualize_potential_, use_fast_sweeping_;
+      int potential_downsample_; /**< only every n-th cell of the potential is published on both axes */
+      bool nearest_reachable_goal_; /**< with a tolerance and a blocked goal cell, stop the propagation soon after the first cell within it */
+      double potential_crop_margin_; /**< if positive, only the potential around the plan is published */
 
 
     private:
@@ -179,12 +199,41 @@ namespace navfn {
       }
 
       void mapToWorld(double mx, double my, double& wx, double& wy);
+
+      /**
+       * @brief  Hands the potential around the plan to the background thread, if anybody listens
+       */
+      void publishPotential(const std::vector<geometry_msgs::PoseStamped>& plan);
+      void publishPotentialThread();
+
+      bool extractPlan(unsigned int mx, unsigned int my, std::vector<geometry_msgs::PoseStamped>& plan);
       void clearRobotCell(const tf::Stamped<tf::Pose>& global_pose, unsigned int mx, unsigned int my);
+
+      /**
+       * @brief  Closes the cells of the navfn costmap around the corridor of the last plan, so that the propagation stays in it
+       * @return False if the goal changed or the robot left the corridor, the costmap is left alone then
+       */
+      bool restrictToCorridor(int* map_start, int* map_goal);
+
       double planner_window_x_, planner_window_y_, default_tolerance_;
       std::string tf_prefix_;
       boost::mutex mutex_;
-      ros::ServiceServer make_plan_srv_;
+      ros::ServiceServer make_plan_srv_, make_plans_srv_;
       std::string global_frame_;
+
+      // the potential is published from its own thread, only the latest cloud waits for it
+      boost::thread* potarr_thread_;
+      boost::mutex potarr_mutex_;
+      boost::condition_variable potarr_cond_;
+      pcl::PointCloud<PotarrPoint> potarr_cloud_;
+      bool potarr_pending_, potarr_stop_;
+
+      // replans to the same goal only propagate through the corridor around the last plan
+      double corridor_width_; /**< full width of the corridor in meters, 0 disables it */
+      std::vector<geometry_msgs::PoseStamped> last_plan_;
+      geometry_msgs::Point last_goal_; /**< the goal last_plan_ was made for, it may end anywhere within the tolerance */
+      std::vector<unsigned char> corridor_mask_;
+      std::vector<int> corridor_cells_; /**< the cells set in corridor_mask_, to clear them again */
   };
 };
 
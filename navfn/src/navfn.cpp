@@ -45,9 +45,131 @@
 
 #include <navfn/navfn.h>
 #include <ros/console.h>
+#include <limits.h>
+#include <boost/atomic.hpp>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <vector>
+
+// rows per block when splitting the map between propagation threads
+#define PROP_ROW_BLOCK 8
+
+// side of the tiles swept by one thread in the parallel fast sweeping
+#define SWEEP_TILE 32
 
 namespace navfn {
 
+  //
+  // worker threads for the parallel propagation
+  // they sleep between propagations and meet at a spinning barrier
+  //   between the phases of a propagation
+  //
+
+  struct PropagationBuffers
+  {
+    std::vector<int> cur, next, over; /**< priority blocks of the cells owned by a thread */
+    std::vector<int> upd;	/**< cells whose potential decreased in the current block */
+    std::vector<float> updpot;	/**< their new potentials */
+    std::vector<std::vector<int> > outnext, outover; /**< pushed cells owned by other threads, by owner */
+    bool changed;		/**< whether the thread lowered a potential in the current round of sweeps */
+    float alt;			/**< the lowest potential of an alternative the thread has set */
+    bool sense;			/**< barrier sense of the thread */
+  };
+
+  class PropagationWorkers
+  {
+    public:
+      PropagationWorkers(NavFn *nav, int n)
+        : size(n), buf(n), block(1), nnext(n), nover(n), nav_(nav), job_(NULL), generation_(0), stop_(false), arrived_(0), sense_(false)
+      {
+        for (int t=0; t<n; t++)
+        {
+          buf[t].outnext.resize(n);
+          buf[t].outover.resize(n);
+          buf[t].sense = false;
+        }
+        for (int t=1; t<n; t++)
+          threads_.create_thread(boost::bind(&PropagationWorkers::loop, this, t));
+      }
+
+      ~PropagationWorkers()
+      {
+        {
+          boost::mutex::scoped_lock lock(mutex_);
+          stop_ = true;
+        }
+        cond_.notify_all();
+        threads_.join_all();
+      }
+
+      // runs a NavFn member taking the thread number on all threads, the caller is thread 0
+      void run(void (NavFn::*job)(int))
+      {
+        {
+          boost::mutex::scoped_lock lock(mutex_);
+          job_ = job;
+          generation_++;
+        }
+        cond_.notify_all();
+        (nav_->*job)(0);
+      }
+
+      void barrier(int t)
+      {
+        bool sense = buf[t].sense = !buf[t].sense;
+        if (arrived_.fetch_add(1) == size - 1)
+        {
+          arrived_.store(0);
+          sense_.store(sense);
+        }
+        else
+        {
+          int spins = 0;
+          while (sense_.load() != sense)
+            if (++spins > 1000)
+              boost::this_thread::yield();
+        }
+      }
+
+      int size;			/**< number of threads, including the caller of run() */
+      std::vector<PropagationBuffers> buf;
+      std::vector<unsigned int> stamp; /**< block in which each cell was last updated */
+      unsigned int block;		/**< stamp of the first block of the current propagation */
+      std::vector<int> nnext, nover; /**< sizes of the priority blocks, published by each thread */
+      int cycles, cycle, total;	/**< cycle limit, cycles used and initial number of cells */
+      bool atStart;
+
+    private:
+      void loop(int t)
+      {
+        int seen = 0;
+        while (true)
+        {
+          void (NavFn::*job)(int);
+          {
+            boost::mutex::scoped_lock lock(mutex_);
+            while (generation_ == seen && !stop_)
+              cond_.wait(lock);
+            if (stop_)
+              return;
+            seen = generation_;
+            job = job_;
+          }
+          (nav_->*job)(t);
+        }
+      }
+
+      NavFn *nav_;
+      void (NavFn::*job_)(int);
+      boost::thread_group threads_;
+      boost::mutex mutex_;
+      boost::condition_variable cond_;
+      int generation_;
+      bool stop_;
+      boost::atomic<int> arrived_;
+      boost::atomic<bool> sense_;
+  };
+
   //
   // function to perform nav fn calculation
   // keeps track of internal buffers, will be more efficient
@@ -101,6 +223,64 @@ namespace navfn {
     }
 
 
+  //
+  // stamp a disc every half radius along the path, which keeps the corridor
+  //   at least 0.97 of its width wide
+  //
+
+  void
+    markCorridor(const std::vector<int>& path_x, const std::vector<int>& path_y, int radius, int nx, int ny,
+        std::vector<unsigned char>& mask, std::vector<int>& cells)
+    {
+      int last_x = -1, last_y = -1;
+      for (unsigned int i = 0; i < path_x.size(); i++)
+      {
+        int cx = path_x[i], cy = path_y[i];
+        if (last_x >= 0 && i + 1 < path_x.size()
+            && 4 * ((cx - last_x) * (cx - last_x) + (cy - last_y) * (cy - last_y)) < radius * radius)
+          continue;
+        last_x = cx;
+        last_y = cy;
+
+        for (int y = std::max(0, cy - radius); y <= std::min(ny - 1, cy + radius); y++)
+        {
+          int half_width = sqrt(radius * radius - (y - cy) * (y - cy));
+          for (int x = std::max(0, cx - half_width); x <= std::min(nx - 1, cx + half_width); x++)
+          {
+            int n = y * nx + x;
+            if (!mask[n])
+            {
+              mask[n] = 1;
+              cells.push_back(n);
+            }
+          }
+        }
+      }
+    }
+
+
+  //
+  // close the 4-neighbors of the corridor, the propagation only ever steps
+  //   to those, so the rest of the map is never touched
+  //
+
+  void
+    closeCorridor(const std::vector<unsigned char>& mask, const std::vector<int>& cells, int nx, int ny,
+        COSTTYPE *costarr)
+    {
+      for (unsigned int i = 0; i < cells.size(); i++)
+      {
+        int n = cells[i], x = n % nx;
+        if (x > 0 && !mask[n-1])
+          costarr[n-1] = COST_OBS;
+        if (x < nx - 1 && !mask[n+1])
+          costarr[n+1] = COST_OBS;
+        if (n >= nx && !mask[n-nx])
+          costarr[n-nx] = COST_OBS;
+        if (n < (ny - 1) * nx && !mask[n+nx])
+          costarr[n+nx] = COST_OBS;
+      }
+    }
 
 
   //
@@ -113,9 +293,22 @@ namespace navfn {
     costarr = NULL;
     potarr = NULL;
     pending = NULL;
-    gradx = grady = NULL;
     setNavArr(xs,ys);
 
+    // the gradients are only needed around the current path point, so they
+    //   are kept in a small window that slides along the path
+    gradx = new float[GRADWINDOW*GRADWINDOW];
+    grady = new float[GRADWINDOW*GRADWINDOW];
+    gradcell = new int[GRADWINDOW*GRADWINDOW];
+
+    // propagation threads
+    nthreads = 1;
+    workers = NULL;
+
+    // stopping at alternatives of the start
+    altMargin = 0;
+    altpot = POT_HIGH;
+
     // priority buffers
     pb1 = new int[PRIORITYBUFSIZE];
     pb2 = new int[PRIORITYBUFSIZE];
@@ -152,6 +345,8 @@ namespace navfn {
       delete[] gradx;
     if(grady)
       delete[] grady;
+    if(gradcell)
+      delete[] gradcell;
     if(pathx)
       delete[] pathx;
     if(pathy)
@@ -162,6 +357,8 @@ namespace navfn {
       delete[] pb2;
     if(pb3)
       delete[] pb3;
+    if(workers)
+      delete workers;
   }
 
 
@@ -205,18 +402,11 @@ namespace navfn {
       if(pending)
         delete[] pending;
 
-      if(gradx)
-        delete[] gradx;
-      if(grady)
-        delete[] grady;
-
       costarr = new COSTTYPE[ns]; // cost array, 2d config space
       memset(costarr, 0, ns*sizeof(COSTTYPE));
       potarr = new float[ns];	// navigation potential array
       pending = new bool[ns];
       memset(pending, 0, ns*sizeof(bool));
-      gradx = new float[ns];
-      grady = new float[ns];
     }
 
 
@@ -317,6 +507,35 @@ namespace navfn {
     }
 
 
+  //
+  // calculate the full navigation function with fast sweeping
+  //
+
+  bool
+    NavFn::calcNavFnSweep()
+    {
+      setupNavFn(true);
+
+      // calculate the nav fn and path
+      if (!propNavFnSweep(nx+ny))
+        ROS_DEBUG("[NavFn] Fast sweeping did not converge\n");
+
+      // path
+      int len = calcPath(nx*ny/2);
+
+      if (len > 0)			// found plan
+      {
+        ROS_DEBUG("[NavFn] Path found, %d steps\n", len);
+        return true;
+      }
+      else
+      {
+        ROS_DEBUG("[NavFn] No path found\n");
+        return false;
+      }
+    }
+
+
   //
   // calculate navigation function, given a costmap, goal, and start
   //
@@ -406,7 +625,6 @@ namespace navfn {
       {
         potarr[i] = POT_HIGH;
         if (!keepit) costarr[i] = COST_NEUTRAL;
-        gradx[i] = grady[i] = 0.0;
       }
 
       // outer bounds of cost array
@@ -434,6 +652,16 @@ namespace navfn {
       overPe = 0;
       memset(pending, 0, ns*sizeof(bool));
 
+      // mark the alternatives, which are checked as their potentials are set
+      altmask.clear();
+      altpot = POT_HIGH;
+      if (!alternatives.empty())
+      {
+        altmask.assign(ns, 0);
+        for (unsigned int i=0; i<alternatives.size(); i++)
+          altmask[alternatives[i]] = 1;
+      }
+
       // set goal
       int k = goal[0] + goal[1]*nx;
       initCost(k,0);
@@ -473,6 +701,39 @@ namespace navfn {
 
 #define INVSQRT2 0.707106781
 
+  float
+    NavFn::calcPotential(int n, float l, float r, float u, float d)
+    {
+      // find lowest, and its lowest neighbor
+      float ta, tc;
+      if (l<r) tc=l; else tc=r;
+      if (u<d) ta=u; else ta=d;
+
+      float hf = (float)costarr[n]; // traversability factor
+      float dc = tc-ta;		// relative cost between ta,tc
+      if (dc < 0) 		// ta is lowest
+      {
+        dc = -dc;
+        ta = tc;
+      }
+
+      // calculate new potential
+      float pot;
+      if (dc >= hf)		// if too large, use ta-only update
+        pot = ta+hf;
+      else			// two-neighbor interpolation update
+      {
+        // use quadratic approximation
+        // might speed this up through table lookup, but still have to 
+        //   do the divide
+        float d = dc/hf;
+        float v = -0.2301*d*d + 0.5307*d + 0.7040;
+        pot = ta + hf*v;
+      }
+
+      return pot;
+    }
+
   inline void
     NavFn::updateCell(int n)
     {
@@ -486,35 +747,10 @@ namespace navfn {
       //	 potarr[n], l, r, u, d);
       //  ROS_INFO("[Update] cost: %d\n", costarr[n]);
 
-      // find lowest, and its lowest neighbor
-      float ta, tc;
-      if (l<r) tc=l; else tc=r;
-      if (u<d) ta=u; else ta=d;
-
       // do planar wave update
       if (costarr[n] < COST_OBS)	// don't propagate into obstacles
       {
-        float hf = (float)costarr[n]; // traversability factor
-        float dc = tc-ta;		// relative cost between ta,tc
-        if (dc < 0) 		// ta is lowest
-        {
-          dc = -dc;
-          ta = tc;
-        }
-
-        // calculate new potential
-        float pot;
-        if (dc >= hf)		// if too large, use ta-only update
-          pot = ta+hf;
-        else			// two-neighbor interpolation update
-        {
-          // use quadratic approximation
-          // might speed this up through table lookup, but still have to 
-          //   do the divide
-          float d = dc/hf;
-          float v = -0.2301*d*d + 0.5307*d + 0.7040;
-          pot = ta + hf*v;
-        }
+        float pot = calcPotential(n, l, r, u, d);
 
         //      ROS_INFO("[Update] new pot: %d\n", costarr[n]);
 
@@ -526,6 +762,8 @@ namespace navfn {
           float ue = INVSQRT2*(float)costarr[n-nx];
           float de = INVSQRT2*(float)costarr[n+nx];
           potarr[n] = pot;
+          if (!altmask.empty() && altmask[n] && pot < altpot)
+            altpot = pot;
           if (pot < curT)	// low-cost buffer block 
           {
             if (l > pot+le) push_next(n-1);
@@ -541,7 +779,6 @@ namespace navfn {
             if (d > pot+de) push_over(n+nx);
           }
         }
-
       }
 
     }
@@ -571,35 +808,10 @@ namespace navfn {
       //	 potarr[n], l, r, u, d);
       // ROS_INFO("[Update] cost of %d: %d\n", n, costarr[n]);
 
-      // find lowest, and its lowest neighbor
-      float ta, tc;
-      if (l<r) tc=l; else tc=r;
-      if (u<d) ta=u; else ta=d;
-
       // do planar wave update
       if (costarr[n] < COST_OBS)	// don't propagate into obstacles
       {
-        float hf = (float)costarr[n]; // traversability factor
-        float dc = tc-ta;		// relative cost between ta,tc
-        if (dc < 0) 		// ta is lowest
-        {
-          dc = -dc;
-          ta = tc;
-        }
-
-        // calculate new potential
-        float pot;
-        if (dc >= hf)		// if too large, use ta-only update
-          pot = ta+hf;
-        else			// two-neighbor interpolation update
-        {
-          // use quadratic approximation
-          // might speed this up through table lookup, but still have to 
-          //   do the divide
-          float d = dc/hf;
-          float v = -0.2301*d*d + 0.5307*d + 0.7040;
-          pot = ta + hf*v;
-        }
+        float pot = calcPotential(n, l, r, u, d);
 
         //ROS_INFO("[Update] new pot: %d\n", costarr[n]);
 
@@ -651,13 +863,13 @@ namespace navfn {
   bool
     NavFn::propNavFnDijkstra(int cycles, bool atStart)	
     {
+      if (workers)
+        return propNavFnDijkstraParallel(cycles, atStart);
+
       int nwv = 0;			// max priority block size
       int nc = 0;			// number of cells put into priority blocks
       int cycle = 0;		// which cycle we're on
 
-      // set up start cell
-      int startCell = start[1]*nx + start[0];
-
       for (; cycle < cycles; cycle++) // go for this many cycles, unless interrupted
       {
         // 
@@ -704,7 +916,7 @@ namespace navfn {
 
         // check if we've hit the Start cell
         if (atStart)
-          if (potarr[startCell] < POT_HIGH)
+          if (reachedStart())
             break;
       }
 
@@ -716,6 +928,378 @@ namespace navfn {
     }
 
 
+  //
+  // check the start cell and the other targets of the propagation
+  //
+
+  bool
+    NavFn::reachedStart()
+    {
+      return reachedStart(curT, altpot);
+    }
+
+  bool
+    NavFn::reachedStart(float thresh, float alt)
+    {
+      // cells below the priority threshold are settled, so the alternatives within the margin are reached too
+      bool reached = potarr[start[1]*nx + start[0]] < POT_HIGH || (alt < POT_HIGH && thresh > alt + altMargin);
+      if (!reached)
+        return false;
+      for (unsigned int i=0; i<targets.size(); i++)
+        if (potarr[targets[i]] >= POT_HIGH)
+          return false;
+      return true;
+    }
+
+
+  //
+  // set the number of propagation threads
+  //
+
+  void
+    NavFn::setNumThreads(int n)
+    {
+      if (n < 1)
+        n = 1;
+      if (n == nthreads)
+        return;
+      if (workers)
+        delete workers;
+      workers = NULL;
+      nthreads = n;
+      if (n > 1)
+        workers = new PropagationWorkers(this, n);
+    }
+
+
+  //
+  // fast sweeping propagation
+  // Gauss-Seidel sweeps with the planar-wave update of updateCell, in the
+  //   four diagonal directions, until a round of sweeps lowers no potential
+  // The map is swept in tiles, anti-diagonal by anti-diagonal in the sweep
+  //   direction, so every cell sees its two neighbors before it updated and
+  //   the two after it not, as in a sweep over the whole map
+  // A tile is skipped when neither it nor a tile next to it has changed
+  //   since it was last swept, since it would not change either
+  //
+
+  static const int sweep_dirs[4][2] = {{1, 1}, {-1, 1}, {-1, -1}, {1, -1}};
+
+  bool
+    NavFn::sweepCells(int x0, int x1, int y0, int y1, int dx, int dy)
+    {
+      bool changed = false;
+      for (int j=0; j<y1-y0; j++)
+      {
+        int y = dy > 0 ? y0+j : y1-1-j;
+        int n = y*nx + (dx > 0 ? x0 : x1-1);
+        for (int i=0; i<x1-x0; i++, n += dx)
+        {
+          if (costarr[n] >= COST_OBS)	// don't propagate into obstacles
+            continue;
+          float pot = calcPotential(n, potarr[n-1], potarr[n+1], potarr[n-nx], potarr[n+nx]);
+          if (pot < potarr[n])
+          {
+            potarr[n] = pot;
+            changed = true;
+          }
+        }
+      }
+      return changed;
+    }
+
+  bool
+    NavFn::sweepDiagonal(int step, int k, int t, int nt)
+    {
+      int dx = sweep_dirs[step%4][0], dy = sweep_dirs[step%4][1];
+      bool changed = false;
+
+      // the tiles of the anti-diagonal do not touch each other, and are dealt round robin to the threads
+      int first = std::max(0, k-ntiley+1), last = std::min(k, ntilex-1);
+      for (int i=first+t; i<=last; i += nt)
+      {
+        int tx = dx > 0 ? i : ntilex-1-i;
+        int ty = dy > 0 ? k-i : ntiley-1-(k-i);
+        int tile = ty*ntilex + tx;
+
+        int latest = tilechanged[tile];
+        if (tx > 0) latest = std::max(latest, tilechanged[tile-1]);
+        if (tx < ntilex-1) latest = std::max(latest, tilechanged[tile+1]);
+        if (ty > 0) latest = std::max(latest, tilechanged[tile-ntilex]);
+        if (ty < ntiley-1) latest = std::max(latest, tilechanged[tile+ntilex]);
+        if (latest < tileswept[tile])
+          continue;
+
+        // the border cells are obstacles, so the tiles start at 1
+        int x0 = 1 + tx*SWEEP_TILE, y0 = 1 + ty*SWEEP_TILE;
+        tileswept[tile] = step;
+        if (sweepCells(x0, std::min(x0+SWEEP_TILE, nx-1), y0, std::min(y0+SWEEP_TILE, ny-1), dx, dy))
+        {
+          tilechanged[tile] = step;
+          changed = true;
+        }
+      }
+      return changed;
+    }
+
+  bool
+    NavFn::propNavFnSweep(int sweeps)
+    {
+      ntilex = (nx-2 + SWEEP_TILE-1) / SWEEP_TILE;
+      ntiley = (ny-2 + SWEEP_TILE-1) / SWEEP_TILE;
+      tileswept.assign(ntilex*ntiley, -1);
+      tilechanged.assign(ntilex*ntiley, -1);
+
+      int round = 0;
+      if (workers)
+      {
+        workers->cycles = sweeps;
+        workers->run(&NavFn::propNavFnSweepThread);
+        round = workers->cycle;
+      }
+      else
+      {
+        for (; round < sweeps; round++)
+        {
+          bool changed = false;
+          for (int step=4*round; step<4*round+4; step++)
+            for (int k=0; k<ntilex+ntiley-1; k++)
+              changed |= sweepDiagonal(step, k, 0, 1);
+          if (!changed)
+            break;
+        }
+      }
+
+      ROS_DEBUG("[NavFn] Used %d rounds of sweeps on %d threads\n", round, nthreads);
+      return round < sweeps;
+    }
+
+
+  //
+  // parallel fast sweeping
+  // the threads sweep the tiles of an anti-diagonal at the same time,
+  //   and meet at a barrier before the next one
+  //
+
+  void
+    NavFn::propNavFnSweepThread(int t)
+    {
+      PropagationWorkers &w = *workers;
+
+      int round = 0;
+      for (; round < w.cycles; round++)
+      {
+        w.buf[t].changed = false;
+        for (int step=4*round; step<4*round+4; step++)
+          for (int k=0; k<ntilex+ntiley-1; k++)
+          {
+            if (sweepDiagonal(step, k, t, w.size))
+              w.buf[t].changed = true;
+            w.barrier(t);
+          }
+
+        // all threads read the flags before any of them clears its own
+        bool changed = false;
+        for (int i=0; i<w.size; i++)
+          changed |= w.buf[i].changed;
+        w.barrier(t);
+        if (!changed)
+          break;
+      }
+
+      if (t == 0)
+        w.cycle = round;
+    }
+
+
+  //
+  // parallel propagation function
+  // same priority blocks as propNavFnDijkstra, but every block
+  //   is processed in phases by all threads:
+  //   1. calculate the new potentials of the owned cells in the block,
+  //      reading only potentials from before the block
+  //   2. write the potentials that decreased
+  //   3. push the affected neighbors, to other threads if they own them,
+  //      including neighbors updated in the same block from the old potential
+  //   4. collect the neighbors pushed by other threads
+  // a cell is owned by thread (row/PROP_ROW_BLOCK) % nthreads, and only its
+  //   owner touches its pending flag and potential
+  //
+
+  bool
+    NavFn::propNavFnDijkstraParallel(int cycles, bool atStart)
+    {
+      PropagationWorkers &w = *workers;
+
+      // hand the cells of the priority blocks to their owners
+      int *blocks[3] = {curP, nextP, overP};
+      int ends[3] = {curPe, nextPe, overPe};
+      for (int k=0; k<3; k++)
+        for (int i=0; i<ends[k]; i++)
+        {
+          int n = blocks[k][i];
+          PropagationBuffers &b = w.buf[(n/nx/PROP_ROW_BLOCK) % w.size];
+          (k == 0 ? b.cur : k == 1 ? b.next : b.over).push_back(n);
+        }
+      w.cycles = cycles;
+      w.atStart = atStart;
+      w.total = curPe + nextPe;
+      if (w.stamp.size() != (unsigned int)ns || w.block > UINT_MAX - cycles)
+      {
+        w.stamp.assign(ns, 0);
+        w.block = 1;
+      }
+
+      w.run(&NavFn::propNavFnThread);
+      w.block += w.cycle + 1;
+
+      // leave the remaining cells in the priority blocks, as the sequential propagation does
+      curPe = nextPe = overPe = 0;
+      for (int t=0; t<w.size; t++)
+      {
+        PropagationBuffers &b = w.buf[t];
+        for (unsigned int i=0; i<b.cur.size() && curPe<PRIORITYBUFSIZE; i++)
+          curP[curPe++] = b.cur[i];
+        for (unsigned int i=0; i<b.over.size() && overPe<PRIORITYBUFSIZE; i++)
+          overP[overPe++] = b.over[i];
+        b.cur.clear();
+        b.over.clear();
+      }
+
+      ROS_DEBUG("[NavFn] Used %d cycles on %d threads\n", w.cycle, w.size);
+
+      if (w.cycle < cycles) return true; // finished up here
+      else return false;
+    }
+
+  void
+    NavFn::propNavFnThread(int t)
+    {
+      PropagationWorkers &w = *workers;
+      PropagationBuffers &b = w.buf[t];
+      float thresh = curT;
+      float alt = altpot;	// lowest potential of an alternative, over all threads
+      int total = w.total;	// number of cells in the current block, over all threads
+      b.alt = altpot;
+
+      // current block moves to the next block
+      b.cur.insert(b.cur.end(), b.next.begin(), b.next.end());
+      b.next.clear();
+
+      int cycle = 0;
+      for (; cycle < w.cycles; cycle++)
+      {
+        if (total == 0)		// priority blocks empty
+          break;
+
+        // calculate new potentials
+        b.upd.clear();
+        b.updpot.clear();
+        for (unsigned int i=0; i<b.cur.size(); i++)
+        {
+          int n = b.cur[i];
+          pending[n] = false;
+          if (costarr[n] >= COST_OBS)
+            continue;
+          float pot = calcPotential(n, potarr[n-1], potarr[n+1], potarr[n-nx], potarr[n+nx]);
+          if (pot < potarr[n])
+          {
+            b.upd.push_back(n);
+            b.updpot.push_back(pot);
+          }
+        }
+        w.barrier(t);
+
+        unsigned int block = w.block + cycle;
+        for (unsigned int i=0; i<b.upd.size(); i++)
+        {
+          potarr[b.upd[i]] = b.updpot[i];
+          w.stamp[b.upd[i]] = block;
+          if (!altmask.empty() && altmask[b.upd[i]] && b.updpot[i] < b.alt)
+            b.alt = b.updpot[i];
+        }
+        w.barrier(t);
+
+        // push affected neighbors
+        for (unsigned int i=0; i<b.upd.size(); i++)
+        {
+          int n = b.upd[i];
+          float pot = b.updpot[i];
+          int nbrs[4] = {n-1, n+1, n-nx, n+nx};
+          for (int k=0; k<4; k++)
+          {
+            int m = nbrs[k];
+            // a neighbor updated in the same block did not see this potential yet
+            if (!(potarr[m] > pot + INVSQRT2*(float)costarr[m] || (w.stamp[m] == block && potarr[m] > pot)))
+              continue;
+            int owner = (m/nx/PROP_ROW_BLOCK) % w.size;
+            if (owner != t)
+              (pot < thresh ? b.outnext : b.outover)[owner].push_back(m);
+            else if (!pending[m] && costarr[m]<COST_OBS)
+            {
+              (pot < thresh ? b.next : b.over).push_back(m);
+              pending[m] = true;
+            }
+          }
+        }
+        w.barrier(t);
+
+        // collect cells pushed by the other threads
+        for (int s=0; s<w.size; s++)
+        {
+          std::vector<int> *in[2] = {&w.buf[s].outnext[t], &w.buf[s].outover[t]};
+          for (int k=0; k<2; k++)
+          {
+            std::vector<int> &to = k == 0 ? b.next : b.over;
+            for (unsigned int i=0; i<in[k]->size(); i++)
+            {
+              int m = (*in[k])[i];
+              if (!pending[m] && costarr[m]<COST_OBS)
+              {
+                to.push_back(m);
+                pending[m] = true;
+              }
+            }
+            in[k]->clear();
+          }
+        }
+        w.nnext[t] = b.next.size();
+        w.nover[t] = b.over.size();
+        w.barrier(t);
+
+        // swap priority blocks, all threads take the same decisions
+        int nnext = 0, nover = 0;
+        for (int s=0; s<w.size; s++)
+        {
+          nnext += w.nnext[s];
+          nover += w.nover[s];
+          alt = std::min(alt, w.buf[s].alt);
+        }
+        b.cur.swap(b.next);
+        b.next.clear();
+        total = nnext;
+        if (nnext == 0)		// done with this priority level
+        {
+          thresh += priInc;
+          b.cur.swap(b.over);
+          total = nover;
+        }
+
+        // check if we've hit the Start cell
+        if (w.atStart && reachedStart(thresh, alt))
+          break;
+      }
+
+      if (t == 0)
+      {
+        curT = thresh;
+        altpot = alt;
+        w.cycle = cycle;
+      }
+      w.barrier(t);
+    }
+
+
   //
   // main propagation function
   // A* method, best-first
@@ -844,6 +1428,10 @@ namespace navfn {
       float dy=0;
       npath = 0;
 
+      // no gradients in the window yet
+      for (int i=0; i<GRADWINDOW*GRADWINDOW; i++)
+        gradcell[i] = -1;
+
       // go for <n> cycles at most
       for (int i=0; i<n; i++)
       {
@@ -935,20 +1523,22 @@ namespace navfn {
           gradCell(stc+1);
           gradCell(stcnx);
           gradCell(stcnx+1);
+          int g00 = gradSlot(stc), g01 = gradSlot(stc+1);
+          int g10 = gradSlot(stcnx), g11 = gradSlot(stcnx+1);
 
 
           // get interpolated gradient
-          float x1 = (1.0-dx)*gradx[stc] + dx*gradx[stc+1];
-          float x2 = (1.0-dx)*gradx[stcnx] + dx*gradx[stcnx+1];
+          float x1 = (1.0-dx)*gradx[g00] + dx*gradx[g01];
+          float x2 = (1.0-dx)*gradx[g10] + dx*gradx[g11];
           float x = (1.0-dy)*x1 + dy*x2; // interpolated x
-          float y1 = (1.0-dx)*grady[stc] + dx*grady[stc+1];
-          float y2 = (1.0-dx)*grady[stcnx] + dx*grady[stcnx+1];
+          float y1 = (1.0-dx)*grady[g00] + dx*grady[g01];
+          float y2 = (1.0-dx)*grady[g10] + dx*grady[g11];
           float y = (1.0-dy)*y1 + dy*y2; // interpolated y
 
           // show gradients
           ROS_DEBUG("[Path] %0.2f,%0.2f  %0.2f,%0.2f  %0.2f,%0.2f  %0.2f,%0.2f; final x=%.3f, y=%.3f\n",
-                    gradx[stc], grady[stc], gradx[stc+1], grady[stc+1], 
-                    gradx[stcnx], grady[stcnx], gradx[stcnx+1], grady[stcnx+1],
+                    gradx[g00], grady[g00], gradx[g01], grady[g01], 
+                    gradx[g10], grady[g10], gradx[g11], grady[g11],
                     x, y);
 
           // check for zero gradient, failed
@@ -991,9 +1581,12 @@ namespace navfn {
   float				
     NavFn::gradCell(int n)
     {
-      if (gradx[n]+grady[n] > 0.0)	// check this cell
+      int slot = gradSlot(n);
+      if (gradcell[slot] == n)	// check this cell
         return 1.0;			
 
+      gradcell[slot] = n;
+      gradx[slot] = grady[slot] = 0.0;
       if (n < nx || n > ns-nx)	// would be out of bounds
         return 0.0;
 
@@ -1035,8 +1628,8 @@ namespace navfn {
       if (norm > 0)
       {
         norm = 1.0/norm;
-        gradx[n] = norm*dx;
-        grady[n] = norm*dy;
+        gradx[slot] = norm*dx;
+        grady[slot] = norm*dy;
       }
       return norm;
     }
@@ -48,16 +48,16 @@ PLUGINLIB_DECLARE_CLASS(navfn, NavfnROS, navfn::NavfnROS, nav_core::BaseGlobalPl
 namespace navfn {
 
   NavfnROS::NavfnROS() 
-    : costmap_(NULL),  planner_(), initialized_(false), allow_unknown_(true) {}
+    : costmap_(NULL),  planner_(), initialized_(false), allow_unknown_(true), use_fast_sweeping_(false), potarr_thread_(NULL) {}
 
   NavfnROS::NavfnROS(std::string name, costmap_2d::Costmap2DROS* costmap_ros)
-    : costmap_(NULL),  planner_(), initialized_(false), allow_unknown_(true) {
+    : costmap_(NULL),  planner_(), initialized_(false), allow_unknown_(true), use_fast_sweeping_(false), potarr_thread_(NULL) {
       //initialize the planner
       initialize(name, costmap_ros);
   }
 
   NavfnROS::NavfnROS(std::string name, costmap_2d::Costmap2D* costmap, std::string global_frame)
-    : costmap_(NULL),  planner_(), initialized_(false), allow_unknown_(true) {
+    : costmap_(NULL),  planner_(), initialized_(false), allow_unknown_(true), use_fast_sweeping_(false), potarr_thread_(NULL) {
       //initialize the planner
       initialize(name, costmap, global_frame);
   }
@@ -75,19 +75,34 @@ namespace navfn {
       private_nh.param("visualize_potential", visualize_potential_, false);
 
       //if we're going to visualize the potential array we need to advertise
-      if(visualize_potential_)
+      if(visualize_potential_){
         potarr_pub_.advertise(private_nh, "potential", 1);
+        potarr_pending_ = potarr_stop_ = false;
+        potarr_thread_ = new boost::thread(boost::bind(&NavfnROS::publishPotentialThread, this));
+      }
+      private_nh.param("potential_downsample", potential_downsample_, 1);
+      private_nh.param("potential_crop_margin", potential_crop_margin_, 0.0);
+      private_nh.param("corridor_width", corridor_width_, 0.0);
+      private_nh.param("nearest_reachable_goal", nearest_reachable_goal_, false);
 
       private_nh.param("allow_unknown", allow_unknown_, true);
       private_nh.param("planner_window_x", planner_window_x_, 0.0);
       private_nh.param("planner_window_y", planner_window_y_, 0.0);
       private_nh.param("default_tolerance", default_tolerance_, 0.0);
 
+      int num_threads;
+      private_nh.param("num_threads", num_threads, 1);
+      planner_->setNumThreads(num_threads);
+
+      //computePotential fills in the whole map, which fast sweeping can split between the threads
+      private_nh.param("use_fast_sweeping", use_fast_sweeping_, false);
+
       //get the tf prefix
       ros::NodeHandle prefix_nh;
       tf_prefix_ = tf::getPrefixParam(prefix_nh);
 
       make_plan_srv_ =  private_nh.advertiseService("make_plan", &NavfnROS::makePlanService, this);
+      make_plans_srv_ =  private_nh.advertiseService("make_plans", &NavfnROS::makePlansService, this);
 
       initialized_ = true;
     }
@@ -95,6 +110,18 @@ namespace navfn {
       ROS_WARN("This planner has already been initialized, you can't call it twice, doing nothing");
   }
 
+  NavfnROS::~NavfnROS(){
+    if(potarr_thread_){
+      {
+        boost::mutex::scoped_lock lock(potarr_mutex_);
+        potarr_stop_ = true;
+        potarr_cond_.notify_one();
+      }
+      potarr_thread_->join();
+      delete potarr_thread_;
+    }
+  }
+
   void NavfnROS::initialize(std::string name, costmap_2d::Costmap2DROS* costmap_ros){
     initialize(name, costmap_ros->getCostmap(), costmap_ros->getGlobalFrameID());
   }
@@ -169,6 +196,8 @@ namespace navfn {
     planner_->setStart(map_start);
     planner_->setGoal(map_goal);
 
+    if(use_fast_sweeping_)
+      return planner_->calcNavFnSweep();
     return planner_->calcNavFnDijkstra();
   }
 
@@ -191,11 +220,112 @@ namespace navfn {
     return true;
   } 
 
+  bool NavfnROS::makePlansService(MakeNavPlans::Request& req, MakeNavPlans::Response& resp){
+    std::vector<std::vector<geometry_msgs::PoseStamped> > plans;
+    makePlans(req.start, req.goals, resp.costs, req.return_paths ? &plans : NULL);
+
+    resp.plan_found.resize(resp.costs.size());
+    for(unsigned int i = 0; i < resp.costs.size(); ++i)
+      resp.plan_found[i] = resp.costs[i] < POT_HIGH;
+
+    resp.paths.resize(plans.size());
+    for(unsigned int i = 0; i < plans.size(); ++i){
+      resp.paths[i].header.stamp = ros::Time::now();
+      resp.paths[i].header.frame_id = global_frame_;
+      resp.paths[i].poses = plans[i];
+    }
+
+    return true;
+  }
+
   void NavfnROS::mapToWorld(double mx, double my, double& wx, double& wy) {
     wx = costmap_->getOriginX() + mx * costmap_->getResolution();
     wy = costmap_->getOriginY() + my * costmap_->getResolution();
   }
 
+  void NavfnROS::publishPotential(const std::vector<geometry_msgs::PoseStamped>& plan){
+    //building the cloud for nobody would take longer than planning on large maps
+    if(potarr_pub_.getNumSubscribers() == 0)
+      return;
+
+    int nx = planner_->nx, ny = planner_->ny;
+
+    //the whole map, or the box around the plan grown by the margin
+    int x0 = 0, y0 = 0, x1 = nx, y1 = ny;
+    if(potential_crop_margin_ > 0 && !plan.empty()){
+      x0 = nx;
+      y0 = ny;
+      x1 = y1 = 0;
+      int margin = potential_crop_margin_ / costmap_->getResolution();
+      for(unsigned int i = 0; i < plan.size(); ++i){
+        int mx, my;
+        costmap_->worldToMapEnforceBounds(plan[i].pose.position.x, plan[i].pose.position.y, mx, my);
+        x0 = std::min(x0, mx - margin);
+        y0 = std::min(y0, my - margin);
+        x1 = std::max(x1, mx + margin + 1);
+        y1 = std::max(y1, my + margin + 1);
+      }
+      x0 = std::max(0, x0);
+      y0 = std::max(0, y0);
+      x1 = std::min(nx, x1);
+      y1 = std::min(ny, y1);
+    }
+
+    pcl::PointCloud<PotarrPoint> pot_area;
+    pot_area.header.frame_id = global_frame_;
+    std_msgs::Header header;
+    pcl_conversions::fromPCL(pot_area.header, header);
+    header.stamp = ros::Time::now();
+    pot_area.header = pcl_conversions::toPCL(header);
+
+    //the height is relative to the potential where the propagation started
+    PotarrPoint pt;
+    float *pp = planner_->potarr;
+    float start_pot = pp[planner_->start[1]*nx + planner_->start[0]];
+    int step = std::max(1, potential_downsample_);
+    double pot_x, pot_y;
+    for (int y = y0; y < y1; y += step)
+    {
+      for (int x = x0; x < x1; x += step)
+      {
+        float pot = pp[y*nx + x];
+        if (pot < 10e7)
+        {
+          mapToWorld(x, y, pot_x, pot_y);
+          pt.x = pot_x;
+          pt.y = pot_y;
+          pt.z = pot/start_pot*20;
+          pt.pot_value = pot;
+          pot_area.push_back(pt);
+        }
+      }
+    }
+
+    boost::mutex::scoped_lock lock(potarr_mutex_);
+    potarr_cloud_.swap(pot_area);
+    potarr_pending_ = true;
+    potarr_cond_.notify_one();
+  }
+
+  void NavfnROS::publishPotentialThread(){
+    boost::unique_lock<boost::mutex> lock(potarr_mutex_);
+    while(true){
+      while(!potarr_pending_ && !potarr_stop_)
+        potarr_cond_.wait(lock);
+      if(potarr_stop_)
+        return;
+
+      pcl::PointCloud<PotarrPoint> pot_area;
+      pot_area.swap(potarr_cloud_);
+      potarr_pending_ = false;
+      lock.unlock();
+
+      potarr_pub_.publish(pot_area);
+
+      lock.lock();
+    }
+  }
+
   bool NavfnROS::makePlan(const geometry_msgs::PoseStamped& start, 
       const geometry_msgs::PoseStamped& goal, std::vector<geometry_msgs::PoseStamped>& plan){
     return makePlan(start, goal, default_tolerance_, plan);
@@ -286,9 +416,41 @@ namespace navfn {
     planner_->setStart(map_goal);
     planner_->setGoal(map_start);
 
+    //a refresh of the last plan only propagates through the corridor around it, and the whole map only if that fails
+    bool in_corridor = restrictToCorridor(map_start, map_goal);
+
+    //if the goal cell itself is blocked, or outside of the corridor, every cell within the tolerance is as good a place to stop the
+    //propagation as the goal. It goes on for twice the tolerance past the first one reached, so that the
+    //search below finds the ones closer to the goal as well
+    planner_->alternatives.clear();
+    int goal_i = map_goal[1] * planner_->nx + map_goal[0];
+    bool goal_blocked = planner_->costarr[goal_i] >= COST_OBS || (in_corridor && !corridor_mask_[goal_i]);
+    if(nearest_reachable_goal_ && tolerance > 0.0 && goal_blocked){
+      planner_->altMargin = 2 * tolerance / costmap_->getResolution() * COST_NEUTRAL;
+      int x0, y0, x1, y1;
+      costmap_->worldToMapNoBounds(wx - tolerance, wy - tolerance, x0, y0);
+      costmap_->worldToMapNoBounds(wx + tolerance, wy + tolerance, x1, y1);
+      for(int y = std::max(0, y0); y <= std::min(planner_->ny - 1, y1); ++y){
+        for(int x = std::max(0, x0); x <= std::min(planner_->nx - 1, x1); ++x){
+          double cx, cy;
+          mapToWorld(x + 0.5, y + 0.5, cx, cy);
+          if((cx - wx) * (cx - wx) + (cy - wy) * (cy - wy) <= tolerance * tolerance)
+            planner_->alternatives.push_back(y * planner_->nx + x);
+        }
+      }
+    }
+
     //bool success = planner_->calcNavFnAstar();
     planner_->calcNavFnDijkstra(true);
 
+    if(in_corridor && planner_->potarr[goal_i] >= POT_HIGH
+       && planner_->altpot >= POT_HIGH){
+      ROS_DEBUG("No path inside the corridor around the last plan, planning on the whole map");
+      planner_->setCostmap(costmap_->getCharMap(), true, allow_unknown_);
+      planner_->calcNavFnDijkstra(true);
+    }
+    planner_->alternatives.clear();
+
     double resolution = costmap_->getResolution();
     geometry_msgs::PoseStamped p, best_pose;
     p = goal;
@@ -326,40 +488,141 @@ namespace navfn {
       }
     }
 
-    if (visualize_potential_){
-      //publish potential array
-      pcl::PointCloud<PotarrPoint> pot_area;
-      pot_area.header.frame_id = global_frame_;
-      pot_area.points.clear();
-      std_msgs::Header header;
-      pcl_conversions::fromPCL(pot_area.header, header);
-      header.stamp = ros::Time::now();
-      pot_area.header = pcl_conversions::toPCL(header);
-
-      PotarrPoint pt;
-      float *pp = planner_->potarr;
-      double pot_x, pot_y;
-      for (unsigned int i = 0; i < (unsigned int)planner_->ny*planner_->nx ; i++)
-      {
-        if (pp[i] < 10e7)
-        {
-          mapToWorld(i%planner_->nx, i/planner_->nx, pot_x, pot_y);
-          pt.x = pot_x;
-          pt.y = pot_y;
-          pt.z = pp[i]/pp[planner_->start[1]*planner_->nx + planner_->start[0]]*20;
-          pt.pot_value = pp[i];
-          pot_area.push_back(pt);
-        }
-      }
-      potarr_pub_.publish(pot_area);
+    if(corridor_width_ > 0){
+      last_plan_ = plan;
+      last_goal_ = goal.pose.position;
     }
 
+    if (visualize_potential_)
+      publishPotential(plan);
+
     //publish the plan for visualization purposes
     publishPlan(plan, 0.0, 1.0, 0.0, 0.0);
 
     return !plan.empty();
   }
 
+  bool NavfnROS::restrictToCorridor(int* map_start, int* map_goal){
+    if(corridor_width_ <= 0 || last_plan_.empty())
+      return false;
+
+    //only a refresh of the last plan can reuse its corridor. The plan may end anywhere within the tolerance,
+    //so it is the goal it was made for that has to match
+    unsigned int last_x, last_y;
+    if(!costmap_->worldToMap(last_goal_.x, last_goal_.y, last_x, last_y)
+       || (int)last_x != map_goal[0] || (int)last_y != map_goal[1])
+      return false;
+
+    int nx = planner_->nx, ny = planner_->ny;
+    if(corridor_mask_.size() != (unsigned int)(nx * ny))
+      corridor_mask_.assign(nx * ny, 0);
+    else{
+      for(unsigned int i = 0; i < corridor_cells_.size(); ++i)
+        corridor_mask_[corridor_cells_[i]] = 0;
+    }
+    corridor_cells_.clear();
+
+    std::vector<int> path_x(last_plan_.size()), path_y(last_plan_.size());
+    for(unsigned int i = 0; i < last_plan_.size(); ++i)
+      costmap_->worldToMapEnforceBounds(last_plan_[i].pose.position.x, last_plan_[i].pose.position.y, path_x[i], path_y[i]);
+    int radius = std::max(1, (int)(corridor_width_ / 2 / costmap_->getResolution()));
+    markCorridor(path_x, path_y, radius, nx, ny, corridor_mask_, corridor_cells_);
+
+    if(!corridor_mask_[map_start[1] * nx + map_start[0]]){
+      ROS_DEBUG("The robot left the corridor around the last plan");
+      return false;
+    }
+
+    closeCorridor(corridor_mask_, corridor_cells_, nx, ny, planner_->costarr);
+    return true;
+  }
+
+  bool NavfnROS::makePlans(const geometry_msgs::PoseStamped& start, const std::vector<geometry_msgs::PoseStamped>& goals,
+      std::vector<double>& costs, std::vector<std::vector<geometry_msgs::PoseStamped> >* plans){
+    boost::mutex::scoped_lock lock(mutex_);
+    costs.assign(goals.size(), POT_HIGH);
+    if(plans)
+      plans->assign(goals.size(), std::vector<geometry_msgs::PoseStamped>());
+
+    if(!initialized_){
+      ROS_ERROR("This planner has not been initialized yet, but it is being used, please call initialize() before use");
+      return false;
+    }
+
+    if(tf::resolve(tf_prefix_, start.header.frame_id) != tf::resolve(tf_prefix_, global_frame_)){
+      ROS_ERROR("The start pose passed to this planner must be in the %s frame.  It is instead in the %s frame.", 
+                tf::resolve(tf_prefix_, global_frame_).c_str(), tf::resolve(tf_prefix_, start.header.frame_id).c_str());
+      return false;
+    }
+
+    unsigned int mx, my;
+    if(!costmap_->worldToMap(start.pose.position.x, start.pose.position.y, mx, my)){
+      ROS_WARN("The robot's start position is off the global costmap. Planning will always fail, are you sure the robot has been properly localized?");
+      return false;
+    }
+
+    //clear the starting cell within the costmap because we know it can't be an obstacle
+    tf::Stamped<tf::Pose> start_pose;
+    tf::poseStampedMsgToTF(start, start_pose);
+    clearRobotCell(start_pose, mx, my);
+
+    //make sure to resize the underlying array that Navfn uses
+    planner_->setNavArr(costmap_->getSizeInCellsX(), costmap_->getSizeInCellsY());
+    planner_->setCostmap(costmap_->getCharMap(), true, allow_unknown_);
+
+    int map_start[2];
+    map_start[0] = mx;
+    map_start[1] = my;
+
+    //the goals that are in another frame or off the map are left unreachable
+    std::vector<int> goal_cells(goals.size(), -1);
+    std::vector<int> targets;
+    for(unsigned int i = 0; i < goals.size(); ++i){
+      if(tf::resolve(tf_prefix_, goals[i].header.frame_id) != tf::resolve(tf_prefix_, global_frame_)){
+        ROS_ERROR("The goal poses passed to this planner must be in the %s frame.  Goal %u is in the %s frame.", 
+                  tf::resolve(tf_prefix_, global_frame_).c_str(), i, tf::resolve(tf_prefix_, goals[i].header.frame_id).c_str());
+        continue;
+      }
+      if(!costmap_->worldToMap(goals[i].pose.position.x, goals[i].pose.position.y, mx, my)){
+        ROS_WARN_THROTTLE(1.0, "Goal %u sent to the navfn planner is off the global costmap. Planning will always fail to this goal.", i);
+        continue;
+      }
+      goal_cells[i] = my * planner_->nx + mx;
+      targets.push_back(goal_cells[i]);
+    }
+
+    if(targets.empty())
+      return false;
+
+    //propagate from the robot until every goal has a potential, like makePlan does for one goal
+    int map_goal[2];
+    map_goal[0] = targets[0] % planner_->nx;
+    map_goal[1] = targets[0] / planner_->nx;
+    planner_->setStart(map_goal);
+    planner_->setGoal(map_start);
+    planner_->targets = targets;
+    planner_->setupNavFn(true);
+    planner_->propNavFnDijkstra(std::max(planner_->nx * planner_->ny / 20, planner_->nx + planner_->ny), true);
+    planner_->targets.clear();
+
+    bool found_legal = false;
+    for(unsigned int i = 0; i < goals.size(); ++i){
+      if(goal_cells[i] < 0 || planner_->potarr[goal_cells[i]] >= POT_HIGH)
+        continue;
+      costs[i] = planner_->potarr[goal_cells[i]];
+      found_legal = true;
+
+      if(plans && extractPlan(goal_cells[i] % planner_->nx, goal_cells[i] / planner_->nx, (*plans)[i])){
+        //make sure the goal we push on has the same timestamp as the rest of the plan
+        geometry_msgs::PoseStamped goal_copy = goals[i];
+        goal_copy.header.stamp = ros::Time::now();
+        (*plans)[i].push_back(goal_copy);
+      }
+    }
+
+    return found_legal;
+  }
+
   void NavfnROS::publishPlan(const std::vector<geometry_msgs::PoseStamped>& path, double r, double g, double b, double a){
     if(!initialized_){
       ROS_ERROR("This planner has not been initialized yet, but it is being used, please call initialize() before use");
@@ -410,6 +673,16 @@ namespace navfn {
       return false;
     }
 
+    extractPlan(mx, my, plan);
+
+    //publish the plan for visualization purposes
+    publishPlan(plan, 0.0, 1.0, 0.0, 0.0);
+    return !plan.empty();
+  }
+
+  bool NavfnROS::extractPlan(unsigned int mx, unsigned int my, std::vector<geometry_msgs::PoseStamped>& plan){
+    plan.clear();
+
     int map_goal[2];
     map_goal[0] = mx;
     map_goal[1] = my;
@@ -442,8 +715,6 @@ namespace navfn {
       plan.push_back(pose);
     }
 
-    //publish the plan for visualization purposes
-    publishPlan(plan, 0.0, 1.0, 0.0, 0.0);
     return !plan.empty();
   }
 };
@@ -27,7 +27,9 @@
  * POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <string>
+#include <vector>
 #include <ros/package.h>
 #include <gtest/gtest.h>
 #include <navfn/navfn.h>
@@ -95,14 +97,16 @@ void print_neighborhood_of_last_path_entry( navfn::NavFn* nav )
     printf( "%5d x:", y );
     for( int x = xf - 2; x <= xf + 2; x++ )
     {
-      printf( " %5.1f", nav->gradx[ y * nav->nx + x ] );
+      nav->gradCell( y * nav->nx + x );
+      printf( " %5.1f", nav->gradx[ nav->gradSlot( y * nav->nx + x ) ] );
     }
     printf( "\n" );
 
     printf( "      y:" );
     for( int x = xf - 2; x <= xf + 2; x++ )
     {
-      printf( " %5.1f", nav->grady[ y * nav->nx + x ] );
+      nav->gradCell( y * nav->nx + x );
+      printf( " %5.1f", nav->grady[ nav->gradSlot( y * nav->nx + x ) ] );
     }
     printf( "\n" );
   }
@@ -153,6 +157,340 @@ TEST(PathCalc, easy_nav_should_always_work)
   EXPECT_TRUE( nav->calcNavFnDijkstra( true ));
 }
 
+TEST(PathCalc, parallel_propagation_matches_sequential)
+{
+  int goal[2];
+  int start[2];
+
+  start[0] = 428;
+  start[1] = 746;
+
+  goal[0] = 350;
+  goal[1] = 450;
+
+  navfn::NavFn* navs[3];
+  int threads[3] = {1, 2, 4};
+  for( int i = 0; i < 3; i++ )
+  {
+    navs[i] = make_willow_nav();
+    ASSERT_TRUE( navs[i] != NULL );
+    navs[i]->setNumThreads( threads[i] );
+    navs[i]->setGoal( goal );
+    navs[i]->setStart( start );
+    EXPECT_TRUE( navs[i]->calcNavFnDijkstra( false ));
+  }
+
+  // the parallel propagation does not depend on the number of threads
+  int ns = navs[0]->ns;
+  EXPECT_EQ( 0, memcmp( navs[1]->potarr, navs[2]->potarr, ns * sizeof(float) ));
+
+  // and differs from the sequential one by the order of the updates only, which reaches the
+  // same cells and leaves every potential within a few percent
+  int nx = navs[0]->nx;
+  for( int n = 0; n < ns; n++ )
+  {
+    float p0 = navs[0]->potarr[n], p2 = navs[2]->potarr[n];
+    ASSERT_EQ( p0 < POT_HIGH, p2 < POT_HIGH ) << "cell " << n % nx << ", " << n / nx;
+    if( p0 < POT_HIGH )
+      ASSERT_NEAR( p0, p2, 0.05 * std::max( p0, (float) COST_NEUTRAL )) << "cell " << n % nx << ", " << n / nx;
+  }
+
+  // the paths down both potentials stay within a cell of each other
+  ASSERT_GT( navs[0]->calcPath( ns / 2 ), 0 );
+  ASSERT_GT( navs[2]->calcPath( ns / 2 ), 0 );
+  for( int i = 0; i < navs[2]->npath; i++ )
+  {
+    float closest = POT_HIGH;
+    for( int j = 0; j < navs[0]->npath; j++ )
+      closest = std::min( closest, hypotf( navs[2]->pathx[i] - navs[0]->pathx[j], navs[2]->pathy[i] - navs[0]->pathy[j] ));
+    EXPECT_LT( closest, 1.0 ) << "path point " << i;
+  }
+  EXPECT_NEAR( navs[0]->npath, navs[2]->npath, 0.01 * navs[0]->npath );
+
+  for( int i = 0; i < 3; i++ )
+    delete navs[i];
+}
+
+TEST(PathCalc, fast_sweeping_matches_dijkstra)
+{
+  int goal[2];
+  int start[2];
+
+  start[0] = 428;
+  start[1] = 746;
+
+  goal[0] = 350;
+  goal[1] = 450;
+
+  navfn::NavFn* navs[3];
+  for( int i = 0; i < 3; i++ )
+  {
+    navs[i] = make_willow_nav();
+    ASSERT_TRUE( navs[i] != NULL );
+    navs[i]->setGoal( goal );
+    navs[i]->setStart( start );
+  }
+  navs[2]->setNumThreads( 3 );
+
+  EXPECT_TRUE( navs[0]->calcNavFnDijkstra( false ));
+  EXPECT_TRUE( navs[1]->calcNavFnSweep() );
+  EXPECT_TRUE( navs[2]->calcNavFnSweep() );
+
+  // the tiles swept in parallel see the same potentials as the sequential sweeps
+  int ns = navs[0]->ns;
+  EXPECT_EQ( 0, memcmp( navs[1]->potarr, navs[2]->potarr, ns * sizeof(float) ));
+
+  // sweeping reaches the same cells as Dijkstra, with the same update
+  for( int n = 0; n < ns; n++ )
+    EXPECT_EQ( navs[0]->potarr[n] < POT_HIGH, navs[1]->potarr[n] < POT_HIGH ) << "cell " << n;
+  int k = start[1] * navs[0]->nx + start[0];
+  EXPECT_NEAR( navs[0]->potarr[k], navs[1]->potarr[k], 0.01 * navs[0]->potarr[k] );
+
+  for( int i = 0; i < 3; i++ )
+    delete navs[i];
+}
+
+TEST(PathCalc, propagation_stops_at_all_targets)
+{
+  int goal[2];
+  int start[2];
+
+  start[0] = 428;
+  start[1] = 746;
+
+  goal[0] = 350;
+  goal[1] = 450;
+
+  navfn::NavFn* nav = make_willow_nav();
+  ASSERT_TRUE( nav != NULL );
+  nav->setGoal( goal );
+  nav->setStart( start );
+
+  // pick reachable targets from a full propagation
+  navfn::NavFn* full = make_willow_nav();
+  ASSERT_TRUE( full != NULL );
+  full->setGoal( goal );
+  full->setStart( start );
+  full->calcNavFnDijkstra( false );
+  int nx = nav->nx;
+  int targets[3];
+  int found = 0;
+  for( int n = 0; n < full->ns && found < 3; n += full->ns / 7 + 1 )
+    for( int m = n; m < full->ns; m++ )
+      if( full->potarr[m] < POT_HIGH )
+      {
+        targets[found++] = m;
+        break;
+      }
+  ASSERT_EQ( 3, found );
+  delete full;
+
+  // one propagation from the goal gives the potential of every target
+  nav->targets.assign( targets, targets + 3 );
+  nav->setupNavFn( true );
+  EXPECT_TRUE( nav->propNavFnDijkstra( std::max( nav->ns / 20, nx + nav->ny ), true ));
+  for( int i = 0; i < 3; i++ )
+    EXPECT_LT( nav->potarr[targets[i]], POT_HIGH ) << "target " << i;
+
+  // the potential at each target does not depend on the other targets
+  navfn::NavFn* single = make_willow_nav();
+  ASSERT_TRUE( single != NULL );
+  single->setGoal( goal );
+  single->setStart( start );
+  EXPECT_TRUE( single->calcNavFnDijkstra( true ));
+  int k = start[1] * nx + start[0];
+  EXPECT_FLOAT_EQ( single->potarr[k], nav->potarr[k] );
+
+  delete single;
+  delete nav;
+}
+
+TEST(PathCalc, propagation_stops_at_first_alternative)
+{
+  int goal[2];
+  int start[2];
+
+  start[0] = 428;
+  start[1] = 746;
+
+  goal[0] = 350;
+  goal[1] = 450;
+
+  navfn::NavFn* nav = make_willow_nav();
+  ASSERT_TRUE( nav != NULL );
+  nav->setGoal( goal );
+  nav->setStart( start );
+  int nx = nav->nx;
+
+  // the cells within 20 cells of the start
+  for( int y = start[1] - 20; y <= start[1] + 20; y++ )
+    for( int x = start[0] - 20; x <= start[0] + 20; x++ )
+      if( (x - start[0]) * (x - start[0]) + (y - start[1]) * (y - start[1]) <= 400 )
+        nav->alternatives.push_back( y * nx + x );
+
+  nav->setupNavFn( true );
+  EXPECT_TRUE( nav->propNavFnDijkstra( std::max( nav->ns / 20, nx + nav->ny ), true ));
+  int reached_alternatives = 0;
+  for( unsigned int i = 0; i < nav->alternatives.size(); i++ )
+    if( nav->potarr[nav->alternatives[i]] < POT_HIGH )
+      reached_alternatives++;
+  EXPECT_GT( reached_alternatives, 0 );
+
+  // stopping at the edge of the disc leaves less of the map to propagate through
+  navfn::NavFn* single = make_willow_nav();
+  ASSERT_TRUE( single != NULL );
+  single->setGoal( goal );
+  single->setStart( start );
+  EXPECT_TRUE( single->calcNavFnDijkstra( true ));
+  int nav_reached = 0, single_reached = 0;
+  for( int n = 0; n < nav->ns; n++ )
+  {
+    nav_reached += nav->potarr[n] < POT_HIGH;
+    single_reached += single->potarr[n] < POT_HIGH;
+  }
+  EXPECT_LT( nav_reached, single_reached );
+  EXPECT_GE( nav->potarr[start[1] * nx + start[0]], POT_HIGH );
+
+  delete single;
+  delete nav;
+}
+
+TEST(PathCalc, propagation_reaches_free_start_within_margin)
+{
+  int goal[2];
+  int start[2];
+
+  start[0] = 428;
+  start[1] = 746;
+
+  goal[0] = 350;
+  goal[1] = 450;
+
+  navfn::NavFn* nav = make_willow_nav();
+  ASSERT_TRUE( nav != NULL );
+  nav->setGoal( goal );
+  nav->setStart( start );
+  int nx = nav->nx;
+
+  // going on for twice the radius of the disc past its edge reaches its center
+  for( int y = start[1] - 20; y <= start[1] + 20; y++ )
+    for( int x = start[0] - 20; x <= start[0] + 20; x++ )
+      if( (x - start[0]) * (x - start[0]) + (y - start[1]) * (y - start[1]) <= 400 )
+        nav->alternatives.push_back( y * nx + x );
+  nav->altMargin = 2 * 20 * COST_NEUTRAL;
+
+  for( int threads = 1; threads <= 2; threads++ )
+  {
+    nav->setNumThreads( threads );
+    nav->setupNavFn( true );
+    EXPECT_TRUE( nav->propNavFnDijkstra( std::max( nav->ns / 20, nx + nav->ny ), true ));
+    EXPECT_LT( nav->altpot, POT_HIGH );
+    EXPECT_LT( nav->potarr[start[1] * nx + start[0]], POT_HIGH ) << threads << " threads";
+    EXPECT_GT( nav->calcPath( nx * nav->ny / 2 ), 0 );
+  }
+
+  delete nav;
+}
+
+// A wall across the middle of an open map, with a gap of 10 cells at y = 20 and y = 70.
+navfn::NavFn* make_wall_nav()
+{
+  int nx = 100, ny = 100;
+  navfn::NavFn* nav = new navfn::NavFn(nx, ny);
+  nav->priInc = 2*COST_NEUTRAL;
+  for( int i = 0; i < nx * ny; i++ )
+    nav->costarr[i] = COST_NEUTRAL;
+  for( int y = 0; y < ny; y++ )
+    if( (y < 20 || y >= 30) && (y < 70 || y >= 80) )
+      nav->costarr[y * nx + 50] = COST_OBS;
+  return nav;
+}
+
+TEST(PathCalc, replan_stays_inside_corridor)
+{
+  int goal[2] = { 90, 25 };
+  int start[2] = { 10, 25 };
+  navfn::NavFn* nav = make_wall_nav();
+  int nx = nav->nx, ny = nav->ny;
+  nav->setGoal( goal );
+  nav->setStart( start );
+  ASSERT_TRUE( nav->calcNavFnDijkstra( true ));
+
+  std::vector<int> path_x, path_y;
+  for( int i = 0; i < nav->npath; i++ )
+  {
+    path_x.push_back( nav->pathx[i] );
+    path_y.push_back( nav->pathy[i] );
+  }
+  std::vector<unsigned char> mask( nx * ny, 0 );
+  std::vector<int> cells;
+  navfn::markCorridor( path_x, path_y, 5, nx, ny, mask, cells );
+  EXPECT_EQ( (int) cells.size(), std::count( mask.begin(), mask.end(), 1 ));
+  for( unsigned int i = 0; i < path_x.size(); i++ )
+    EXPECT_TRUE( mask[path_y[i] * nx + path_x[i]] );
+  // the corridor only goes through the upper gap
+  for( int y = 70; y < 80; y++ )
+    EXPECT_FALSE( mask[y * nx + 50] );
+
+  // a refresh of the plan inside the corridor
+  std::vector<COSTTYPE> full( nav->costarr, nav->costarr + nx * ny );
+  navfn::closeCorridor( mask, cells, nx, ny, nav->costarr );
+  ASSERT_TRUE( nav->calcNavFnDijkstra( true ));
+  for( int i = 0; i < nav->npath; i++ )
+    EXPECT_TRUE( mask[(int) nav->pathy[i] * nx + (int) nav->pathx[i]] ) << nav->pathx[i] << ", " << nav->pathy[i];
+
+  // closing the border of the corridor propagates like closing the whole map around it
+  std::vector<float> border( nav->potarr, nav->potarr + nx * ny );
+  memcpy( nav->costarr, &full[0], nx * ny );
+  for( int i = 0; i < nx * ny; i++ )
+    if( !mask[i] )
+      nav->costarr[i] = COST_OBS;
+  ASSERT_TRUE( nav->calcNavFnDijkstra( true ));
+  for( int i = 0; i < nx * ny; i++ )
+    ASSERT_EQ( nav->potarr[i], border[i] ) << "cell " << i % nx << ", " << i / nx;
+
+  delete nav;
+}
+
+TEST(PathCalc, blocked_corridor_falls_back_to_map)
+{
+  int goal[2] = { 90, 25 };
+  int start[2] = { 10, 25 };
+  navfn::NavFn* nav = make_wall_nav();
+  int nx = nav->nx, ny = nav->ny;
+  nav->setGoal( goal );
+  nav->setStart( start );
+  ASSERT_TRUE( nav->calcNavFnDijkstra( true ));
+  std::vector<int> path_x, path_y;
+  for( int i = 0; i < nav->npath; i++ )
+  {
+    path_x.push_back( nav->pathx[i] );
+    path_y.push_back( nav->pathy[i] );
+  }
+  std::vector<unsigned char> mask( nx * ny, 0 );
+  std::vector<int> cells;
+  navfn::markCorridor( path_x, path_y, 5, nx, ny, mask, cells );
+
+  // the upper gap closes, the corridor around the last plan has no way through anymore
+  for( int y = 20; y < 30; y++ )
+    nav->costarr[y * nx + 50] = COST_OBS;
+  std::vector<COSTTYPE> full( nav->costarr, nav->costarr + nx * ny );
+  navfn::closeCorridor( mask, cells, nx, ny, nav->costarr );
+  nav->calcNavFnDijkstra( true );
+  EXPECT_GE( nav->potarr[start[1] * nx + start[0]], POT_HIGH );
+
+  // which is when the whole map is searched again
+  memcpy( nav->costarr, &full[0], nx * ny );
+  ASSERT_TRUE( nav->calcNavFnDijkstra( true ));
+  bool lower_gap = false;
+  for( int i = 0; i < nav->npath; i++ )
+    if( (int) nav->pathx[i] == 50 )
+      lower_gap = lower_gap || (nav->pathy[i] >= 70 && nav->pathy[i] < 80);
+  EXPECT_TRUE( lower_gap );
+
+  delete nav;
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
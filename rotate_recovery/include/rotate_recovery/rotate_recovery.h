@@ -41,6 +41,7 @@
 #include <tf/transform_listener.h>
 #include <ros/ros.h>
 #include <base_local_planner/costmap_model.h>
+#include <base_local_planner/footprint_mask.h>
 #include <geometry_msgs/Twist.h>
 #include <geometry_msgs/Point.h>
 #include <angles/angles.h>
@@ -86,6 +87,8 @@ namespace rotate_recovery{
       bool initialized_;
       double sim_granularity_, min_rotational_vel_, max_rotational_vel_, acc_lim_th_, tolerance_, frequency_;
       base_local_planner::CostmapModel* world_model_;
+      base_local_planner::FootprintMask footprint_mask_;
+      int footprint_mask_headings_;
   };
 };
 #endif  
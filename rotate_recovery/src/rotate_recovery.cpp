@@ -42,7 +42,7 @@ PLUGINLIB_DECLARE_CLASS(rotate_recovery, RotateRecovery, rotate_recovery::Rotate
 
 namespace rotate_recovery {
 RotateRecovery::RotateRecovery(): global_costmap_(NULL), local_costmap_(NULL), 
-  tf_(NULL), initialized_(false), world_model_(NULL) {} 
+  tf_(NULL), initialized_(false), world_model_(NULL), footprint_mask_headings_(0) {} 
 
 void RotateRecovery::initialize(std::string name, tf::TransformListener* tf,
     costmap_2d::Costmap2DROS* global_costmap, costmap_2d::Costmap2DROS* local_costmap){
@@ -59,6 +59,7 @@ void RotateRecovery::initialize(std::string name, tf::TransformListener* tf,
     //we'll simulate every degree by default
     private_nh.param("sim_granularity", sim_granularity_, 0.017);
     private_nh.param("frequency", frequency_, 20.0);
+    private_nh.param("footprint_mask_headings", footprint_mask_headings_, 0);
 
     blp_nh.param("acc_lim_th", acc_lim_th_, 3.2);
     blp_nh.param("max_rotational_vel", max_rotational_vel_, 1.0);
@@ -113,13 +114,24 @@ void RotateRecovery::runBehavior(){
 
     double x = global_pose.getOrigin().x(), y = global_pose.getOrigin().y();
 
+    std::vector<geometry_msgs::Point> footprint = local_costmap_->getRobotFootprint();
+    if(footprint_mask_headings_ > 0){
+      double resolution = local_costmap_->getCostmap()->getResolution();
+      if(!footprint_mask_.matches(footprint, resolution, footprint_mask_headings_))
+        footprint_mask_.setFootprint(footprint, resolution, footprint_mask_headings_);
+    }
+
     //check if that velocity is legal by forward simulating
     double sim_angle = 0.0;
     while(sim_angle < dist_left){
       double theta = tf::getYaw(global_pose.getRotation()) + sim_angle;
 
       //make sure that the point is legal, if it isn't... we'll abort
-      double footprint_cost = world_model_->footprintCost(x, y, theta, local_costmap_->getRobotFootprint(), 0.0, 0.0);
+      double footprint_cost;
+      if(footprint_mask_.isValid())
+        footprint_cost = footprint_mask_.footprintCost(*local_costmap_->getCostmap(), x, y, theta);
+      else
+        footprint_cost = world_model_->footprintCost(x, y, theta, footprint, 0.0, 0.0);
       if(footprint_cost < 0.0){
         ROS_ERROR("Rotate recovery can't rotate in place because there is a potential collision. Cost: %.2f", footprint_cost);
         return;